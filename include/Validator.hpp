@@ -47,15 +47,35 @@
  *        | special values       | "       "       | "       "    | uint_t     | !FAIL + PERFECT = PERFECT
  * -------|----------------------|-----------------|--------------|------------|-----------------------------------------------
  *        |                      |                 |              |            |
- * TODO: Make a struct validator (a list of Validators)
  */
 
 #include "../src/headers/Validator_core.hpp"
+#include "../src/headers/async_t.hpp"
+#include "../src/headers/batcher_t.hpp"
+#include "../src/headers/compact_list_t.hpp"
+#include "../src/headers/expression_t.hpp"
+#include "../src/headers/incremental_ranking_t.hpp"
 #include "../src/headers/keyed_data_t.hpp"
 #include "../src/headers/keyed_list_t.hpp"
+#include "../src/headers/memory_usage_t.hpp"
+#include "../src/headers/perfect_hash_t.hpp"
 #include "../src/headers/key_t.hpp"
+#include "../src/headers/query_cache_t.hpp"
+#include "../src/headers/range_set_t.hpp"
 #include "../src/headers/range_t.hpp"
+#include "../src/headers/ranking_t.hpp"
+#include "../src/headers/replicated_t.hpp"
+#include "../src/headers/result_column_t.hpp"
 #include "../src/headers/return_t.hpp"
+#include "../src/headers/roaring_set_t.hpp"
+#include "../src/headers/score_curve_t.hpp"
+#include "../src/headers/scorer_t.hpp"
+#include "../src/headers/shared_rules_t.hpp"
+#include "../src/headers/struct_validator_t.hpp"
+#include "../src/headers/tenant_index_t.hpp"
+#include "../src/headers/tolerance_index_t.hpp"
+#include "../src/headers/validator_t.hpp"
+#include "../src/headers/variant_list_t.hpp"
 
 /// @section Type Definitions for External Use
 
@@ -63,12 +83,56 @@
 
 using VReturn_t     = Validspace::VReturn_t;
 using VKey_t        = Validspace::VKey_t;
+using VScore_t      = Validspace::VScore_t;
+using VScorer_t     = Validspace::VScorer_t;
+using VOrder_t      = Validspace::VOrder_t;
+using VCurve_t      = Validspace::VCurve_t;
+using VNumaTopology_t = Validspace::VNumaTopology_t;
+using VSetOp_t      = Validspace::VSetOp_t;
+using VPrecedence_t = Validspace::VPrecedence_t;
+using VResultEncoding_t = Validspace::VResultEncoding_t;
+using VResultClass_t    = Validspace::VResultClass_t;
+using VResultSummary_t  = Validspace::VResultSummary_t;
+using VPassMask_t       = Validspace::VPassMask_t;
+using VClassColumn_t    = Validspace::VClassColumn_t;
+using VScoreColumn_t    = Validspace::VScoreColumn_t;
+using VExprOp_t         = Validspace::VExprOp_t;
+using VTolerance_t      = Validspace::VTolerance_t;
+using VDeadline_t       = Validspace::VDeadline_t;
+using VContainer_t      = Validspace::VContainer_t;
+using VRanking_t        = Validspace::VRanking_t;
+using VStorage_t        = Validspace::VStorage_t;
+using VMemoryUsage_t    = Validspace::VMemoryUsage_t;
 
 // With subtype T |using| External type | Internal type
 
 template <class T> using   VKeyedList_t = Validspace::VKeyedList_t<T>;
 template <class T> using   VKeyedData_t = Validspace::VKeyedData_t<T>;
-// template <class T> using      Validator = Validspace:: Validator_t<T>;
-// template <class T> using       VRange_t = Validspace::    VRange_t<T>;
+template <class T> using VCompactKeyedList_t = Validspace::VCompactKeyedList_t<T>;
+template <class T> using VPerfectHash_t = Validspace::VPerfectHash_t<T>;
+template <class T> using VToleranceIndex_t = Validspace::VToleranceIndex_t<T>;
+template <class T> using VTenantIndex_t = Validspace::VTenantIndex_t<T>;
+template <class T> using  VRoaringSet_t = Validspace::VRoaringSet_t<T>;
+template <class T> using VRoaringKeyedList_t = Validspace::VRoaringKeyedList_t<T>;
+template <class T> using VIncrementalRanking_t = Validspace::VIncrementalRanking_t<T>;
+template <class... Ts> using VVariantKeyedList_t = Validspace::VVariantKeyedList_t<Ts...>;
+template <class T> using      Validator = Validspace:: Validator_t<T>;
+template <class T> using VStructValidator_t = Validspace::VStructValidator_t<T>;
+template <class T> using  VExpression_t = Validspace::VExpression_t<T>;
+template <class T, class H = std::hash<T>> using VQueryCache_t = Validspace::VQueryCache_t<T, H>;
+template <class T, class V = Validspace::Validator_t<T>> using VBatcher_t = Validspace::VBatcher_t<T, V>;
+template <class I> using  VReplicated_t = Validspace::VReplicated_t<I>;
+#if defined(V_SHARED_RULES)
+template <class T> using VSharedRules_t = Validspace::VSharedRules_t<T>;
+#endif
+#if defined(V_ASYNC)
+using VAsyncScheduler_t = Validspace::VAsyncScheduler_t;
+template <class T> using        VTask_t = Validspace::VTask_t<T>;
+template <class K, class T> using VAsyncSource_t = Validspace::VAsyncSource_t<K, T>;
+#endif
+template <class T> using       VRange_t = Validspace::    VRange_t<T>;
+template <class T> using    VRangeSet_t = Validspace:: VRangeSet_t<T>;
+template <class T> using  VScoreCurve_t = Validspace::VScoreCurve_t<T>;
+template <Validspace::VResultEncoding_t E> using VResultColumn_t = Validspace::VResultColumn_t<E>;
 // template <class T> using        VList_t = Validspace::     VList_t<T>;
 // template <class T> using   VRangeList_t = Validspace::VRangeList_t<T>;
\ No newline at end of file
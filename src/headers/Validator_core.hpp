@@ -6,8 +6,10 @@
  */
 
 /// @section Required stdlib Includes
+#include <atomic>
 #include <cstdlib>
 #include <cstdint>
+#include <functional>
 #include <ostream>
 #include <map>
 #include <type_traits>
@@ -62,6 +64,17 @@ std::false_type _has_cout_op(...) {
 }
 template <typename T>
 constexpr bool has_cout_op = decltype(_has_cout_op<T>(0))::value;
+// Hash support
+template <typename T>
+auto _has_hash_op(int) -> decltype(std::hash<T>{}(std::declval<T>()), std::true_type{}) {
+    return std::true_type{};
+}
+template <typename T>
+std::false_type _has_hash_op(...) {
+    return std::false_type{};
+}
+template <typename T>
+constexpr bool has_hash_op = decltype(_has_hash_op<T>(0))::value;
 
 constexpr enum TFlags {
     EQUALITY_OP     = 1u,
@@ -69,7 +82,7 @@ constexpr enum TFlags {
     COMPARISON_OP   = 4u,
     ARITHMATIC_OP   = 8u,
     PRINTABLE_OP    = 16u,
-    // UNUSED          = 32u,
+    HASHABLE_OP     = 32u,
     // UNUSED          = 64u,
     // UNUSED          = 128u,
 };
@@ -81,7 +94,8 @@ constexpr size_t type_flags =
     INEQUALITY_OP *  has_ineq_op<T> |
     COMPARISON_OP * (has_eq_op<T>  && has_ineq_op<T> && has_lt_op<T>     && has_gt_op<T> && has_lteq_op<T> && has_gteq_op<T>) |
     ARITHMATIC_OP * (has_add_op<T> && has_sub_op<T>  && has_add_eq_op<T> && has_sub_eq_op<T>) |
-    PRINTABLE_OP  *  has_cout_op<T>;
+    PRINTABLE_OP  *  has_cout_op<T> |
+    HASHABLE_OP   *  has_hash_op<T>;
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //// @brief Internal Validator namespace.                                                                                  ////
@@ -107,6 +121,19 @@ using  uint_t =     size_t;
 #define V_UINT_MAX  SIZE_MAX
 #endif
 
+/// @brief Mixes a hash so that identity hashes (`std::hash<int>`) spread over all 64 bits.
+inline uint64_t mixHash(uint64_t h) {
+    h ^= h >> 33; h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33; h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33; return h; }
+
+/// @brief Hashes data with `std::hash` and mixes the result.
+/// @tparam Data_t A type with a `std::hash` specialization.
+template <class Data_t> uint64_t hashData(const Data_t &data) { return mixHash(std::hash<Data_t>{}(data)); }
+
+/// @brief Gets a new, process wide unique version stamp for rule set contents.
+inline uint64_t nextVersion() { static std::atomic<uint64_t> counter{0}; return ++counter; }
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 } // END: namespace Validspace                                                                                             ////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
@@ -0,0 +1,262 @@
+#pragma once
+/**
+ * @file src/async_t.hpp
+ * @author Ray Richter
+ * @brief VTask_t, VAsyncScheduler_t, and VAsyncSource_t declarations. Coroutine validation of values fetched from
+ * asynchronous sources.
+ * @note A task awaits values from sources, then validates them. Lookups awaited on a source are queued into one batch,
+ * and the batch is sent when it is full or when the scheduler has nothing left to run. While a batch is in flight the
+ * scheduler keeps running the other tasks, so scoring overlaps the source's I/O. Completed batches resume their tasks on
+ * the scheduler thread, so tasks and validators are never run concurrently.
+ *
+ * C++20 only. `V_ASYNC` is defined when coroutines are available.
+ */
+#include "Validator_core.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define V_ASYNC 1
+#include <coroutine>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// @brief Internal Validator namespace.                                                                                  ////
+namespace Validspace {                                                                                                     ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#if defined(V_ASYNC)
+
+/// @brief A lazy coroutine returning `T`. It starts when it is awaited or run by a `VAsyncScheduler_t`.
+template <class T> class VTask_t {
+    public:
+    struct promise_type {
+        std::optional<T> value{};
+        std::coroutine_handle<> continuation{};
+
+        VTask_t get_return_object() { return VTask_t(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        /// @brief Resumes the awaiting coroutine, if any.
+        struct Final_t {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                return h.promise().continuation ? h.promise().continuation : std::noop_coroutine(); }
+            void await_resume() noexcept {}
+        };
+        Final_t final_suspend() noexcept { return {}; }
+        void return_value(T v) { value = std::move(v); }
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    VTask_t(VTask_t &&other) noexcept : handle_(other.handle_) { other.handle_ = nullptr; }
+    VTask_t& operator=(VTask_t &&rhs) noexcept {
+        if (this != &rhs) { if (handle_) { handle_.destroy(); } handle_ = rhs.handle_; rhs.handle_ = nullptr; }
+        return *this; }
+    VTask_t(const VTask_t&) = delete;
+    VTask_t& operator=(const VTask_t&) = delete;
+    ~VTask_t() { if (handle_) { handle_.destroy(); }}
+
+    /// @brief Checks if the task has returned.
+    bool done() const { return !handle_ || handle_.done(); }
+
+    /// @brief Runs the task until it returns, then resumes the awaiting coroutine.
+    auto operator co_await() noexcept {
+        struct Awaiter_t {
+            std::coroutine_handle<promise_type> h;
+            bool await_ready() noexcept { return !h || h.done(); }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept { h.promise().continuation = awaiting; return h; }
+            T await_resume() { return std::move(*h.promise().value); }
+        };
+        return Awaiter_t{handle_}; }
+
+    private:
+    explicit VTask_t(std::coroutine_handle<promise_type> h) : handle_(h) {}
+    std::coroutine_handle<promise_type> handle_{};
+};
+
+class VAsyncScheduler_t;
+
+/// @brief A source the scheduler sends queued lookups for when it runs out of work.
+class VAsyncSourceBase_t {
+    public:
+    virtual ~VAsyncSourceBase_t() = default;
+    protected:
+    friend class VAsyncScheduler_t;
+    /// @brief Sends the queued lookups as one batch.
+    /// @return `true` if a batch was sent.
+    virtual bool _flush() = 0;
+};
+
+/// @brief Runs tasks on the calling thread, resuming them as their lookups complete.
+class VAsyncScheduler_t {
+    public:
+    VAsyncScheduler_t() {}
+    VAsyncScheduler_t(const VAsyncScheduler_t&) = delete;
+    VAsyncScheduler_t& operator=(const VAsyncScheduler_t&) = delete;
+
+    /// @brief Runs tasks until every one returns, keeping at most `window` of them started at a time.
+    /// @param window Most tasks waiting on lookups at once. Larger windows fill bigger batches.
+    /// @return Results in task order.
+    template <class T> std::vector<T> runAll(std::vector<VTask_t<T>> &&tasks, const size_t &window = 1024) {
+        std::vector<T> ret(tasks.size());
+        size_t next = 0;
+        active_ = 0;
+        while (true) {
+            while (active_ < std::max<size_t>(window, 1) && next < tasks.size()) {
+                ++active_; _drive(std::move(tasks[next]), &ret[next], &active_); ++next; }
+            if (_step()) continue;
+            if (active_ == 0 && next == tasks.size()) break;
+            if (!_wait()) { V_DEBUG_MSG("VAsyncScheduler_t ERROR: Tasks are waiting on something that is not a source!"); break; }}
+        return ret; }
+
+    /// @brief Runs one task until it returns.
+    template <class T> T run(VTask_t<T> &&task) {
+        std::vector<VTask_t<T>> tasks;
+        tasks.push_back(std::move(task));
+        return std::move(runAll(std::move(tasks)).front()); }
+
+    /// @brief Queues a function to run on the scheduler thread. Thread safe. Sources call it when a batch completes.
+    void post(std::function<void()> fn) {
+        { std::lock_guard<std::mutex> lock(mutex_); posted_.push_back(std::move(fn)); }
+        wake_.notify_one(); }
+
+    /// @brief Queues a coroutine to resume on the scheduler thread. Scheduler thread only.
+    void resume(const std::coroutine_handle<> &h) { ready_.push_back(h); }
+
+    /// @brief Gets the number of batches sent and not yet completed.
+    size_t inFlight() const { return inFlight_; }
+
+    private:
+    template <class S, class D> friend class VAsyncSource_t;
+
+    /// @brief A coroutine that starts at once and frees itself when it returns.
+    struct Detached_t {
+        struct promise_type {
+            Detached_t get_return_object() { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    std::vector<VAsyncSourceBase_t*> sources_{};
+    std::deque<std::coroutine_handle<>> ready_{};
+    std::vector<std::function<void()>> posted_{}; // Guarded by mutex_
+    std::mutex mutex_{};
+    std::condition_variable wake_{};
+    size_t active_   = 0;
+    size_t inFlight_ = 0;
+
+    template <class T> static Detached_t _drive(VTask_t<T> task, T *out, size_t *active) {
+        *out = co_await task;
+        --*active; }
+
+    /// @brief Runs posted functions and ready coroutines, or sends queued lookups if there are none.
+    /// @return `true` if anything ran or was sent.
+    bool _step() {
+        std::vector<std::function<void()>> posted;
+        { std::lock_guard<std::mutex> lock(mutex_); posted.swap(posted_); }
+        for (auto &fn : posted) { fn(); }
+        bool ran = !posted.empty() || !ready_.empty();
+        while (!ready_.empty()) {
+            const std::coroutine_handle<> h = ready_.front();
+            ready_.pop_front();
+            h.resume(); }
+        if (ran) return true;
+        for (auto *source : sources_) { ran |= source->_flush(); }
+        return ran; }
+
+    /// @brief Waits for a batch to complete.
+    /// @return `false` if no batch is in flight.
+    bool _wait() {
+        if (inFlight_ == 0) return false;
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_.wait(lock, [&]() { return !posted_.empty(); });
+        return true; }
+
+    void _attach(VAsyncSourceBase_t *source) { sources_.push_back(source); }
+    void _detach(VAsyncSourceBase_t *source) { sources_.erase(std::remove(sources_.begin(), sources_.end(), source), sources_.end()); }
+};
+
+/// @brief A source of values looked up by key, fetched in batches. Implement `fetchBatch` to plug in a cache process, a
+/// disk table, or any other store.
+/// @tparam Key_t Lookup key type.
+/// @tparam Value_t Fetched value type. Must be default constructible.
+template <class Key_t, class Value_t> class VAsyncSource_t : public VAsyncSourceBase_t {
+    public:
+    /// @brief An awaitable lookup of one key.
+    struct Fetch_t {
+        VAsyncSource_t *source;
+        Key_t   key;
+        Value_t value{};
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) { source->_queue(this, h); }
+        Value_t await_resume() { return std::move(value); }
+    };
+
+    /// @brief Constructor from the scheduler that runs the awaiting tasks.
+    /// @param maxBatch Most lookups per batch. A full batch is sent at once.
+    VAsyncSource_t(VAsyncScheduler_t &scheduler, const size_t &maxBatch = 256)
+        : scheduler_(scheduler), maxBatch_(std::max<size_t>(maxBatch, 1)) { scheduler_._attach(this); }
+    VAsyncSource_t(const VAsyncSource_t&) = delete;
+    VAsyncSource_t& operator=(const VAsyncSource_t&) = delete;
+    virtual ~VAsyncSource_t() { scheduler_._detach(this); }
+
+    /// @brief Looks up a key. `co_await source.fetch(key)` gets the value.
+    Fetch_t fetch(const Key_t &key) { return Fetch_t{this, key}; }
+
+    /// @brief Gets the number of batches sent.
+    size_t batches() const { return batches_; }
+    /// @brief Gets the number of lookups sent.
+    size_t lookups() const { return lookups_; }
+
+    protected:
+    /// @brief Starts a batch of lookups. Set every value, then call `done` once, from any thread. `keys` and `values`
+    /// stay valid until `done` is called.
+    virtual void fetchBatch(const Key_t *keys, const size_t &count, Value_t *values, std::function<void()> done) = 0;
+
+    private:
+    /// @brief Lookups sent together.
+    struct Batch_t {
+        std::vector<Key_t>   keys{};
+        std::vector<Value_t> values{};
+        std::vector<std::pair<Fetch_t*, std::coroutine_handle<>>> waiters{};
+    };
+
+    VAsyncScheduler_t &scheduler_;
+    size_t maxBatch_;
+    std::shared_ptr<Batch_t> pending_{};
+    size_t batches_ = 0;
+    size_t lookups_ = 0;
+
+    void _queue(Fetch_t *fetch, const std::coroutine_handle<> &h) {
+        if (!pending_) { pending_ = std::make_shared<Batch_t>(); pending_->keys.reserve(maxBatch_); }
+        pending_->keys.push_back(fetch->key);
+        pending_->waiters.push_back({fetch, h});
+        if (pending_->keys.size() >= maxBatch_) { _flush(); }}
+
+    bool _flush() override {
+        if (!pending_) return false;
+        std::shared_ptr<Batch_t> batch = std::move(pending_);
+        pending_ = nullptr;
+        batch->values.resize(batch->keys.size());
+        ++batches_; lookups_ += batch->keys.size(); ++scheduler_.inFlight_;
+        VAsyncScheduler_t &scheduler = scheduler_;
+        fetchBatch(batch->keys.data(), batch->keys.size(), batch->values.data(), [batch, &scheduler]() {
+            scheduler.post([batch, &scheduler]() {
+                --scheduler.inFlight_;
+                for (size_t i = 0; i < batch->waiters.size(); ++i) {
+                    batch->waiters[i].first->value = std::move(batch->values[i]);
+                    scheduler.resume(batch->waiters[i].second); }}); });
+        return true; }
+};
+
+#endif // V_ASYNC
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+} // END: namespace Validspace                                                                                             ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
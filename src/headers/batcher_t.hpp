@@ -0,0 +1,135 @@
+#pragma once
+/**
+ * @file src/batcher_t.hpp
+ * @author Ray Richter
+ * @brief VBatcher_t Class declaration.
+ * @note Coalesces single value queries from many threads into short batches for a validator's batch path. A worker
+ * thread takes a batch when it is full or when its oldest query has waited `maxDelayUs`, whichever comes first, and
+ * completes every caller's future. Under light load a query waits at most `maxDelayUs` longer than a direct call.
+ */
+#include "Validator_core.hpp"
+#include "return_t.hpp"
+#include "validator_t.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// @brief Internal Validator namespace.                                                                                  ////
+namespace Validspace {                                                                                                     ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief A request coalescing front end for a validator.
+/// @tparam T Candidate type.
+/// @tparam V Validator type with `validate(const T*, const size_t&, VReturn_t*)`. Defaults to `Validator_t<T>`.
+/// @note The validator must outlive the batcher and must not change while queries are pending.
+template <class T, class V = Validator_t<T>> class VBatcher_t {
+    public:
+    using Clock_t = std::chrono::steady_clock;
+
+    /// @brief Constructor from a validator and batch limits.
+    /// @param maxBatch Maximum number of queries in one batch as `size_t`.
+    /// @param maxDelayUs Maximum time the oldest query waits for a batch to fill, in microseconds.
+    VBatcher_t(const V &validator, const size_t &maxBatch = 64, const uint32_t &maxDelayUs = 50)
+        : validator_(validator), maxBatch_(std::max<size_t>(maxBatch, 1)), maxDelay_(maxDelayUs) {
+        worker_ = std::thread([this] { _run(); }); }
+
+    /// @brief Deconstructor. Completes every pending query, then stops the worker.
+    ~VBatcher_t() {
+        { std::lock_guard<std::mutex> lock(mutex_); stop_ = true; }
+        cv_.notify_one();
+        worker_.join(); }
+
+    VBatcher_t(const VBatcher_t&) = delete;
+    VBatcher_t& operator=(const VBatcher_t&) = delete;
+
+    /// @brief Queues a query.
+    /// @return Future for the result.
+    std::future<VReturn_t> submit(const T &qData) {
+        std::promise<VReturn_t> promise;
+        std::future<VReturn_t> ret = promise.get_future();
+        size_t queued;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_.push_back({qData, std::move(promise), Clock_t::now()});
+            queued = pending_.size();
+        }
+        // Wake the worker for a new batch, or early when the batch is full
+        if (queued == 1 || queued >= maxBatch_) cv_.notify_one();
+        return ret; }
+
+    /// @brief Queues a query and waits for the result. Drop in for `Validator_t::validate`.
+    VReturn_t validate(const T &qData) { return submit(qData).get(); }
+    /// @brief Operator overload to validate data.
+    VReturn_t operator()(const T &qData) { return validate(qData); }
+
+    /// @brief Gets the number of completed queries.
+    uint64_t queries() const { return queries_.load(std::memory_order_relaxed); }
+    /// @brief Gets the number of batches run.
+    uint64_t batches() const { return batches_.load(std::memory_order_relaxed); }
+    /// @brief Gets the average number of queries per batch.
+    double averageBatchSize() const { uint64_t b = batches(); return b ? double(queries()) / double(b) : 0.0; }
+    /// @brief Gets the average time a query waited for its batch to start, in microseconds.
+    double averageWaitUs() const {
+        uint64_t q = queries(); return q ? double(waitNs_.load(std::memory_order_relaxed)) / 1000.0 / double(q) : 0.0; }
+    /// @brief Gets the longest time a query waited for its batch to start, in microseconds.
+    double maxWaitUs() const { return double(maxWaitNs_.load(std::memory_order_relaxed)) / 1000.0; }
+    /// @brief Resets the statistics.
+    void resetStats() { queries_ = 0; batches_ = 0; waitNs_ = 0; maxWaitNs_ = 0; }
+
+    private:
+    /// @brief A queued query.
+    struct Pending_t {
+        T value;
+        std::promise<VReturn_t> promise;
+        Clock_t::time_point submitted; };
+
+    const V &validator_;
+    const size_t maxBatch_;
+    const std::chrono::microseconds maxDelay_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<Pending_t> pending_{};
+    bool stop_ = false;
+    std::thread worker_;
+    std::atomic<uint64_t> queries_{0}, batches_{0}, waitNs_{0}, maxWaitNs_{0};
+
+    /// @brief Worker loop. Takes a batch when it is full, its deadline passes, or the batcher stops.
+    void _run() {
+        std::vector<Pending_t> batch;
+        std::vector<T> values;
+        std::vector<VReturn_t> results;
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            cv_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+            if (pending_.empty()) return;
+            const Clock_t::time_point deadline = pending_.front().submitted + maxDelay_;
+            cv_.wait_until(lock, deadline, [this] { return stop_ || pending_.size() >= maxBatch_; });
+            const size_t n = std::min(pending_.size(), maxBatch_);
+            batch.assign(std::make_move_iterator(pending_.begin()), std::make_move_iterator(pending_.begin() + n));
+            pending_.erase(pending_.begin(), pending_.begin() + n);
+            lock.unlock();
+
+            const Clock_t::time_point start = Clock_t::now();
+            values.clear(); results.resize(n);
+            uint64_t waitNs = 0, maxWaitNs = maxWaitNs_.load(std::memory_order_relaxed);
+            for (const auto &p : batch) {
+                values.push_back(p.value);
+                uint64_t ns = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(start - p.submitted).count());
+                waitNs += ns; maxWaitNs = std::max(maxWaitNs, ns); }
+            validator_.validate(values.data(), n, results.data());
+            waitNs_.fetch_add(waitNs, std::memory_order_relaxed);
+            maxWaitNs_.store(maxWaitNs, std::memory_order_relaxed);
+            queries_.fetch_add(n, std::memory_order_relaxed);
+            batches_.fetch_add(1, std::memory_order_relaxed);
+            for (size_t i = 0; i < n; ++i) { batch[i].promise.set_value(results[i]); }
+            batch.clear();
+            lock.lock(); }}
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+} // END: namespace Validspace                                                                                             ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
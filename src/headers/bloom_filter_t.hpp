@@ -0,0 +1,109 @@
+#pragma once
+/**
+ * @file src/bloom_filter_t.hpp
+ * @author Ray Richter
+ * @brief VBloomFilter_t Class declaration.
+ * @note A blocked Bloom filter: every value sets `k` bits inside a single 512 bit (one cache line) block, so a query
+ * touches exactly one cache line. A `false` from `mayContain` is a definite miss, a `true` may be a false positive.
+ */
+#include "Validator_core.hpp"
+#include <algorithm>
+#include <cmath>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// @brief Internal Validator namespace.                                                                                  ////
+namespace Validspace {                                                                                                     ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief A blocked Bloom filter used to skip keyed list scans for values that are definitely not in the list.
+/// @tparam Data_t Data type of the filtered data. Must have a `std::hash` specialization.
+/// @note Default = empty filter, `mayContain` always returns `true` until `build` is called.
+template <class Data_t> class VBloomFilter_t {
+    public:
+    /// @brief Number of bits in one block.
+    static constexpr uint32_t BLOCK_BITS = 512;
+
+    /// @brief Constructor from an expected number of elements and a bit budget per element.
+    VBloomFilter_t(const size_t &numElements, const double &bitsPerKey = 10.0) { build(numElements, bitsPerKey); }
+    /// @brief Default constructor.
+    VBloomFilter_t() {}
+
+    /// @brief Sizes and clears the filter.
+    /// @param numElements Expected number of elements as `size_t`.
+    /// @param bitsPerKey Bit budget per element as `double`. Higher = lower false positive rate.
+    void build(const size_t &numElements, const double &bitsPerKey = 10.0) {
+        double bits = std::ceil(std::max<size_t>(numElements, 1) * std::max(bitsPerKey, 1.0));
+        blocks_.assign(static_cast<size_t>(std::ceil(bits / BLOCK_BITS)), Block_t{});
+        // k = ln(2) * bits / key is optimal for a classic filter, cap it to keep queries cheap
+        numHashes_ = static_cast<uint32_t>(std::lround(std::max(bitsPerKey, 1.0) * 0.6931));
+        numHashes_ = std::min<uint32_t>(std::max<uint32_t>(numHashes_, 1), 16);
+        count_ = 0; }
+
+    /// @brief Clears the filter. `mayContain` returns `true` for everything after this.
+    void clear() { blocks_.clear(); blocks_.shrink_to_fit(); numHashes_ = 0; count_ = 0; }
+
+    /// @brief Adds data to the filter. Does nothing if the filter has not been built.
+    void add(const Data_t &data) {
+        if (blocks_.empty()) return;
+        uint64_t h = hashData(data);
+        Block_t &block = blocks_[_blockIndex(h)];
+        for (uint32_t i = 0; i < numHashes_; ++i) {
+            uint32_t bit = _bitIndex(h, i);
+            block.words[bit >> 6] |= uint64_t(1) << (bit & 63); }
+        ++count_; }
+
+    /// @brief Checks if data may be in the filter.
+    /// @return `false` if data is definitely not in the filter, `true` if it may be or the filter is not built.
+    bool mayContain(const Data_t &data) const {
+        if (blocks_.empty()) return true;
+        uint64_t h = hashData(data);
+        const Block_t &block = blocks_[_blockIndex(h)];
+        uint64_t miss = 0;
+        for (uint32_t i = 0; i < numHashes_; ++i) {
+            uint32_t bit = _bitIndex(h, i);
+            miss |= ~block.words[bit >> 6] & (uint64_t(1) << (bit & 63)); }
+        return miss == 0; }
+
+    /// @brief Expected false positive rate for the current number of elements.
+    /// @note Sums the classic rate over a Poisson distribution of elements per block.
+    double falsePositiveRate() const {
+        if (blocks_.empty()) return 1.0;
+        if (count_ == 0) return 0.0;
+        double lambda = double(count_) / blocks_.size(), rate = 0.0;
+        double p = std::exp(-lambda); // P(block load = 0)
+        size_t maxLoad = static_cast<size_t>(lambda + 10.0 * std::sqrt(lambda) + 20.0);
+        for (size_t load = 0; load <= maxLoad; ++load) {
+            if (load > 0) p *= lambda / load;
+            double bitSet = 1.0 - std::pow(1.0 - 1.0 / BLOCK_BITS, double(numHashes_) * load);
+            rate += p * std::pow(bitSet, numHashes_); }
+        return rate; }
+
+    /// @brief Memory used by the filter bits in bytes.
+    size_t memoryBytes() const { return blocks_.size() * sizeof(Block_t); }
+    /// @brief Number of elements added since the last `build`.
+    size_t size() const { return count_; }
+    /// @brief Number of bits set per element.
+    uint32_t numHashes() const { return numHashes_; }
+    /// @brief Checks if the filter has been built.
+    explicit operator bool() const { return !blocks_.empty(); }
+
+    private:
+    /// @brief One cache line of filter bits.
+    struct alignas(64) Block_t { uint64_t words[BLOCK_BITS / 64] = {}; };
+
+    std::vector<Block_t> blocks_{};
+    uint32_t numHashes_ = 0;
+    size_t   count_     = 0;
+
+    /// @brief Maps the high hash bits onto `[0, blocks)` without a division.
+    size_t _blockIndex(const uint64_t &h) const {
+        return static_cast<size_t>(((h >> 32) * blocks_.size()) >> 32); }
+    /// @brief Gets the `i`th bit index in a block from the low hash bits with double hashing.
+    uint32_t _bitIndex(const uint64_t &h, const uint32_t &i) const {
+        uint32_t h1 = static_cast<uint32_t>(h), h2 = (h1 >> 9) | 1u;
+        return (h1 + i * h2) & (BLOCK_BITS - 1); }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+} // END: namespace Validspace                                                                                             ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
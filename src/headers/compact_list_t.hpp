@@ -0,0 +1,140 @@
+#pragma once
+/**
+ * @file src/compact_list_t.hpp
+ * @author Ray Richter
+ * @brief VCompactKeyedList_t Class declaration.
+ * @note A read only copy of a `VKeyedList_t` stored as two columns: densely packed data, and keys encoded against a
+ * dictionary of the distinct keys. Keys are bit packed (0, 1, 2, 4, 8, or 16 bits per entry) or run length encoded,
+ * whichever is smaller. A list of only BLACKLIST keys stores no per entry key bits at all.
+ */
+#include "Validator_core.hpp"
+#include "keyed_list_t.hpp"
+#include <algorithm>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// @brief Internal Validator namespace.                                                                                  ////
+namespace Validspace {                                                                                                     ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Key column encodings.
+enum class VKeyEncoding_t : uint8_t {
+    PACKED, // Dictionary codes, bit packed
+    RUNS,   // Dictionary codes, run length encoded
+};
+
+/// @brief A compact, read only keyed list with separate data and key columns.
+/// @tparam Data_t Data type of the keyed data.
+/// @note Query results match `VKeyedList_t::query` on the source list.
+template <class Data_t> class VCompactKeyedList_t {
+    public:
+    /// @brief Constructor from a keyed list. See `build`.
+    VCompactKeyedList_t(const VKeyedList_t<Data_t> &kl) { build(kl); }
+    /// @brief Default constructor. Every query returns `FAIL` until `build` is called.
+    VCompactKeyedList_t() {}
+
+    /// @brief Builds the columns from a keyed list, replacing any previous contents.
+    /// @return `false` if the list has more than 65536 distinct keys. The columns are then empty and every query
+    /// returns `FAIL`.
+    bool build(const VKeyedList_t<Data_t> &kl) {
+        const auto &list = kl.getList();
+        _clear();
+        miss_ = kl.fallback(); curve_ = kl.curve(); version_ = kl.version();
+
+        // Data column and dictionary codes
+        std::vector<uint16_t> codes;
+        std::map<uint_t, uint16_t> lookup;
+        codes.reserve(list.size()); data_.reserve(list.size());
+        for (const auto &kd : list) {
+            if (!kd.matchable()) continue; // No query can match these
+            auto it = lookup.find(--kd);
+            if (it == lookup.end()) {
+                if (dict_.size() == 65536) { V_DEBUG_MSG("VCompactKeyedList_t ERROR: Too many distinct keys!"); _clear(); return false; }
+                it = lookup.emplace(--kd, uint16_t(dict_.size())).first;
+                dict_.push_back(kd.getKey()); }
+            codes.push_back(it->second);
+            data_.push_back(kd.getCData()); }
+
+        // Pick the smaller key encoding
+        bits_ = 0;
+        while ((size_t(1) << bits_) < dict_.size()) { bits_ = bits_ ? bits_ * 2 : 1; }
+        size_t packedBytes = (codes.size() * bits_ + 63) / 64 * sizeof(uint64_t), runs = 0;
+        for (size_t i = 0; i < codes.size(); ++i) { runs += (i == 0 || codes[i] != codes[i - 1]); }
+        encoding_ = (runs * (sizeof(uint32_t) + sizeof(uint16_t)) < packedBytes) ? VKeyEncoding_t::RUNS : VKeyEncoding_t::PACKED;
+
+        if (encoding_ == VKeyEncoding_t::PACKED && bits_ > 0) {
+            words_.assign(packedBytes / sizeof(uint64_t), 0);
+            for (size_t i = 0; i < codes.size(); ++i) {
+                words_[(i * bits_) >> 6] |= uint64_t(codes[i]) << ((i * bits_) & 63); }}
+        if (encoding_ == VKeyEncoding_t::RUNS) {
+            for (size_t i = 0; i < codes.size(); ++i) {
+                if (i + 1 == codes.size() || codes[i + 1] != codes[i]) { runEnds_.push_back(uint32_t(i + 1)); runCodes_.push_back(codes[i]); }}}
+        data_.shrink_to_fit(); dict_.shrink_to_fit();
+        return true; }
+
+    /// @brief Queries data to get a score or key.
+    VReturn_t query(const Data_t &qData) const {
+        auto it = std::find(data_.begin(), data_.end(), qData);
+        if (it == data_.end()) return curve_ ? curve_(qData) : miss_;
+        return getKey(size_t(it - data_.begin())); }
+
+    /// @brief Operator overload to query data.
+    VReturn_t operator()(const Data_t &qData) const { return query(qData); }
+
+    /// @brief Decodes the key of an entry.
+    VKey_t getKey(const size_t &index) const {
+        if (encoding_ == VKeyEncoding_t::RUNS) {
+            size_t run = size_t(std::upper_bound(runEnds_.begin(), runEnds_.end(), uint32_t(index)) - runEnds_.begin());
+            return dict_[runCodes_[run]]; }
+        if (bits_ == 0) return dict_[0];
+        uint64_t word = words_[(index * bits_) >> 6] >> ((index * bits_) & 63);
+        return dict_[size_t(word & ((uint64_t(1) << bits_) - 1))]; }
+
+    /// @brief Gets the data column.
+    const std::vector<Data_t>& getData() const { return data_; }
+    /// @brief Gets the number of entries.
+    size_t size() const { return data_.size(); }
+    /// @brief Gets the key encoding.
+    VKeyEncoding_t encoding() const { return encoding_; }
+    /// @brief Gets the key dictionary.
+    const std::vector<VKey_t>& dictionary() const { return dict_; }
+    /// @brief Gets the version of the list the columns were built from.
+    uint64_t version() const { return version_; }
+    /// @brief Memory used by the data column in bytes.
+    size_t dataBytes() const { return data_.capacity() * sizeof(Data_t); }
+    /// @brief Memory used by the key column and dictionary in bytes.
+    size_t keyBytes() const {
+        return dict_.capacity() * sizeof(VKey_t) + words_.capacity() * sizeof(uint64_t) +
+            runEnds_.capacity() * sizeof(uint32_t) + runCodes_.capacity() * sizeof(uint16_t); }
+    /// @brief Gets the bytes used by the columns, by component.
+    VMemoryUsage_t memoryUsage() const {
+        VMemoryUsage_t ret;
+        ret.storage = VStorage_t::COMPACT_LIST;
+        ret.data    = data_.size() * sizeof(Data_t);
+        ret.keys    = dict_.size() * sizeof(VKey_t) + words_.size() * sizeof(uint64_t) +
+                      runEnds_.size() * sizeof(uint32_t) + runCodes_.size() * sizeof(uint16_t);
+        ret.curve   = curve_.memoryBytes();
+        ret.slack   = dataBytes() + keyBytes() - ret.data - ret.keys;
+        ret.object  = sizeof(*this);
+        return ret; }
+
+    private:
+    std::vector<Data_t>   data_{};
+    std::vector<VKey_t>   dict_{};
+    std::vector<uint64_t> words_{};    // PACKED codes
+    std::vector<uint32_t> runEnds_{};  // RUNS: exclusive end index of every run
+    std::vector<uint16_t> runCodes_{}; // RUNS: code of every run
+    VKeyEncoding_t encoding_ = VKeyEncoding_t::PACKED;
+    uint32_t bits_    = 0;
+    VReturn_t miss_   = VReturn_t::FAIL;
+    VScoreCurve_t<Data_t> curve_{}; // Scores misses if the list has a curve
+    uint64_t version_ = 0;
+
+    /// @brief Empties the columns. Every query returns `FAIL` until the next `build`.
+    void _clear() {
+        data_.clear(); dict_.clear(); words_.clear(); runEnds_.clear(); runCodes_.clear();
+        encoding_ = VKeyEncoding_t::PACKED; bits_ = 0; miss_ = VReturn_t::FAIL; curve_ = {}; version_ = 0; }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+} // END: namespace Validspace                                                                                             ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
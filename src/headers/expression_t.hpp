@@ -0,0 +1,324 @@
+#pragma once
+/**
+ * @file src/expression_t.hpp
+ * @author Ray Richter
+ * @brief VExpression_t Class declaration.
+ * @note An expression is a tree of trait validators joined by AND, OR, NOT, weighted sum, MIN, and MAX nodes, e.g.
+ * `inWhitelist && (inRange || !inBlacklist)`. `compile` flattens the tree into a preorder program of 8 byte nodes, each
+ * holding where its subtree ends, so validating one candidate walks one contiguous array with no pointer chasing and
+ * one dispatch per node. Nodes stop at the first child that decides them and skip the rest of their subtree:
+ *  - AND:  FAIL if any child FAILs, else PERFECT if any child is PERFECT, else the sum of the children.
+ *  - SUM:  AND with 8.8 fixed point weights per child, like `VScorer_t`.
+ *  - OR:   The first child that does not FAIL, else FAIL.
+ *  - NOT:  PASS if the child FAILs, else FAIL.
+ *  - MIN:  The worst child (FAIL < any score < PERFECT).
+ *  - MAX:  The best child.
+ * Batch validation runs the tree over blocks of candidates instead: every leaf is queried once per block for the
+ * candidates still undecided, with the leaf's batch query when it has one.
+ */
+#include "Validator_core.hpp"
+#include "result_column_t.hpp"
+#include "return_t.hpp"
+#include "scorer_t.hpp"
+#include <functional>
+#include <memory>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// @brief Internal Validator namespace.                                                                                  ////
+namespace Validspace {                                                                                                     ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Expression node types.
+enum class VExprOp_t : uint8_t { LEAF, NOT, AND, OR, SUM, MIN, MAX };
+
+/// @brief A boolean and scoring expression over trait validators.
+/// @tparam T Candidate type, usually a struct.
+/// @note Node handles belong to the expression that made them. The compiled program does not use them, so a compiled
+/// expression can be copied.
+template <class T> class VExpression_t {
+    public:
+    using Leaf_t      = std::function<VReturn_t(const T&)>;
+    /// @brief Batch leaf call. The last argument is the leaf's scratch, kept for every block of one batch call.
+    using BatchLeaf_t = std::function<void(const T*, const uint32_t*, const size_t&, VReturn_t*, std::shared_ptr<void>&)>;
+    /// @brief Deepest node nesting `compile` accepts.
+    static constexpr size_t MAX_DEPTH = 64;
+    /// @brief Candidates per batch block.
+    static constexpr size_t BLOCK = 256;
+
+    /// @brief A handle to one node, used to build larger nodes.
+    class Node_t {
+        public:
+        /// @brief Makes an AND node. Nested ANDs are flattened.
+        Node_t operator&&(const Node_t &rhs) const { return owner_->all({*this, rhs}); }
+        /// @brief Makes an OR node. Nested ORs are flattened.
+        Node_t operator||(const Node_t &rhs) const { return owner_->any({*this, rhs}); }
+        /// @brief Makes a NOT node.
+        Node_t operator! () const { return owner_->negate(*this); }
+        /// @brief Gets the node index.
+        uint32_t id() const { return id_; }
+
+        private:
+        friend class VExpression_t<T>;
+        Node_t(VExpression_t<T> *owner, const uint32_t &id) : owner_(owner), id_(id) {}
+        VExpression_t<T> *owner_;
+        uint32_t id_;
+    };
+
+    /// @brief Default constructor.
+    VExpression_t() {}
+    /// @brief Copy constructor. Copies the nodes and the compiled program. Handles still refer to `e`.
+    VExpression_t(const VExpression_t &e) = default;
+    VExpression_t& operator=(const VExpression_t &e) = default;
+
+    /// @brief Adds a leaf that validates a projected part of each candidate.
+    /// @param validator Any validator with `query`, `validate`, or a call operator for the projected type. Batch queries
+    /// are used in batch validation when it has them. Copied into the expression.
+    /// @param project Maps a candidate to the value `validator` checks, e.g. `[](const User &u) { return u.age; }`.
+    template <class V, class Project> Node_t leaf(const V &validator, const Project &project) {
+        leaves_.push_back([validator, project](const T &c) { return queryOne(validator, project(c)); });
+        batchLeaves_.push_back([validator, project](const T *c, const uint32_t *sel, const size_t &n, VReturn_t *out,
+                                                    std::shared_ptr<void> &scratch) {
+            using U = std::decay_t<decltype(project(*c))>;
+            if (!scratch) { auto values = std::make_shared<std::vector<U>>(); values->reserve(BLOCK); scratch = values; }
+            std::vector<U> &values = *static_cast<std::vector<U>*>(scratch.get());
+            values.clear();
+            for (size_t i = 0; i < n; ++i) { values.push_back(project(c[sel[i]])); }
+            queryBatch(validator, values.data(), n, out); });
+        return _add(VExprOp_t::LEAF, {}, {}, uint32_t(leaves_.size() - 1)); }
+
+    /// @brief Adds a leaf that validates whole candidates, e.g. a `VStructValidator_t<T>`, another expression, or a
+    /// function returning `VReturn_t`.
+    template <class V> Node_t leaf(const V &validator) { return leaf(validator, [](const T &c) -> const T& { return c; }); }
+
+    /// @brief Makes an AND node. Child ANDs are flattened.
+    Node_t all(const std::vector<Node_t> &children) { return _combine(VExprOp_t::AND, children); }
+    /// @brief Makes an OR node. Child ORs are flattened.
+    Node_t any(const std::vector<Node_t> &children) { return _combine(VExprOp_t::OR, children); }
+    /// @brief Makes a MIN node.
+    Node_t min(const std::vector<Node_t> &children) { return _combine(VExprOp_t::MIN, children); }
+    /// @brief Makes a MAX node.
+    Node_t max(const std::vector<Node_t> &children) { return _combine(VExprOp_t::MAX, children); }
+    /// @brief Makes a NOT node.
+    Node_t negate(const Node_t &child) { return _add(VExprOp_t::NOT, {_id(child)}, {VScorer_t::WEIGHT_ONE}); }
+    /// @brief Makes a weighted SUM node.
+    /// @param terms Pairs of child and real weight. Weights are clamped to `[0, 255.99]`.
+    Node_t weightedSum(const std::vector<std::pair<Node_t, double>> &terms) {
+        std::vector<uint32_t> children;
+        std::vector<uint16_t> weights;
+        for (const auto &t : terms) { children.push_back(_id(t.first)); weights.push_back(_toFixed(t.second)); }
+        return _add(VExprOp_t::SUM, children, weights); }
+
+    /// @brief Compiles the tree under `root` into the program `validate` runs.
+    /// @return True if compiled, false if `root` belongs to another expression or nests deeper than `MAX_DEPTH`.
+    bool compile(const Node_t &root) {
+        if (root.owner_ != this || root.id_ >= nodes_.size()) { V_DEBUG_MSG("VExpression_t::compile: node belongs to another expression\n"); return false; }
+        const size_t depth = _depth(root.id_);
+        if (depth > MAX_DEPTH) { V_DEBUG_MSG("VExpression_t::compile: expression nests deeper than MAX_DEPTH\n"); return false; }
+        program_.clear();
+        _emit(root.id_, VScorer_t::WEIGHT_ONE);
+        root_ = root.id_; depth_ = depth;
+        return true; }
+
+    /// @brief Checks if the expression is compiled.
+    bool compiled() const { return !program_.empty(); }
+
+    /// @brief Validates one candidate with the compiled program.
+    /// @return The expression result, or FAIL if not compiled.
+    VReturn_t validate(const T &candidate) const {
+        if (program_.empty()) return VReturn_t::FAIL;
+        return VReturn_t(_eval(program_.data(), 0, candidate)); }
+    VReturn_t operator()(const T &candidate) const { return validate(candidate); }
+
+    /// @brief Validates a batch of candidates, block by block and leaf by leaf.
+    /// @param out Output as `VReturn_t[count]`. FAIL for every candidate if not compiled.
+    void validate(const T *candidates, const size_t &count, VReturn_t *out) const {
+        if (program_.empty()) { for (size_t i = 0; i < count; ++i) { out[i] = VReturn_t::FAIL; } return; }
+        VScratch_t scratch{std::vector<VLevel_t>(depth_ + 1), std::vector<std::shared_ptr<void>>(batchLeaves_.size())};
+        uint32_t sel[BLOCK];
+        uint_t results[BLOCK];
+        for (size_t i = 0; i < BLOCK; ++i) { sel[i] = uint32_t(i); }
+        for (size_t first = 0; first < count; first += BLOCK) {
+            const size_t n = std::min(BLOCK, count - first);
+            _evalBlock(root_, 0, candidates + first, sel, n, results, scratch);
+            for (size_t i = 0; i < n; ++i) { out[first + i] = results[i]; }}}
+    /// @brief Validates a batch of candidates.
+    std::vector<VReturn_t> validate(const std::vector<T> &candidates) const {
+        std::vector<VReturn_t> out(candidates.size());
+        validate(candidates.data(), candidates.size(), out.data());
+        return out; }
+
+    /// @brief Gets the number of leaves.
+    size_t numLeaves() const { return leaves_.size(); }
+    /// @brief Gets the number of nodes built so far.
+    size_t numNodes() const { return nodes_.size(); }
+    /// @brief Gets the number of compiled program nodes.
+    size_t programSize() const { return program_.size(); }
+
+    private:
+    /// @brief One node of the preorder program. Children follow their node, so a node's subtree is
+    /// `[index + 1, end)` and a decided node jumps to `end` past its remaining children.
+    struct Instr_t {
+        VExprOp_t op;
+        uint8_t   unused;
+        uint16_t  weight; // Weight in the parent node
+        uint32_t  arg;    // Leaf index for LEAF, else `end`
+    };
+    struct ExprNode_t {
+        VExprOp_t             op;
+        uint32_t              leaf;
+        std::vector<uint32_t> children;
+        std::vector<uint16_t> weights;
+    };
+    /// @brief Running state of one undecided node.
+    struct VAcc_t {
+        uint64_t total;   // AND and SUM weighted total, as `VScore_t::total`
+        uint_t   value;   // MIN and MAX best so far, or the result once decided
+        bool     perfect; // AND and SUM folded a PERFECT
+        bool     any;     // MIN folded a child
+    };
+    /// @brief Batch scratch for one nesting level. Built once per batch call and reused by every block.
+    struct VLevel_t {
+        VAcc_t    acc[BLOCK];
+        uint_t    results[BLOCK];
+        VReturn_t leafResults[BLOCK]; // Used by a leaf at this level
+        uint32_t  active[BLOCK], pos[BLOCK];
+    };
+    /// @brief Batch scratch for one batch call: every nesting level, and the projected values of every leaf.
+    struct VScratch_t {
+        std::vector<VLevel_t> levels;
+        std::vector<std::shared_ptr<void>> leaves;
+    };
+
+    std::vector<Leaf_t>      leaves_{};
+    std::vector<BatchLeaf_t> batchLeaves_{};
+    std::vector<ExprNode_t>  nodes_{};
+    std::vector<Instr_t>     program_{};
+    uint32_t root_  = 0;
+    size_t   depth_ = 0;
+
+    uint32_t _id(const Node_t &node) const {
+        if (node.owner_ != this) { V_DEBUG_MSG("VExpression_t: node belongs to another expression\n"); }
+        return node.id_; }
+    Node_t _add(const VExprOp_t &op, const std::vector<uint32_t> &children, const std::vector<uint16_t> &weights, const uint32_t &leaf = 0) {
+        nodes_.push_back({op, leaf, children, weights});
+        return Node_t(this, uint32_t(nodes_.size() - 1)); }
+    /// @brief Makes an n-ary node. Children of the same associative type are spliced in.
+    Node_t _combine(const VExprOp_t &op, const std::vector<Node_t> &children) {
+        std::vector<uint32_t> ids;
+        for (const auto &c : children) {
+            const uint32_t id = _id(c);
+            if (id < nodes_.size() && nodes_[id].op == op) { ids.insert(ids.end(), nodes_[id].children.begin(), nodes_[id].children.end()); }
+            else { ids.push_back(id); }}
+        return _add(op, ids, std::vector<uint16_t>(ids.size(), VScorer_t::WEIGHT_ONE)); }
+
+    size_t _depth(const uint32_t &id) const {
+        size_t d = 0;
+        for (const auto &c : nodes_[id].children) { d = std::max(d, _depth(c)); }
+        return d + (nodes_[id].op != VExprOp_t::LEAF); }
+    void _emit(const uint32_t &id, const uint16_t &weight) {
+        const ExprNode_t &node = nodes_[id];
+        const size_t at = program_.size();
+        program_.push_back({node.op, 0, weight, node.leaf});
+        if (node.op == VExprOp_t::LEAF) return;
+        for (size_t i = 0; i < node.children.size(); ++i) { _emit(node.children[i], node.weights[i]); }
+        program_[at].arg = uint32_t(program_.size()); }
+
+    /// @brief Evaluates the node at `program[pc]`. Each node dispatches once, then loops over its children.
+    /// @note Works in `uint_t` since `VReturn_t` copies are not inline.
+    uint_t _eval(const Instr_t *program, const size_t &pc, const T &candidate) const {
+        const Instr_t &in = program[pc];
+        if (in.op == VExprOp_t::LEAF) return leaves_[in.arg](candidate)();
+        if (in.op == VExprOp_t::NOT)  return (_eval(program, pc + 1, candidate) == VReturn_t::FAIL) ? uint_t(VReturn_t::PASS) : uint_t(VReturn_t::FAIL);
+        switch (in.op) {
+        case VExprOp_t::OR:  return _evalNode<VExprOp_t::OR >(program, pc, candidate);
+        case VExprOp_t::MIN: return _evalNode<VExprOp_t::MIN>(program, pc, candidate);
+        case VExprOp_t::MAX: return _evalNode<VExprOp_t::MAX>(program, pc, candidate);
+        default:             return _evalNode<VExprOp_t::SUM>(program, pc, candidate); }}
+    template <VExprOp_t Op> uint_t _evalNode(const Instr_t *program, const size_t &pc, const T &candidate) const {
+        VAcc_t a = _init(Op);
+        for (size_t child = pc + 1, end = program[pc].arg; child < end; child = _next(program, child)) {
+            if (_fold(Op, a, _eval(program, child, candidate), program[child].weight)) return a.value; }
+        return _finish(Op, a); }
+    static size_t _next(const Instr_t *program, const size_t &pc) { return (program[pc].op == VExprOp_t::LEAF) ? pc + 1 : program[pc].arg; }
+
+    static VAcc_t _init(const VExprOp_t &op) {
+        return {0, (op == VExprOp_t::MIN) ? uint_t(VReturn_t::PERFECT) : uint_t(VReturn_t::FAIL), false, false}; }
+    /// @brief Folds one child result into a node. Branchless, since child results are data dependent.
+    /// @return True if the node is decided, with the result in `a.value`.
+    static bool _fold(const VExprOp_t &op, VAcc_t &a, const uint_t &v, const uint16_t &weight) {
+        const uint_t rank = resultRank(v), best = resultRank(a.value); // FAIL < any score < PERFECT
+        switch (op) {
+        case VExprOp_t::AND: case VExprOp_t::SUM: {
+            // `a.value` stays FAIL, the result if decided. Special values add no points.
+            a.perfect |= (v == VReturn_t::PERFECT);
+            const uint64_t points = (v >= uint_t(VReturn_t::PERFECT)) ? 0 : std::min<uint64_t>(v, VScorer_t::SCORE_CAP);
+            const uint64_t sum = a.total + points * weight;
+            a.total = (sum < a.total) ? UINT64_MAX : sum;
+            return v == VReturn_t::FAIL; }
+        case VExprOp_t::OR:
+            a.value = v;
+            return v != VReturn_t::FAIL;
+        case VExprOp_t::MIN:
+            a.value = (rank < best) ? v : a.value;
+            a.any = true;
+            return v == VReturn_t::FAIL;
+        case VExprOp_t::MAX:
+            a.value = (rank > best) ? v : a.value;
+            return v == VReturn_t::PERFECT;
+        default: return false; }}
+    /// @brief Gets the result of a node no child decided.
+    static uint_t _finish(const VExprOp_t &op, const VAcc_t &a) {
+        switch (op) {
+        case VExprOp_t::AND: case VExprOp_t::SUM: { // As `VScore_t::toReturn`, without the out of line `VReturn_t` copies
+            const uint64_t points = a.total / VScorer_t::WEIGHT_ONE, max = uint64_t(VReturn_t::PERFECT) - 1;
+            return a.perfect ? uint_t(VReturn_t::PERFECT) : uint_t(points < max ? points : max); }
+        case VExprOp_t::OR:  return VReturn_t::FAIL;
+        case VExprOp_t::MIN: return a.any ? a.value : uint_t(VReturn_t::PASS);
+        default:             return a.value; }}
+
+    /// @brief Evaluates one node for the candidates `c[sel[0..n)]`, writing `out[0..n)`.
+    void _evalBlock(const uint32_t &id, const size_t &depth, const T *c, const uint32_t *sel, const size_t &n,
+                    uint_t *out, VScratch_t &scratch) const {
+        const ExprNode_t &node = nodes_[id];
+        if (node.op == VExprOp_t::LEAF) {
+            VReturn_t *results = scratch.levels[depth].leafResults;
+            batchLeaves_[node.leaf](c, sel, n, results, scratch.leaves[node.leaf]);
+            for (size_t i = 0; i < n; ++i) { out[i] = results[i](); }
+            return; }
+        if (node.op == VExprOp_t::NOT) {
+            _evalBlock(node.children[0], depth + 1, c, sel, n, out, scratch);
+            for (size_t i = 0; i < n; ++i) { out[i] = (out[i] == VReturn_t::FAIL) ? uint_t(VReturn_t::PASS) : uint_t(VReturn_t::FAIL); }
+            return; }
+        switch (node.op) {
+        case VExprOp_t::OR:  _evalBlockNode<VExprOp_t::OR >(node, depth, c, sel, n, out, scratch); break;
+        case VExprOp_t::MIN: _evalBlockNode<VExprOp_t::MIN>(node, depth, c, sel, n, out, scratch); break;
+        case VExprOp_t::MAX: _evalBlockNode<VExprOp_t::MAX>(node, depth, c, sel, n, out, scratch); break;
+        default:             _evalBlockNode<VExprOp_t::SUM>(node, depth, c, sel, n, out, scratch); break; }}
+    template <VExprOp_t Op> void _evalBlockNode(const ExprNode_t &node, const size_t &depth, const T *c, const uint32_t *sel,
+                                                const size_t &n, uint_t *out, VScratch_t &scratch) const {
+        VLevel_t &level = scratch.levels[depth];
+        size_t live = n;
+        for (size_t i = 0; i < n; ++i) { level.active[i] = sel[i]; level.pos[i] = uint32_t(i); level.acc[i] = _init(Op); }
+        for (size_t k = 0; k < node.children.size() && live != 0; ++k) {
+            _evalBlock(node.children[k], depth + 1, c, level.active, live, level.results, scratch);
+            // Decided candidates leave the active set, so later children never see them. Compaction is branchless since
+            // results are data dependent. An undecided candidate's `out` is overwritten later.
+            size_t keep = 0;
+            for (size_t j = 0; j < live; ++j) {
+                const uint32_t p = level.pos[j];
+                const bool decided = _fold(Op, level.acc[p], level.results[j], node.weights[k]);
+                out[p] = level.acc[p].value;
+                level.active[keep] = level.active[j]; level.pos[keep] = p;
+                keep += !decided; }
+            live = keep; }
+        for (size_t j = 0; j < live; ++j) { out[level.pos[j]] = _finish(Op, level.acc[level.pos[j]]); }}
+
+    static uint16_t _toFixed(const double &w) {
+        double f = w * VScorer_t::WEIGHT_ONE + 0.5;
+        return uint16_t(f <= 0.0 ? 0 : (f >= double(UINT16_MAX) ? UINT16_MAX : f)); }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+} // END: namespace Validspace                                                                                             ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,226 @@
+#pragma once
+/**
+ * @file src/incremental_ranking_t.hpp
+ * @author Ray Richter
+ * @brief VIncrementalRanking_t Class declaration. A scored candidate pool that is rescored a value at a time.
+ * @note Every candidate has one value per trait, and every trait is scored by a keyed list. The pool keeps every
+ * candidate's result for every trait, and a reverse index per trait from each distinct value to the candidates holding
+ * it. After a list gains, loses, or rekeys an entry, `update` queries the list once for that value and rescores only the
+ * candidates holding it. The top K is updated in place. A top candidate that gets worse costs one pass over the stored
+ * totals to find its replacement, without querying any list.
+ */
+#include "Validator_core.hpp"
+#include "keyed_list_t.hpp"
+#include "ranking_t.hpp"
+#include "result_column_t.hpp"
+#include "return_t.hpp"
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// @brief Internal Validator namespace.                                                                                  ////
+namespace Validspace {                                                                                                     ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief A top K ranking of a candidate pool that follows changes to the trait lists.
+/// @tparam Data_t Data type of the trait values. Must have a `std::hash` specialization and a == operator.
+/// @note A candidate's total is `PASS` plus its trait results in trait order, like `VStructValidator_t` in `DECLARED`
+/// order. Ranks and ties follow `rankWithin`. The lists are not copied and must outlive the ranking.
+template <class Data_t> class VIncrementalRanking_t {
+    public:
+    /// @brief Constructor from trait lists and candidates. See `build`.
+    VIncrementalRanking_t(const std::vector<const VKeyedList_t<Data_t>*> &traits, const std::vector<std::vector<Data_t>> &candidates,
+                          const size_t &k) {
+        std::vector<Data_t> values;
+        values.reserve(candidates.size() * traits.size());
+        for (const auto &c : candidates) {
+            if (c.size() != traits.size()) { V_DEBUG_MSG("VIncrementalRanking_t ERROR: Candidates need one value per trait!"); return; }
+            values.insert(values.end(), c.begin(), c.end()); }
+        build(traits, values.data(), candidates.size(), k); }
+    /// @brief Default constructor. The ranking is empty until `build` is called.
+    VIncrementalRanking_t() {}
+
+    /// @brief Scores every candidate and ranks the best `k`, replacing any previous pool.
+    /// @param traits Trait lists, in trait order.
+    /// @param values Candidate trait values as `Data_t[count][traits.size()]`.
+    /// @return `false` if a list is missing or there are too many candidates.
+    bool build(const std::vector<const VKeyedList_t<Data_t>*> &traits, const Data_t *values, const size_t &count, const size_t &k) {
+        _clear();
+        if (count > size_t(UINT32_MAX)) { V_DEBUG_MSG("VIncrementalRanking_t ERROR: Too many candidates!"); return false; }
+        for (const auto *list : traits) { if (!list) { V_DEBUG_MSG("VIncrementalRanking_t ERROR: Missing trait list!"); return false; }}
+        const size_t numTraits = traits.size();
+        k_ = k; size_ = count;
+        results_.assign(count * numTraits, VReturn_t::FAIL);
+        traits_.resize(numTraits);
+        std::vector<uint32_t> groupOf(count);
+        for (size_t t = 0; t < numTraits; ++t) {
+            Trait_t &trait = traits_[t];
+            trait.list = traits[t];
+            // Group the candidates by value
+            for (size_t c = 0; c < count; ++c) {
+                const Data_t &value = values[c * numTraits + t];
+                auto it = trait.groups.find(value);
+                if (it == trait.groups.end()) {
+                    it = trait.groups.emplace(value, uint32_t(trait.values.size())).first;
+                    trait.values.push_back(value); }
+                groupOf[c] = it->second; }
+            trait.groupStart.assign(trait.values.size() + 1, 0);
+            for (size_t c = 0; c < count; ++c) { ++trait.groupStart[groupOf[c] + 1]; }
+            for (size_t g = 0; g < trait.values.size(); ++g) { trait.groupStart[g + 1] += trait.groupStart[g]; }
+            trait.members.resize(count);
+            std::vector<uint32_t> fill(trait.groupStart.begin(), trait.groupStart.end() - 1);
+            for (size_t c = 0; c < count; ++c) { trait.members[fill[groupOf[c]]++] = uint32_t(c); }
+            // One query per distinct value
+            std::vector<VReturn_t> fresh(trait.values.size());
+            trait.list->query(trait.values.data(), trait.values.size(), fresh.data());
+            for (size_t g = 0; g < trait.values.size(); ++g) {
+                for (uint32_t i = trait.groupStart[g]; i < trait.groupStart[g + 1]; ++i) { results_[trait.members[i] * numTraits + t] = fresh[g]; }}
+            trait.miss = trait.list->fallback(); trait.version = trait.list->version(); }
+        totals_.resize(count);
+        inTop_.assign(count, 0);
+        for (size_t c = 0; c < count; ++c) { totals_[c] = _total(c); }
+        _rerank();
+        return true; }
+
+    /// @brief Rescores the candidates holding a value after the trait's list gained, lost, or rekeyed it. If the change
+    /// also changed the list's result for unlisted data, the whole trait is refreshed.
+    /// @return Number of candidates rescored.
+    size_t update(const size_t &trait, const Data_t &value) {
+        const size_t ret = _update(trait, value);
+        _settle(); return ret; }
+    /// @brief Rescores the candidates holding any of the values. See `update`.
+    size_t update(const size_t &trait, const std::vector<Data_t> &values) {
+        size_t ret = 0;
+        for (const auto &value : values) { ret += _update(trait, value); }
+        _settle(); return ret; }
+
+    /// @brief Requeries every distinct value of a trait and rescores the candidates whose result changed. Use after
+    /// `setCurve`, `merge`, or any change whose values are not known.
+    /// @return Number of candidates rescored.
+    size_t refresh(const size_t &trait) {
+        const size_t ret = _refresh(trait);
+        _settle(); return ret; }
+    /// @brief Refreshes every trait. See `refresh`.
+    size_t refresh() {
+        size_t ret = 0;
+        for (size_t t = 0; t < traits_.size(); ++t) { ret += _refresh(t); }
+        _settle(); return ret; }
+
+    /// @brief Gets the best `k` candidates, best first. FAIL candidates are never ranked.
+    VRanking_t ranking() const {
+        VRanking_t ret;
+        for (const auto &e : top_) { ret.indices.push_back(e.second); ret.results.push_back(totals_[e.second]); }
+        ret.evaluated = size_;
+        return ret; }
+    /// @brief Gets the index of the best candidate, or `SIZE_MAX` if none passed.
+    size_t best() const { return top_.empty() ? SIZE_MAX : size_t(top_.begin()->second); }
+
+    /// @brief Gets a candidate's total.
+    VReturn_t result(const size_t &candidate) const { return (candidate < size_) ? totals_[candidate] : VReturn_t::FAIL; }
+    /// @brief Gets a candidate's result for one trait.
+    VReturn_t result(const size_t &candidate, const size_t &trait) const {
+        return (candidate < size_ && trait < traits_.size()) ? results_[candidate * traits_.size() + trait] : VReturn_t::FAIL; }
+    /// @brief Gets the number of candidates.
+    size_t size() const { return size_; }
+    /// @brief Gets the number of traits.
+    size_t numTraits() const { return traits_.size(); }
+    /// @brief Gets the number of ranked candidates kept.
+    size_t k() const { return k_; }
+    /// @brief Checks if every trait was last updated at its list's current version.
+    bool current() const {
+        for (const auto &t : traits_) { if (t.version != t.list->version()) return false; }
+        return true; }
+
+    private:
+    using Entry_t = std::pair<uint_t, uint32_t>; // Rank, candidate
+    /// @brief Higher ranks first, ties to the lower candidate.
+    struct Better_t {
+        bool operator()(const Entry_t &a, const Entry_t &b) const { return a.first > b.first || (a.first == b.first && a.second < b.second); } };
+    /// @brief A trait list and its reverse index.
+    struct Trait_t {
+        const VKeyedList_t<Data_t> *list = nullptr;
+        std::unordered_map<Data_t, uint32_t> groups{}; // Value -> group
+        std::vector<Data_t>   values{};     // Value of every group
+        std::vector<uint32_t> groupStart{}; // Member range per group
+        std::vector<uint32_t> members{};    // Candidates, grouped by value
+        VReturn_t miss    = VReturn_t::FAIL; // List result for unlisted data when last synced
+        uint64_t  version = 0;
+    };
+
+    std::vector<Trait_t>   traits_{};
+    std::vector<VReturn_t> results_{}; // Candidate x trait
+    std::vector<VReturn_t> totals_{};  // Per candidate
+    std::vector<uint8_t>   inTop_{};   // Per candidate
+    std::set<Entry_t, Better_t> top_{};
+    size_t k_     = 0;
+    size_t size_  = 0;
+    bool   stale_ = false; // A top candidate got worse, see `_settle`
+
+    void _clear() {
+        traits_.clear(); results_.clear(); totals_.clear(); inTop_.clear(); top_.clear(); k_ = 0; size_ = 0; stale_ = false; }
+    /// @brief Sums a candidate's trait results.
+    VReturn_t _total(const size_t &c) const {
+        VReturn_t ret = VReturn_t::PASS;
+        for (size_t t = 0; t < traits_.size(); ++t) { ret += results_[c * traits_.size() + t]; }
+        return ret; }
+
+    size_t _update(const size_t &trait, const Data_t &value) {
+        if (trait >= traits_.size()) return 0;
+        Trait_t &t = traits_[trait];
+        if (t.list->fallback()() != t.miss()) return _refresh(trait);
+        t.version = t.list->version();
+        const auto it = t.groups.find(value);
+        return (it == t.groups.end()) ? 0 : _rescore(trait, it->second, t.list->query(value)); }
+
+    size_t _refresh(const size_t &trait) {
+        if (trait >= traits_.size()) return 0;
+        Trait_t &t = traits_[trait];
+        std::vector<VReturn_t> fresh(t.values.size());
+        t.list->query(t.values.data(), t.values.size(), fresh.data());
+        size_t ret = 0;
+        for (size_t g = 0; g < t.values.size(); ++g) { ret += _rescore(trait, g, fresh[g]); }
+        t.miss = t.list->fallback(); t.version = t.list->version();
+        return ret; }
+
+    /// @brief Sets the result of every candidate in a group and moves the changed candidates in the top K.
+    size_t _rescore(const size_t &trait, const size_t &group, const VReturn_t &result) {
+        const Trait_t &t = traits_[trait];
+        const size_t numTraits = traits_.size(), first = t.groupStart[group], last = t.groupStart[group + 1];
+        if (first == last || results_[t.members[first] * numTraits + trait]() == result()) return 0;
+        for (size_t i = first; i < last; ++i) {
+            const uint32_t c = t.members[i];
+            results_[c * numTraits + trait] = result;
+            const uint_t before = resultRank(totals_[c]);
+            totals_[c] = _total(c);
+            const uint_t after = resultRank(totals_[c]);
+            if (before == after) continue;
+            if (inTop_[c]) {
+                top_.erase({before, c}); inTop_[c] = 0;
+                // An unranked candidate may now be better
+                if (after < before) { stale_ = true; continue; }}
+            if (after != 0 && !stale_) { _offer(c, after); }}
+        return last - first; }
+
+    /// @brief Adds a candidate to the top K if it is good enough.
+    void _offer(const uint32_t &c, const uint_t &rank) {
+        const Entry_t e{rank, c};
+        if (top_.size() >= k_) {
+            if (k_ == 0 || !Better_t()(e, *top_.rbegin())) return;
+            inTop_[top_.rbegin()->second] = 0;
+            top_.erase(std::prev(top_.end())); }
+        top_.insert(e); inTop_[c] = 1; }
+
+    /// @brief Reranks from the stored totals if a top candidate got worse.
+    void _settle() { if (stale_) { _rerank(); }}
+    void _rerank() {
+        for (const auto &e : top_) { inTop_[e.second] = 0; }
+        top_.clear(); stale_ = false;
+        for (size_t c = 0; c < size_; ++c) {
+            const uint_t rank = resultRank(totals_[c]);
+            if (rank != 0) { _offer(uint32_t(c), rank); }}}
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+} // END: namespace Validspace                                                                                             ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -97,6 +97,10 @@ template <class Data_t> class VKeyedData_t {
     /// @return Key value as `VKey_t` if found or `NULL_KEY` if not found
     VKey_t query(const Data_t &q) const { return ((q == data) ? key : VKey_t::NULL_KEY); }
 
+    /// @brief Checks if any query can match. Entries keyed `NULL_KEY` and data unequal to itself (NaN) never match, so
+    /// indexes can leave them out.
+    bool matchable() const { return key != VKey_t::NULL_KEY && data == data; }
+
     private:
     VKey_t  key; // read only
     Data_t data; // read only
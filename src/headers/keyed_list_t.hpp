@@ -6,15 +6,19 @@
  */
 #include <flagfield.hpp>
 #include "Validator_core.hpp"
+#include "bloom_filter_t.hpp"
 #include "keyed_data_t.hpp"
 #include "key_t.hpp"
+#include "memory_usage_t.hpp"
+#include "score_curve_t.hpp"
+#include <algorithm>
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //// @brief Internal Validator namespace.                                                                                  ////
 namespace Validspace {                                                                                                     ////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-/// TODO: Should this support containing multiple data types?
+/// @note Lists hold one data type. See `VVariantKeyedList_t` for fields with several data types.
 
 /// @brief Keyed list config flag indicies
 enum KLFlags : uint_t {
@@ -26,8 +30,24 @@ enum KLFlags : uint_t {
     PERFECT_FLAG,       // List contains a PERFECT key
     MAXIMUM_FLAG,       // List contains a MAXIMUM key
     MINIMUM_FLAG,       // List contains a MINIMUM key
+    CURVE_FLAG,         // List scores unlisted data with a curve
     MAX_FLAGS};         // Maximum number of flags
 
+/// @brief Set operations for `VKeyedList_t::merge`.
+enum class VSetOp_t : uint8_t {
+    UNION,        // Data in either list
+    INTERSECTION, // Data in both lists
+    DIFFERENCE,   // Data in the left list only
+};
+
+/// @brief Which key data keeps when both lists hold it.
+enum class VPrecedence_t : uint8_t {
+    LEFT,      // Key from the list merged into
+    RIGHT,     // Key from the merged list, aka override
+    STRICTEST, // Key with the worse result. BLACKLIST < WHITELIST < scores < PERFECT
+    LOOSEST,   // Key with the better result
+};
+
 /// @brief A class containing a list of keyed data and functions for managing this list. Range data should be stored in a 
 /// separate range list. 
 /// @tparam Data_t Data type of the keyed data
@@ -67,6 +87,8 @@ template<class Data_t> class VKeyedList_t {
     VKeyedList_t (const VKeyedList_t<Data_t> &kl) {
         V_DEBUG_MSG("Called VKeyedList_t copy constructor with type: " << typeid(Data_t).name());
         _init();
+        config_ = kl.config_;
+        if (kl.config(CURVE_FLAG)) { setCurve(kl.curve_); }
         uint_t numFail = add(kl);
         if (numFail != 0) { V_DEBUG_MSG("WARNING: Failed to add " << numFail << " element(s)!"); }
         else { V_DEBUG_MSG("Success!"); }}
@@ -130,7 +152,7 @@ template<class Data_t> class VKeyedList_t {
     /// @return Number of add fails as `uint_t`
     uint_t add(const VKeyedList_t<Data_t> &kl) {
         uint_t failCount = 0;
-        for (const auto &kd : kl.list) { failCount += _add(kd); }
+        for (const auto &kd : kl.list_) { failCount += _add(kd); }
         return failCount; }
     
     /// @brief Adds keyed data to the keyed list.
@@ -157,21 +179,127 @@ template<class Data_t> class VKeyedList_t {
     /// @return Number of add fails as `uint_t`
     uint_t add(const Data_t &data) { return _add({VKey_t::WHITELIST, data}); }
 
+    /// @brief Merges another list into this one in O(n + m). Hashable data is joined with a hash table, other comparable
+    /// data with a sorted merge. The result holds every data value once, so a value's key no longer depends on the order
+    /// the lists were added in. Duplicates within one list keep their first key, like `query`. Left data keeps its order,
+    /// and new right data follows in its order.
+    /// @param rhs List to merge as `VKeyedList_t<Data_t>`
+    /// @param op Set operation as `VSetOp_t`
+    /// @param precedence Key kept for data in both lists as `VPrecedence_t`. Ignored by `DIFFERENCE`.
+    /// @return Number of data values both lists hold with different keys as `uint_t`
+    uint_t merge(const VKeyedList_t<Data_t> &rhs, const VSetOp_t &op = VSetOp_t::UNION,
+                 const VPrecedence_t &precedence = VPrecedence_t::LEFT) {
+        if (&rhs == this) { const VKeyedList_t<Data_t> copy(rhs); return merge(copy, op, precedence); }
+        std::vector<uint8_t>  leftFirst, rightNew;
+        std::vector<uint32_t> leftMatch;
+        _join(rhs.list_, leftFirst, leftMatch, rightNew);
+
+        std::vector<VKeyedData_t<Data_t>> merged;
+        merged.reserve(list_.size() + (op == VSetOp_t::UNION ? rhs.size() : 0));
+        uint_t conflicts = 0;
+        for (size_t i = 0; i < list_.size(); ++i) {
+            if (!leftFirst[i]) continue;
+            const bool both = leftMatch[i] != NO_MATCH;
+            if ((op == VSetOp_t::INTERSECTION && !both) || (op == VSetOp_t::DIFFERENCE && both)) continue;
+            if (!both) { merged.push_back(list_[i]); continue; }
+            const VKey_t left = -list_[i], right = -rhs.list_[leftMatch[i]];
+            conflicts += left != right;
+            merged.push_back({_precede(left, right, precedence), *list_[i].getPData()}); }
+        if (op == VSetOp_t::UNION) {
+            for (size_t j = 0; j < rhs.size(); ++j) { if (rightNew[j]) { merged.push_back(rhs.list_[j]); }}}
+
+        // Rebuild the config from the merged contents. The list mode is never looser than the inputs', so a union matches
+        // `+=` and an empty intersection of whitelists still fails everything. Range flags and the curve are kept
+        const bool blacklist = config_(BLACKLIST_FLAG) && (op != VSetOp_t::UNION || rhs.config_(BLACKLIST_FLAG));
+        const bool whitelist = config_(WHITELIST_FLAG) && (op != VSetOp_t::UNION || rhs.config_(WHITELIST_FLAG));
+        const bool minimum = config_(MINIMUM_FLAG) || (op == VSetOp_t::UNION && rhs.config_(MINIMUM_FLAG));
+        const bool maximum = config_(MAXIMUM_FLAG) || (op == VSetOp_t::UNION && rhs.config_(MAXIMUM_FLAG));
+        const VScoreCurve_t<Data_t> curve = (curve_ || op != VSetOp_t::UNION) ? curve_ : rhs.curve_;
+        const double bitsPerKey = filter_ ? double(filter_.memoryBytes() * 8) / double(std::max<size_t>(filter_.size(), 1)) : 0.0;
+        list_.clear(); filter_.clear(); _init();
+        if (minimum) { config_ -= WHITELIST_FLAG; config_ += MINIMUM_FLAG; }
+        if (maximum) { config_ -= WHITELIST_FLAG; config_ += MAXIMUM_FLAG; }
+        for (const auto &kd : merged) { _add(kd); }
+        if (!blacklist) { config_ -= BLACKLIST_FLAG; }
+        if (!whitelist) { config_ -= WHITELIST_FLAG; }
+        if (curve) { setCurve(curve); }
+        if (bitsPerKey > 0.0) { compile(bitsPerKey); }
+        return conflicts; }
+
+    /// @brief Removes repeated data, keeping the first key like `query` does. Query results do not change.
+    /// @return Number of removed elements as `uint_t`
+    uint_t dedupe() {
+        const size_t before = list_.size();
+        merge(VKeyedList_t<Data_t>());
+        return uint_t(before - list_.size()); }
+
+    /// @brief Removes every entry holding data. The list mode is kept, so results for data that is not in the list do
+    /// not change. A compiled filter still holds the data until the next `compile`, which only costs a list scan.
+    /// @return Number of removed elements as `uint_t`
+    uint_t remove(const Data_t &data) {
+        const size_t before = list_.size();
+        list_.erase(std::remove_if(list_.begin(), list_.end(),
+            [&](const VKeyedData_t<Data_t> &kd) { return *kd.getPData() == data; }), list_.end());
+        if (list_.size() != before) { version_ = nextVersion(); }
+        return uint_t(before - list_.size()); }
+
+    /// @brief Sets the key of data, adding the data if it is not in the list. Repeated data is replaced by one entry at
+    /// the end of the list. The list mode is updated like `add`.
+    /// @return `true` if the key could not be set. MINIMUM and MAXIMUM keys are not stored.
+    bool rekey(const Data_t &data, const VKey_t &key) {
+        if (key == VKey_t::MINIMUM || key == VKey_t::MAXIMUM) { V_DEBUG_MSG("VKeyedList_t ERROR: Range keys can not be set on data!"); return true; }
+        remove(data);
+        return _add({key, data}); }
+
     /// @brief Queries data to get a score or key.
     /// @param qData The queried data as `Data_t`
     /// @return `VReturn_t`
     VReturn_t query(const Data_t &qData) const {
         // If not initalized, return FAIL
         if (!config_(INIT_FLAG)) return VReturn_t::FAIL;
+        // If compiled and the filter rules qData out, skip the list scan
+        if constexpr ((type_flags<Data_t> & HASHABLE_OP) != 0) {
+            if (!filter_.mayContain(qData)) return fallback(qData); }
         // Find qData in internal list. If found, cast to VReturn_t and return
         for (const auto &kd : list_) { if (kd(qData) != VKey_t::NULL_KEY) return -kd; }
-    
+        return fallback(qData);
+    }
+
+    /// @brief Queries many values. Same results as `query` on every value. Hashable data is matched with one pass over
+    /// the list per block of values, probing a small hash table of the block. Other data is scanned a cache sized tile
+    /// at a time.
+    /// @param values Queried data as `Data_t[count]`
+    /// @param out Results as `VReturn_t[count]`
+    void query(const Data_t *values, const size_t &count, VReturn_t *out) const {
+        uint32_t match[BATCH_BLOCK];
+        for (size_t first = 0; first < count; first += BATCH_BLOCK) {
+            const size_t n = std::min(BATCH_BLOCK, count - first);
+            const Data_t *v = values + first;
+            if (!config_(INIT_FLAG)) { for (size_t i = 0; i < n; ++i) { out[first + i] = VReturn_t::FAIL; } continue; }
+            _matchBlock(v, n, match);
+            for (size_t i = 0; i < n; ++i) {
+                out[first + i] = (match[i] != NO_MATCH) ? VReturn_t(-list_[match[i]]) : fallback(v[i]); }}}
+
+    /// @brief Gets the result for data that is not in the list, scored by the curve if one is set.
+    /// @param qData The queried data as `Data_t`
+    /// @return `VReturn_t` based on the list config and curve
+    VReturn_t fallback(const Data_t &qData) const {
+        if (config_(CURVE_FLAG)) return curve_(qData);
+        return fallback(); }
+
+    /// @brief Gets the result for data that is not in the list, without the curve.
+    /// @return `VReturn_t` based on the list config
+    VReturn_t fallback() const {
+        // If not initalized, return FAIL
+        if (!config_(INIT_FLAG)) return VReturn_t::FAIL;
         // If qData was not found in the list:
+        //  A curve overrides the list mode, see fallback(qData)
+        if (config_(CURVE_FLAG     )) return VReturn_t::FAIL;
         //  If blacklist mode, return PASS
         if (config_(BLACKLIST_FLAG )) return VReturn_t::PASS;
         //  If whitelist mode, return FAIL
         if (config_(WHITELIST_FLAG )) return VReturn_t::FAIL;
-        /// TODO: If arethmetic, get value based score
+        //  Value based scores need the data, see fallback(qData)
         if (config_(ARITHMETIC_FLAG)) return VReturn_t::FAIL;
         /// TODO: If comparable, check ranges
         if (config_(COMPARABLE_FLAG)) return VReturn_t::FAIL;
@@ -180,8 +308,65 @@ template<class Data_t> class VKeyedList_t {
         return VReturn_t::FAIL;
     }
 
+    /// @brief Builds a Bloom filter over the list so that queries for values not in the list skip the list scan. Data 
+    /// added later is added to the filter. Call again after adding many elements to keep the false positive rate low.
+    /// @param bitsPerKey Filter bit budget per element as `double`. 10 bits = ~1% false positives.
+    /// @return `true` if a filter was built, `false` if `Data_t` is not hashable.
+    bool compile(const double &bitsPerKey = 10.0) {
+        if constexpr ((type_flags<Data_t> & HASHABLE_OP) != 0) {
+            filter_.build(list_.size(), bitsPerKey);
+            for (const auto &kd : list_) { filter_.add(kd.getCData()); }
+            return true; }
+        return false; }
+
+    /// @brief Scores data that is not in the list with a curve. Data in the list keeps its key, so BLACKLIST entries still
+    /// FAIL. The curve overrides blacklist and whitelist mode, which still follow the list contents and apply again once
+    /// the curve is removed.
+    /// @param curve Scoring curve as `VScoreCurve_t<Data_t>`. An empty curve removes the curve.
+    void setCurve(const VScoreCurve_t<Data_t> &curve) {
+        curve_ = curve; version_ = nextVersion();
+        if (curve_) { config_ += CURVE_FLAG; } else { config_ -= CURVE_FLAG; }}
+
+    /// @brief Gets the scoring curve set by `setCurve`.
+    const VScoreCurve_t<Data_t>& curve() const { return curve_; }
+
+    /// @brief Removes the Bloom filter built by `compile`.
+    void decompile() { filter_.clear(); }
+
+    /// @brief Gets the Bloom filter built by `compile`.
+    const VBloomFilter_t<Data_t>& filter() const { return filter_; }
+
+    /// @brief Gets a config flag.
+    bool config(const KLFlags &flag) const { return config_(flag); }
+
+    /// @brief Gets the list version. Versions are unique across lists and change every time the list contents change.
+    uint64_t version() const { return version_; }
+
     /// @brief Gets the size of the list.
     size_t size() const { return list_.size(); }
+    /// @brief Gets the bytes used by the list, by component. `padding` is the space `VKeyedData_t` leaves between its key
+    /// and data, and `slack` is unused list capacity left by `add`.
+    VMemoryUsage_t memoryUsage() const {
+        VMemoryUsage_t ret;
+        const size_t n = list_.size();
+        ret.storage = filter_ ? VStorage_t::FILTERED_LIST : VStorage_t::LIST;
+        ret.data    = n * sizeof(Data_t);
+        ret.keys    = n * sizeof(VKey_t);
+        ret.padding = n * (sizeof(VKeyedData_t<Data_t>) - sizeof(Data_t) - sizeof(VKey_t));
+        ret.filter  = filter_.memoryBytes();
+        ret.curve   = curve_.memoryBytes();
+        ret.slack   = VMemoryUsage_t::slackOf(list_);
+        ret.object  = sizeof(*this);
+        return ret; }
+    /// @brief Copies the list into storage of its exact size, releasing unused capacity. Queries and the version are
+    /// unchanged.
+    /// @return Bytes released.
+    size_t shrinkToFit() {
+        const size_t before = memoryUsage().total();
+        if (list_.capacity() != list_.size()) { std::vector<VKeyedData_t<Data_t>>(list_.begin(), list_.end()).swap(list_); }
+        return before - memoryUsage().total(); }
+    /// @brief Gets the internal list of keyed data in the order it was added.
+    const std::vector<VKeyedData_t<Data_t>>& getList() const { return list_; }
 
     /// @section Operator Overrides
 
@@ -192,7 +377,7 @@ template<class Data_t> class VKeyedList_t {
 
     /// @brief Adds data to the list. 
     VKeyedList_t& operator+=(const std::vector<VKeyedData_t<Data_t>> &rhs) { add(rhs); return *this; }
-    /// @brief Adds data to the list. 
+    /// @brief Adds data to the list. Repeated data is kept, see `merge` for a deduplicated union.
     VKeyedList_t& operator+=(const VKeyedList_t<Data_t> &rhs) { add(rhs); return *this; }
     /// @brief Adds data to the list. 
     VKeyedList_t& operator+=(const VKeyedData_t<Data_t> &rhs) { add(rhs); return *this; }
@@ -206,13 +391,11 @@ template<class Data_t> class VKeyedList_t {
     /// @brief Adds data to the list with BLACKLIST key.
     VKeyedList_t& operator-=(const Data_t &rhs) { add(VKey_t::BLACKLIST, rhs); return *this; }
 
-    // MyClass& MyClass::operator=(const MyClass &rhs) {
-    //     // Only do assignment if RHS is a different object from this.
-    //     if (this != &rhs) {
-    //       ... // Deallocate, allocate new space, copy values...
-    //     }
-    //     return *this;
-    // }
+    /// @brief Assignment from another `VKeyedList_t<Data_t>`. Same as the copy constructor: the list gets a new version
+    /// and no Bloom filter.
+    VKeyedList_t& operator=(const VKeyedList_t<Data_t> &rhs) {
+        if (this != &rhs) { VKeyedList_t<Data_t> copy(rhs); _swap(copy); }
+        return *this; }
 
     friend std::ostream& operator<< (std::ostream&, const VKeyedList_t<Data_t>&);
     friend std::ostream& operator<<=(std::ostream&, const VKeyedList_t<Data_t>&);
@@ -221,10 +404,135 @@ template<class Data_t> class VKeyedList_t {
     private:
     std::vector<VKeyedData_t<Data_t>> list_{};
     FlagField<MAX_FLAGS> config_;
+    VBloomFilter_t<Data_t> filter_{}; // Built by compile()
+    VScoreCurve_t<Data_t>  curve_{};  // Scores unlisted data, set by setCurve()
+    uint64_t version_ = 0;             // Bumped on every change
+
+    static constexpr size_t   BATCH_BLOCK = 64;
+    static constexpr uint32_t NO_MATCH    = UINT32_MAX;
+
+    /// @brief Finds the first list index matching every value of a block, or `NO_MATCH`.
+    void _matchBlock(const Data_t *v, const size_t &n, uint32_t *match) const {
+        constexpr size_t TILE = 1024;
+        uint8_t live[BATCH_BLOCK];
+        size_t left = 0;
+        for (size_t i = 0; i < n; ++i) {
+            match[i] = NO_MATCH; live[i] = 1;
+            // Values the filter rules out skip the scan
+            if constexpr ((type_flags<Data_t> & HASHABLE_OP) != 0) { live[i] = filter_.mayContain(v[i]); }
+            left += live[i]; }
+        if constexpr ((type_flags<Data_t> & HASHABLE_OP) != 0) {
+            // Hash join: one pass over the list, probing a table of the block's distinct values. The table is at most
+            // 1/8 full so most probes for values not in the block stop at the first slot without a mispredict
+            if (left >= 8) {
+                constexpr size_t SLOTS = BATCH_BLOCK * 8;
+                uint8_t table[SLOTS] = {}, rep[BATCH_BLOCK];
+                size_t unique = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    if (!live[i]) continue;
+                    size_t pos = size_t(hashData(v[i])) & (SLOTS - 1);
+                    while (table[pos] && !(v[table[pos] - 1] == v[i])) { pos = (pos + 1) & (SLOTS - 1); }
+                    if (!table[pos]) { table[pos] = uint8_t(i + 1); ++unique; }
+                    rep[i] = uint8_t(table[pos] - 1); }
+                for (size_t j = 0; j < list_.size() && unique != 0; ++j) {
+                    if (-list_[j] == VKey_t::NULL_KEY) continue;
+                    const Data_t &data = *list_[j].getPData();
+                    for (size_t pos = size_t(hashData(data)) & (SLOTS - 1); table[pos]; pos = (pos + 1) & (SLOTS - 1)) {
+                        const size_t k = table[pos] - 1;
+                        if (!(v[k] == data)) continue;
+                        if (match[k] == NO_MATCH) { match[k] = uint32_t(j); --unique; }
+                        break; }}
+                for (size_t i = 0; i < n; ++i) { if (live[i]) { match[i] = match[rep[i]]; }}
+                return; }}
+        // First match wins, like the single value scan. Each tile of the list stays in cache for the whole block
+        for (size_t tile = 0; tile < list_.size() && left != 0; tile += TILE) {
+            const size_t end = std::min(list_.size(), tile + TILE);
+            for (size_t i = 0; i < n; ++i) {
+                if (!live[i]) continue;
+                for (size_t j = tile; j < end; ++j) {
+                    if (list_[j](v[i]) == VKey_t::NULL_KEY) continue;
+                    match[i] = uint32_t(j); live[i] = 0; --left; break; }}}}
+
+    /// @brief Matches this list against another, leaving out entries no query can match. `leftFirst[i]` marks the first
+    /// occurrence of each left value,
+    /// `leftMatch[i]` is the first right index with the same value or `NO_MATCH`, and `rightNew[j]` marks the first
+    /// occurrence of each right value the left list does not hold.
+    void _join(const std::vector<VKeyedData_t<Data_t>> &right, std::vector<uint8_t> &leftFirst,
+               std::vector<uint32_t> &leftMatch, std::vector<uint8_t> &rightNew) const {
+        const size_t n = list_.size(), m = right.size();
+        leftFirst.assign(n, 0); leftMatch.assign(n, NO_MATCH); rightNew.assign(m, 0);
+        if constexpr ((type_flags<Data_t> & HASHABLE_OP) != 0) {
+            // Hash join. Slots hold left index + 1 or n + right index + 1, and the table is at most half full
+            size_t slots = 16;
+            while (slots < 2 * (n + m)) { slots <<= 1; }
+            std::vector<uint32_t> table(slots, 0);
+            auto dataAt = [&](const uint32_t &slot) -> const Data_t& {
+                return (slot <= n) ? *list_[slot - 1].getPData() : *right[slot - 1 - n].getPData(); };
+            auto probe = [&](const Data_t &data) {
+                size_t pos = size_t(hashData(data)) & (slots - 1);
+                while (table[pos] && !(dataAt(table[pos]) == data)) { pos = (pos + 1) & (slots - 1); }
+                return pos; };
+            for (size_t i = 0; i < n; ++i) {
+                if (!list_[i].matchable()) continue;
+                const size_t pos = probe(*list_[i].getPData());
+                if (!table[pos]) { table[pos] = uint32_t(i + 1); leftFirst[i] = 1; }}
+            for (size_t j = 0; j < m; ++j) {
+                if (!right[j].matchable()) continue;
+                const size_t pos = probe(*right[j].getPData());
+                if (!table[pos]) { table[pos] = uint32_t(n + j + 1); rightNew[j] = 1; continue; }
+                if (table[pos] <= n && leftMatch[table[pos] - 1] == NO_MATCH) { leftMatch[table[pos] - 1] = uint32_t(j); }}}
+        else if constexpr ((type_flags<Data_t> & COMPARISON_OP) != 0) {
+            // Sorted merge. Stable sorts keep the first occurrence of every value at the front of its run
+            std::vector<uint32_t> l, r;
+            for (size_t i = 0; i < n; ++i) { if (list_[i].matchable()) { l.push_back(uint32_t(i)); }}
+            for (size_t j = 0; j < m; ++j) { if (right[j].matchable()) { r.push_back(uint32_t(j)); }}
+            const size_t ln = l.size(), rn = r.size();
+            std::stable_sort(l.begin(), l.end(), [&](const uint32_t &a, const uint32_t &b) { return *list_[a].getPData() < *list_[b].getPData(); });
+            std::stable_sort(r.begin(), r.end(), [&](const uint32_t &a, const uint32_t &b) { return *right[a].getPData() < *right[b].getPData(); });
+            size_t a = 0, b = 0;
+            while (a < ln || b < rn) {
+                const bool fromLeft = b == rn || (a < ln && !(*right[r[b]].getPData() < *list_[l[a]].getPData()));
+                const Data_t &value = fromLeft ? *list_[l[a]].getPData() : *right[r[b]].getPData();
+                const size_t leftRun = a, rightRun = b;
+                while (a < ln && *list_[l[a]].getPData() == value) { ++a; }
+                while (b < rn && *right[r[b]].getPData() == value) { ++b; }
+                // Values unequal to themselves (NaN) are their own run
+                if (a == leftRun && b == rightRun) { if (fromLeft) { ++a; } else { ++b; }}
+                if (a != leftRun) { leftFirst[l[leftRun]] = 1; }
+                if (a != leftRun && b != rightRun) { leftMatch[l[leftRun]] = r[rightRun]; }
+                if (a == leftRun && b != rightRun) { rightNew[r[rightRun]] = 1; }}}
+        else {
+            // Data with only == is matched pair by pair
+            auto same = [](const VKeyedData_t<Data_t> &a, const VKeyedData_t<Data_t> &b) { return a.matchable() && *a.getPData() == *b.getPData(); };
+            for (size_t i = 0; i < n; ++i) {
+                leftFirst[i] = list_[i].matchable();
+                for (size_t k = 0; k < i && leftFirst[i]; ++k) { if (same(list_[k], list_[i])) { leftFirst[i] = 0; }}
+                if (!leftFirst[i]) continue;
+                for (size_t j = 0; j < m; ++j) { if (same(right[j], list_[i])) { leftMatch[i] = uint32_t(j); break; }}}
+            for (size_t j = 0; j < m; ++j) {
+                rightNew[j] = right[j].matchable();
+                for (size_t i = 0; i < n && rightNew[j]; ++i) { if (same(list_[i], right[j])) { rightNew[j] = 0; }}
+                for (size_t k = 0; k < j && rightNew[j]; ++k) { if (same(right[k], right[j])) { rightNew[j] = 0; }}}}}
+
+    /// @brief Picks the key for data in both lists.
+    static VKey_t _precede(const VKey_t &left, const VKey_t &right, const VPrecedence_t &precedence) {
+        // Strictness follows the query result: FAIL, then PASS, then scores, then PERFECT
+        auto rank = [](const VKey_t &key) { const VReturn_t ret = key; return !ret ? uint_t(0) : uint_t(ret) + 1; };
+        switch (precedence) {
+        case VPrecedence_t::RIGHT:     return right;
+        case VPrecedence_t::STRICTEST: return (rank(right) < rank(left)) ? right : left;
+        case VPrecedence_t::LOOSEST:   return (rank(right) > rank(left)) ? right : left;
+        default:                       return left; }}
+
+    /// @brief Swaps every member with another list.
+    void _swap(VKeyedList_t<Data_t> &other) {
+        std::swap(list_, other.list_); std::swap(config_, other.config_); std::swap(filter_, other.filter_);
+        std::swap(curve_, other.curve_); std::swap(version_, other.version_); }
 
     /// @brief Initalizes the internal config based on `Data_t`'s capabilities.
     void _init() {
         // Setup config
+        version_ = nextVersion();
         config_  = INIT_FLAG;
         config_ += BLACKLIST_FLAG;
         config_ += WHITELIST_FLAG;
@@ -252,12 +560,31 @@ template<class Data_t> class VKeyedList_t {
             return true; }
         if (-kd == VKey_t::PERFECT)   { config_ += PERFECT_FLAG; }
     
-        // Add keyed data to the list
-        list_.push_back(kd);
+        // Add keyed data to the list and the filter if compiled
+        list_.push_back(kd); version_ = nextVersion();
+        if constexpr ((type_flags<Data_t> & HASHABLE_OP) != 0) { filter_.add(kd.getCData()); }
         return false;
     }
 };
 
+/// @brief Union of two keyed lists. See `VKeyedList_t::merge`.
+template <class Data_t> VKeyedList_t<Data_t> unionOf(const VKeyedList_t<Data_t> &lhs, const VKeyedList_t<Data_t> &rhs,
+                                                     const VPrecedence_t &precedence = VPrecedence_t::LEFT) {
+    VKeyedList_t<Data_t> result(lhs); result.merge(rhs, VSetOp_t::UNION, precedence); return result; }
+
+/// @brief Intersection of two keyed lists. See `VKeyedList_t::merge`.
+template <class Data_t> VKeyedList_t<Data_t> intersectionOf(const VKeyedList_t<Data_t> &lhs, const VKeyedList_t<Data_t> &rhs,
+                                                            const VPrecedence_t &precedence = VPrecedence_t::LEFT) {
+    VKeyedList_t<Data_t> result(lhs); result.merge(rhs, VSetOp_t::INTERSECTION, precedence); return result; }
+
+/// @brief Data in `lhs` that is not in `rhs`. See `VKeyedList_t::merge`.
+template <class Data_t> VKeyedList_t<Data_t> differenceOf(const VKeyedList_t<Data_t> &lhs, const VKeyedList_t<Data_t> &rhs) {
+    VKeyedList_t<Data_t> result(lhs); result.merge(rhs, VSetOp_t::DIFFERENCE); return result; }
+
+/// @brief Union where `overrides` keys replace `base` keys. See `VKeyedList_t::merge`.
+template <class Data_t> VKeyedList_t<Data_t> overrideOf(const VKeyedList_t<Data_t> &base, const VKeyedList_t<Data_t> &overrides) {
+    return unionOf(base, overrides, VPrecedence_t::RIGHT); }
+
 /// @brief Adds `VKeyedList_t` info to an Out Stream
 template <class Data_t> 
 std::ostream& operator<< (std::ostream &os, const VKeyedList_t<Data_t> &kl) {
@@ -278,7 +605,8 @@ std::ostream& operator<<=(std::ostream &os, const VKeyedList_t<Data_t> &kl) {
     os << (kl.config(COMPARABLE_FLAG) ? " Comparable" : "!Comparable") << ", ";
     os << (kl.config(PERFECT_FLAG   ) ? " Perfect"    : "!Perfect"   ) << ", ";
     os << (kl.config(MAXIMUM_FLAG   ) ? " Maximum"    : "!Maximum"   ) << ", ";
-    os << (kl.config(MINIMUM_FLAG   ) ? " Minimum"    : "!Minimum"   );
+    os << (kl.config(MINIMUM_FLAG   ) ? " Minimum"    : "!Minimum"   ) << ", ";
+    os << (kl.config(CURVE_FLAG     ) ? " Curve"      : "!Curve"     );
     os << "}, Data: [";
     for (const auto &kd : kl.list_) { os <<= kd; os << ", "; }
     return os << "\b\b], Size: " << kl.size() << "}";
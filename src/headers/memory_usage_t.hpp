@@ -0,0 +1,74 @@
+#pragma once
+/**
+ * @file src/memory_usage_t.hpp
+ * @author Ray Richter
+ * @brief VMemoryUsage_t declaration. Bytes used by a list, validator, or index, by component.
+ * @note Counts are of the structure's own storage. Heap memory owned by the data itself (`std::string` contents, for
+ * example) is not counted.
+ */
+#include "Validator_core.hpp"
+#include <ostream>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// @brief Internal Validator namespace.                                                                                  ////
+namespace Validspace {                                                                                                     ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Storage backends.
+enum class VStorage_t : uint8_t {
+    LIST,           // VKeyedList_t
+    FILTERED_LIST,  // VKeyedList_t with a Bloom filter from `compile`
+    PERFECT_HASH,   // VPerfectHash_t
+    COMPACT_LIST,   // VCompactKeyedList_t
+    ROARING,        // VRoaringKeyedList_t
+    TOLERANCE,      // VToleranceIndex_t
+    TENANT,         // VTenantIndex_t
+};
+
+/// @brief Gets the name of a storage backend.
+inline const char* storageName(const VStorage_t &storage) {
+    switch (storage) {
+        case VStorage_t::LIST:          return "LIST";
+        case VStorage_t::FILTERED_LIST: return "FILTERED_LIST";
+        case VStorage_t::PERFECT_HASH:  return "PERFECT_HASH";
+        case VStorage_t::COMPACT_LIST:  return "COMPACT_LIST";
+        case VStorage_t::ROARING:       return "ROARING";
+        case VStorage_t::TOLERANCE:     return "TOLERANCE";
+        case VStorage_t::TENANT:        return "TENANT"; }
+    return "UNKNOWN"; }
+
+/// @brief Bytes used by a list, validator, or index, by component.
+struct VMemoryUsage_t {
+    VStorage_t storage = VStorage_t::LIST;
+    size_t data    = 0; // Data values
+    size_t keys    = 0; // Keys, key codes, and key dictionaries
+    size_t padding = 0; // Alignment padding inside stored entries
+    size_t index   = 0; // Hash tables, offsets, and other lookup structures
+    size_t filter  = 0; // Bloom filters
+    size_t curve   = 0; // Miss scoring curves
+    size_t slack   = 0; // Allocated but unused capacity
+    size_t object  = 0; // The objects themselves, config flags included
+
+    /// @brief Gets the total bytes.
+    size_t total() const { return data + keys + padding + index + filter + curve + slack + object; }
+    /// @brief Adds the bytes of another part. The storage backend is kept.
+    VMemoryUsage_t& operator+=(const VMemoryUsage_t &rhs) {
+        data += rhs.data; keys += rhs.keys; padding += rhs.padding; index += rhs.index;
+        filter += rhs.filter; curve += rhs.curve; slack += rhs.slack; object += rhs.object; return *this; }
+
+    /// @brief Gets the unused capacity of a vector in bytes.
+    template <class T, class A> static size_t slackOf(const std::vector<T, A> &v) { return (v.capacity() - v.size()) * sizeof(T); }
+};
+
+/// @brief Adds `VMemoryUsage_t` info to an Out Stream
+/// @note Example output: `{LIST: 4096 bytes, data: 1024, keys: 1024, padding: 0, index: 0, filter: 0, curve: 0, slack: 1984, object: 64}`
+inline std::ostream& operator<<(std::ostream &os, const VMemoryUsage_t &usage) {
+    return os << "{" << storageName(usage.storage) << ": " << usage.total() << " bytes, data: " << usage.data
+              << ", keys: " << usage.keys << ", padding: " << usage.padding << ", index: " << usage.index
+              << ", filter: " << usage.filter << ", curve: " << usage.curve << ", slack: " << usage.slack
+              << ", object: " << usage.object << "}"; }
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+} // END: namespace Validspace                                                                                             ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
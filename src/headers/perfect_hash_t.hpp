@@ -0,0 +1,265 @@
+#pragma once
+/**
+ * @file src/perfect_hash_t.hpp
+ * @author Ray Richter
+ * @brief VPerfectHash_t Class declaration.
+ * @note A frozen, read only copy of a `VKeyedList_t` indexed by a minimal perfect hash (PTHash style). Keys are split
+ * into partitions that are built in parallel. In a partition, every key hashes to a bucket and every bucket stores a
+ * pilot that moves all of its keys to free slots. Slots past the partition size are remapped to the free slots below it,
+ * so the slot table holds exactly one entry per unique value. A query reads one pilot, one slot, and does one compare.
+ */
+#include "Validator_core.hpp"
+#include "keyed_list_t.hpp"
+#include <algorithm>
+#include <thread>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// @brief Internal Validator namespace.                                                                                  ////
+namespace Validspace {                                                                                                     ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief A minimal perfect hash index over a frozen keyed list.
+/// @tparam Data_t Data type of the keyed data. Must have a `std::hash` specialization and a == operator.
+/// @note Duplicate values keep the first key added, the same as a `VKeyedList_t` scan.
+template <class Data_t> class VPerfectHash_t {
+    static_assert((type_flags<Data_t> & HASHABLE_OP) != 0, "VPerfectHash_t ERROR: Data_t must have a std::hash.");
+    public:
+    /// @brief `find` result for data that is not listed.
+    static constexpr size_t   NPOS           = SIZE_MAX;
+    /// @brief Target keys per partition.
+    static constexpr size_t   PARTITION_SIZE = 1u << 16;
+    /// @brief Average keys per bucket. Lower = faster builds, more pilot memory.
+    static constexpr double   BUCKET_SIZE    = 3.0;
+    /// @brief Partition slots / table positions. Below 1 so the last buckets still find free slots quickly.
+    static constexpr double   LOAD_FACTOR    = 0.98;
+
+    /// @brief Constructor from a keyed list. See `build`.
+    VPerfectHash_t(const VKeyedList_t<Data_t> &kl, const size_t &numThreads = 0) { build(kl, numThreads); }
+    /// @brief Default constructor. Every query returns `FAIL` until `build` is called.
+    VPerfectHash_t() {}
+
+    /// @brief Builds the index from a keyed list, replacing any previous index.
+    /// @param kl Keyed list to freeze as `VKeyedList_t<Data_t>`.
+    /// @param numThreads Number of build threads as `size_t`. 0 = hardware concurrency.
+    /// @return `true` if built. `false` if two different values have the same `std::hash`.
+    bool build(const VKeyedList_t<Data_t> &kl, const size_t &numThreads = 0) {
+        const auto &list = kl.getList();
+        const size_t n = list.size();
+        size_t threads = numThreads ? numThreads : std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        _clear(); miss_ = kl.fallback(); curve_ = kl.curve();
+
+        // Hash every value and split hashes into partitions
+        std::vector<uint64_t> hashes(n);
+        _parallelFor(threads, (n + 65535) / 65536, [&](const size_t &block) {
+            for (size_t i = block * 65536; i < std::min(n, (block + 1) * 65536); ++i) { hashes[i] = hashData(list[i].getCData()); }});
+        const size_t numParts = std::max<size_t>((n + PARTITION_SIZE - 1) / PARTITION_SIZE, 1);
+        std::vector<size_t> partStart(numParts + 1, 0);
+        for (const auto &h : hashes) { ++partStart[_partition(h, numParts) + 1]; }
+        for (size_t p = 0; p < numParts; ++p) { partStart[p + 1] += partStart[p]; }
+        std::vector<Item_t> items(n);
+        {
+            std::vector<size_t> fill(partStart.begin(), partStart.end() - 1);
+            for (size_t i = 0; i < n; ++i) { items[fill[_partition(hashes[i], numParts)]++] = {hashes[i], i}; }
+        }
+
+        // Build every partition independently
+        std::vector<PartBuild_t> builds(numParts);
+        std::atomic<bool> ok{true};
+        _parallelFor(threads, numParts, [&](const size_t &p) {
+            if (!_buildPartition(list, items.data() + partStart[p], partStart[p + 1] - partStart[p], builds[p])) { ok = false; }});
+        if (!ok) { V_DEBUG_MSG("VPerfectHash_t ERROR: Values with equal hashes!"); _clear(); return false; }
+
+        // Concatenate partitions
+        parts_.resize(numParts);
+        size_t numSlots = 0, numPilots = 0, numRemap = 0;
+        for (size_t p = 0; p < numParts; ++p) {
+            parts_[p] = builds[p].part;
+            parts_[p].slotOffset  = numSlots;  numSlots  += builds[p].slots.size();
+            parts_[p].pilotOffset = numPilots; numPilots += builds[p].pilots.size();
+            parts_[p].remapOffset = numRemap;  numRemap  += builds[p].remap.size(); }
+        slots_.reserve(numSlots); pilots_.reserve(numPilots); remap_.reserve(numRemap);
+        for (const auto &b : builds) {
+            for (const auto &i : b.slots) { slots_.push_back(list[i]); }
+            pilots_.insert(pilots_.end(), b.pilots.begin(), b.pilots.end());
+            remap_.insert(remap_.end(), b.remap.begin(), b.remap.end()); }
+        version_ = kl.version();
+        return true; }
+
+    /// @brief Queries data to get a score or key. Same results as `VKeyedList_t::query` on the source list.
+    VReturn_t query(const Data_t &qData) const {
+        const size_t slot = find(qData);
+        return (slot != NPOS) ? VReturn_t(-slots_[slot]) : _miss(qData); }
+
+    /// @brief Gets the slot of listed data, or `NPOS` if the data is not listed. See `getSlots`.
+    size_t find(const Data_t &qData) const {
+        if (parts_.empty()) return NPOS;
+        const uint64_t h = hashData(qData);
+        const Part_t &part = parts_[_partition(h, parts_.size())];
+        if (part.size == 0) return NPOS;
+        const uint32_t bucket = _range(uint32_t(h), part.numBuckets);
+        uint32_t pos = _range(uint32_t(mixHash(h ^ _pilotHash(part.seed, pilots_[part.pilotOffset + bucket])) >> 32), part.tableSize);
+        if (pos >= part.size) { pos = remap_[part.remapOffset + pos - part.size]; }
+        const size_t slot = part.slotOffset + pos;
+        return (slots_[slot].query(qData) != VKey_t::NULL_KEY) ? slot : NPOS; }
+
+    /// @brief Operator overload to query data.
+    VReturn_t operator()(const Data_t &qData) const { return query(qData); }
+
+    /// @brief Gets the number of unique values.
+    size_t size() const { return slots_.size(); }
+    /// @brief Gets the version of the list the index was built from.
+    uint64_t version() const { return version_; }
+    /// @brief Gets the keyed data in slot order.
+    const std::vector<VKeyedData_t<Data_t>>& getSlots() const { return slots_; }
+    /// @brief Memory used by the index in bytes, excluding the keyed data.
+    size_t indexBytes() const {
+        return parts_.size() * sizeof(Part_t) + pilots_.size() * sizeof(uint32_t) + remap_.size() * sizeof(uint32_t); }
+    /// @brief Memory used by the keyed data in bytes.
+    size_t dataBytes() const { return slots_.size() * sizeof(VKeyedData_t<Data_t>); }
+    /// @brief Gets the bytes used by the index, by component.
+    VMemoryUsage_t memoryUsage() const {
+        VMemoryUsage_t ret;
+        const size_t n = slots_.size();
+        ret.storage = VStorage_t::PERFECT_HASH;
+        ret.data    = n * sizeof(Data_t);
+        ret.keys    = n * sizeof(VKey_t);
+        ret.padding = dataBytes() - ret.data - ret.keys;
+        ret.index   = indexBytes();
+        ret.curve   = curve_.memoryBytes();
+        ret.slack   = VMemoryUsage_t::slackOf(parts_) + VMemoryUsage_t::slackOf(pilots_) +
+                      VMemoryUsage_t::slackOf(remap_) + VMemoryUsage_t::slackOf(slots_);
+        ret.object  = sizeof(*this);
+        return ret; }
+
+    private:
+    /// @brief A hashed list element.
+    struct Item_t { uint64_t hash; size_t index; };
+    /// @brief Partition layout.
+    struct Part_t {
+        uint64_t seed        = 0;
+        uint32_t size        = 0; // Unique values = slots
+        uint32_t tableSize   = 0; // Pilot positions, >= size
+        uint32_t numBuckets  = 0;
+        size_t   slotOffset  = 0;
+        size_t   pilotOffset = 0;
+        size_t   remapOffset = 0; };
+    /// @brief Partition build output.
+    struct PartBuild_t {
+        Part_t part;
+        std::vector<size_t>   slots;  // List indices in slot order
+        std::vector<uint32_t> pilots;
+        std::vector<uint32_t> remap; };
+
+    std::vector<Part_t> parts_{};
+    std::vector<uint32_t> pilots_{};
+    std::vector<uint32_t> remap_{};
+    std::vector<VKeyedData_t<Data_t>> slots_{};
+    VReturn_t miss_ = VReturn_t::FAIL;
+    VScoreCurve_t<Data_t> curve_{}; // Scores misses if the list has a curve
+    uint64_t version_ = 0;
+
+    void _clear() { parts_.clear(); pilots_.clear(); remap_.clear(); slots_.clear(); miss_ = VReturn_t::FAIL; curve_ = {}; version_ = 0; }
+    /// @brief Gets the result for data that is not in the list.
+    VReturn_t _miss(const Data_t &qData) const { return curve_ ? curve_(qData) : miss_; }
+
+    /// @brief Maps a 32 bit hash onto `[0, range)` without a division.
+    static uint32_t _range(const uint32_t &h, const uint32_t &range) { return uint32_t((uint64_t(h) * range) >> 32); }
+    static size_t _partition(const uint64_t &h, const size_t &numParts) { return size_t(((h >> 32) * numParts) >> 32); }
+    static uint64_t _pilotHash(const uint64_t &seed, const uint32_t &pilot) { return mixHash(seed ^ (pilot * 0x9e3779b97f4a7c15ULL)); }
+
+    /// @brief Runs `fn(i)` for `i` in `[0, count)` on up to `threads` threads.
+    template <class Fn> static void _parallelFor(const size_t &threads, const size_t &count, const Fn &fn) {
+        std::atomic<size_t> next{0};
+        auto worker = [&]() { for (size_t i = next++; i < count; i = next++) { fn(i); }};
+        std::vector<std::thread> pool;
+        for (size_t t = 1; t < std::min(threads, count); ++t) { pool.emplace_back(worker); }
+        worker();
+        for (auto &t : pool) { t.join(); }}
+
+    /// @brief Builds one partition. Drops duplicate values, keeping the first one added.
+    /// @return `false` if two different values have the same hash.
+    static bool _buildPartition(const std::vector<VKeyedData_t<Data_t>> &list, Item_t *items, size_t count, PartBuild_t &out) {
+        if (count == 0) { return true; }
+        // Sort by hash then list order so duplicates are adjacent and the first one added comes first
+        std::sort(items, items + count, [](const Item_t &a, const Item_t &b) {
+            return a.hash < b.hash || (a.hash == b.hash && a.index < b.index); });
+        size_t unique = 0;
+        for (size_t i = 0; i < count; ++i) {
+            // Entries no query can match are left out
+            if (!list[items[i].index].matchable()) continue;
+            if (unique > 0 && items[unique - 1].hash == items[i].hash) {
+                if (*list[items[unique - 1].index].getPData() == *list[items[i].index].getPData()) { continue; }
+                return false; }
+            items[unique++] = items[i]; }
+        count = unique;
+        if (count == 0) { return true; }
+
+        Part_t &part = out.part;
+        part.size       = uint32_t(count);
+        part.tableSize  = std::max<uint32_t>(uint32_t(count / LOAD_FACTOR) + 1, part.size);
+        part.numBuckets = std::max<uint32_t>(uint32_t(count / BUCKET_SIZE), 1);
+        part.seed       = mixHash(items[0].hash ^ count);
+
+        // Group items by bucket, largest buckets first
+        std::vector<uint32_t> bucketStart(part.numBuckets + 1, 0);
+        for (size_t i = 0; i < count; ++i) { ++bucketStart[_range(uint32_t(items[i].hash), part.numBuckets) + 1]; }
+        for (uint32_t b = 0; b < part.numBuckets; ++b) { bucketStart[b + 1] += bucketStart[b]; }
+        std::vector<uint64_t> bucketHashes(count);
+        {
+            std::vector<uint32_t> fill(bucketStart.begin(), bucketStart.end() - 1);
+            for (size_t i = 0; i < count; ++i) { bucketHashes[fill[_range(uint32_t(items[i].hash), part.numBuckets)]++] = items[i].hash; }
+        }
+        std::vector<uint32_t> order(part.numBuckets);
+        for (uint32_t b = 0; b < part.numBuckets; ++b) { order[b] = b; }
+        std::stable_sort(order.begin(), order.end(), [&](const uint32_t &a, const uint32_t &b) {
+            return bucketStart[a + 1] - bucketStart[a] > bucketStart[b + 1] - bucketStart[b]; });
+
+        // Find a pilot per bucket, reseeding if a bucket cannot be placed
+        std::vector<uint8_t> taken;
+        std::vector<uint32_t> positions;
+        for (int attempt = 0;; ++attempt) {
+            if (attempt == 16) { return false; }
+            taken.assign(part.tableSize, 0);
+            out.pilots.assign(part.numBuckets, 0);
+            bool placed = true;
+            for (const auto &b : order) {
+                const uint32_t first = bucketStart[b], last = bucketStart[b + 1];
+                if (first == last) break; // Remaining buckets are empty
+                uint32_t pilot = 0;
+                for (; pilot < (1u << 22); ++pilot) {
+                    const uint64_t ph = _pilotHash(part.seed, pilot);
+                    positions.clear();
+                    bool free = true;
+                    for (uint32_t i = first; i < last && free; ++i) {
+                        uint32_t pos = _range(uint32_t(mixHash(bucketHashes[i] ^ ph) >> 32), part.tableSize);
+                        free = !taken[pos] && std::find(positions.begin(), positions.end(), pos) == positions.end();
+                        positions.push_back(pos); }
+                    if (free) break; }
+                if (pilot == (1u << 22)) { placed = false; break; }
+                out.pilots[b] = pilot;
+                for (const auto &pos : positions) { taken[pos] = 1; }}
+            if (placed) break;
+            part.seed = mixHash(part.seed + 1); }
+
+        // Remap positions past the partition size to the free slots below it
+        out.remap.assign(part.tableSize - part.size, 0);
+        uint32_t freeSlot = 0;
+        for (uint32_t pos = part.size; pos < part.tableSize; ++pos) {
+            if (!taken[pos]) continue;
+            while (taken[freeSlot]) { ++freeSlot; }
+            out.remap[pos - part.size] = freeSlot++; }
+
+        // Place list indices in slot order
+        out.slots.assign(count, 0);
+        for (size_t i = 0; i < count; ++i) {
+            const uint64_t h = items[i].hash;
+            const uint32_t bucket = _range(uint32_t(h), part.numBuckets);
+            uint32_t pos = _range(uint32_t(mixHash(h ^ _pilotHash(part.seed, out.pilots[bucket])) >> 32), part.tableSize);
+            if (pos >= part.size) { pos = out.remap[pos - part.size]; }
+            out.slots[pos] = items[i].index; }
+        return true; }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+} // END: namespace Validspace                                                                                             ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
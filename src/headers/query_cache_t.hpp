@@ -0,0 +1,125 @@
+#pragma once
+/**
+ * @file src/query_cache_t.hpp
+ * @author Ray Richter
+ * @brief VQueryCache_t Class declaration.
+ * @note A fixed size, sharded, set associative cache from a candidate hash to a `VReturn_t`. Each shard is guarded by its
+ * own mutex and evicts with CLOCK (second chance) inside a set. Entries are tagged with the rule set version they were
+ * computed with, so a republished rule set never returns stale results.
+ */
+#include "Validator_core.hpp"
+#include "return_t.hpp"
+#include <algorithm>
+#include <mutex>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// @brief Internal Validator namespace.                                                                                  ////
+namespace Validspace {                                                                                                     ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief A bounded, thread safe memoizing cache for validation results.
+/// @tparam T Candidate type.
+/// @tparam Hash Candidate hash functor. Defaults to `std::hash<T>`.
+/// @note Candidates are identified by a 64 bit hash only. Use one cache per validator.
+template <class T, class Hash = std::hash<T>> class VQueryCache_t {
+    public:
+    /// @brief Number of slots in one set.
+    static constexpr size_t WAYS = 8;
+
+    /// @brief Constructor from a total capacity and a number of shards.
+    /// @param capacity Maximum number of cached results as `size_t`. Rounded up to fill every set.
+    /// @param numShards Number of independently locked shards as `size_t`.
+    VQueryCache_t(const size_t &capacity = 4096, const size_t &numShards = 16, const Hash &hash = Hash())
+        : hash_(hash), shards_(std::max<size_t>(numShards, 1)) {
+        size_t setsPerShard = std::max<size_t>((capacity + shards_.size() * WAYS - 1) / (shards_.size() * WAYS), 1);
+        for (auto &shard : shards_) { shard.sets.resize(setsPerShard); }}
+
+    /// @brief Gets a cached result or validates and caches it.
+    /// @param validator Any validator with `validate(const T&)` and `version()` members.
+    /// @param qData Candidate as `T`.
+    /// @return `VReturn_t`
+    template <class V> VReturn_t validate(const V &validator, const T &qData) {
+        uint64_t h = mixHash(hash_(qData)), version = validator.version();
+        VReturn_t ret;
+        if (find(h, version, ret)) return ret;
+        ret = validator.validate(qData);
+        insert(h, version, ret);
+        return ret; }
+
+    /// @brief Looks up a cached result.
+    /// @param h Mixed candidate hash as `uint64_t`.
+    /// @param version Current rule set version as `uint64_t`.
+    /// @param ret Set to the cached result if found.
+    /// @return `true` if found.
+    bool find(const uint64_t &h, const uint64_t &version, VReturn_t &ret) {
+        Shard_t &shard = _shard(h);
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            Set_t &set = _set(shard, h);
+            for (auto &slot : set.slots) {
+                if (slot.version != version || slot.hash != h) continue;
+                slot.referenced = true; ret = slot.score;
+                hits_.fetch_add(1, std::memory_order_relaxed); return true; }
+        }
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return false; }
+
+    /// @brief Caches a result. Evicts a slot with CLOCK if the set is full.
+    void insert(const uint64_t &h, const uint64_t &version, const VReturn_t &ret) {
+        Shard_t &shard = _shard(h);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Set_t &set = _set(shard, h);
+        // Reuse a slot with the same hash, an empty slot, or a slot from an old rule set version
+        for (auto &slot : set.slots) {
+            if (slot.version == 0 || slot.hash == h || slot.version != version) {
+                slot = {h, version, ret(), true}; return; }}
+        // Second chance sweep
+        for (;;) {
+            Slot_t &slot = set.slots[set.hand];
+            set.hand = (set.hand + 1) % WAYS;
+            if (slot.referenced) { slot.referenced = false; continue; }
+            slot = {h, version, ret(), true};
+            evictions_.fetch_add(1, std::memory_order_relaxed); return; }}
+
+    /// @brief Drops every cached result and resets statistics.
+    void clear() {
+        for (auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (auto &set : shard.sets) { set = Set_t{}; }}
+        hits_ = 0; misses_ = 0; evictions_ = 0; }
+
+    /// @brief Number of cache hits.
+    uint64_t hits     () const { return hits_.load(std::memory_order_relaxed); }
+    /// @brief Number of cache misses.
+    uint64_t misses   () const { return misses_.load(std::memory_order_relaxed); }
+    /// @brief Number of results evicted to make room.
+    uint64_t evictions() const { return evictions_.load(std::memory_order_relaxed); }
+    /// @brief Hits / lookups, or 0 before the first lookup.
+    double   hitRate  () const { uint64_t h = hits(), n = h + misses(); return n ? double(h) / n : 0.0; }
+    /// @brief Maximum number of cached results.
+    size_t   capacity () const { return shards_.size() * shards_.front().sets.size() * WAYS; }
+    /// @brief Memory used by cache slots in bytes.
+    size_t   memoryBytes() const { return capacity() * sizeof(Slot_t) + shards_.size() * sizeof(Shard_t); }
+
+    private:
+    struct Slot_t {
+        uint64_t hash       = 0;
+        uint64_t version    = 0; // 0 = empty, rule set versions start at 1
+        uint_t   score      = 0;
+        bool     referenced = false; };
+    struct Set_t { Slot_t slots[WAYS] = {}; size_t hand = 0; };
+    struct alignas(64) Shard_t { std::mutex mutex; std::vector<Set_t> sets; };
+
+    Hash hash_;
+    std::vector<Shard_t> shards_;
+    std::atomic<uint64_t> hits_{0}, misses_{0}, evictions_{0};
+
+    /// @brief Picks a shard from the high hash bits.
+    Shard_t& _shard(const uint64_t &h) { return shards_[((h >> 32) * shards_.size()) >> 32]; }
+    /// @brief Picks a set from the low hash bits.
+    Set_t& _set(Shard_t &shard, const uint64_t &h) { return shard.sets[(h & 0xffffffffu) % shard.sets.size()]; }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+} // END: namespace Validspace                                                                                             ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
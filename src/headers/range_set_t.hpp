@@ -0,0 +1,178 @@
+#pragma once
+/**
+ * @file src/range_set_t.hpp
+ * @author Ray Richter
+ * @brief VRangeSet_t Class declaration.
+ * @note Checks a value against many `VRange_t`s at once. Bounds are stored as 64 byte aligned arrays of closed
+ * `[lo, hi]` intervals padded to a multiple of 64 ranges. An exclusive range stores the gap between its max and min and
+ * sets an invert bit, so every range is checked with the same two compares and one XOR, without branches:
+ * match = (value >= lo && value <= hi) ^ invert. Results are bitmasks with one bit per range.
+ */
+#include "Validator_core.hpp"
+#include "range_t.hpp"
+#include "return_t.hpp"
+#include <cmath>
+#include <limits>
+#include <new>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// @brief Internal Validator namespace.                                                                                  ////
+namespace Validspace {                                                                                                     ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Cache line aligned allocator for SIMD friendly arrays.
+template <class T> struct VAlignedAllocator_t {
+    using value_type = T;
+    static constexpr std::align_val_t ALIGNMENT{64};
+    VAlignedAllocator_t() {}
+    template <class U> VAlignedAllocator_t(const VAlignedAllocator_t<U>&) {}
+    T*   allocate  (const size_t &n) { return static_cast<T*>(::operator new(n * sizeof(T), ALIGNMENT)); }
+    void deallocate(T *p, const size_t &) { ::operator delete(p, ALIGNMENT); }
+    template <class U> bool operator==(const VAlignedAllocator_t<U>&) const { return true; }
+    template <class U> bool operator!=(const VAlignedAllocator_t<U>&) const { return false; }
+};
+
+/// @brief A set of scored ranges over an arithmetic type, checked with one SIMD pass.
+/// @tparam Data_t Arithmetic data type.
+/// @note Default range score = `PASS`. Invalid ranges never match.
+template <class Data_t> class VRangeSet_t {
+    static_assert(std::is_arithmetic<Data_t>::value, "VRangeSet_t ERROR: Data_t must be an arithmetic type.");
+    public:
+    template <class T> using AlignedVector_t = std::vector<T, VAlignedAllocator_t<T>>;
+
+    /// @brief Constructor from ranges and their scores. Missing scores default to `PASS`.
+    VRangeSet_t(const std::vector<VRange_t<Data_t>> &ranges, const std::vector<VReturn_t> &scores = {}) {
+        for (size_t i = 0; i < ranges.size(); ++i) { add(ranges[i], i < scores.size() ? scores[i] : VReturn_t::PASS); }}
+    /// @brief Default constructor.
+    VRangeSet_t() {}
+
+    /// @brief Adds a scored range.
+    /// @return Range index as `size_t`.
+    size_t add(const VRange_t<Data_t> &range, const VReturn_t &score = VReturn_t::PASS) {
+        const size_t i = count_++;
+        if (count_ > lo_.size()) {
+            lo_.resize(lo_.size() + 64, LOWEST_BOUND_INV);
+            hi_.resize(hi_.size() + 64, HIGHEST_BOUND_INV);
+            invert_.push_back(0); }
+        Data_t lo = LOWEST, hi = HIGHEST; bool invert = false;
+        if (range.isInvalid())                       { lo = LOWEST_BOUND_INV; hi = HIGHEST_BOUND_INV; }
+        else if (~range)                             { lo = _next(range.getMax()); hi = _prev(range.getMin()); invert = true; }
+        else {
+            if (range.hasMin()) { lo = range.getMin(); }
+            if (range.hasMax()) { hi = range.getMax(); }
+            if (!range.hasMin() && !range.hasMax())  { lo = LOWEST_BOUND_INV; hi = HIGHEST_BOUND_INV; }}
+        lo_[i] = lo; hi_[i] = hi;
+        invert_[i >> 6] |= uint64_t(invert) << (i & 63);
+        ranks_.push_back(uint_t(score() + 1));
+        return i; }
+
+    /// @brief Gets the number of bitmask words per value.
+    size_t numWords() const { return invert_.size(); }
+    /// @brief Gets the number of ranges.
+    size_t size() const { return count_; }
+
+    /// @brief Checks a value against every range.
+    /// @param out Bitmask of matching ranges as `uint64_t[numWords()]`. Bit `i` = range `i`.
+    void match(const Data_t &value, uint64_t *out) const {
+        for (size_t w = 0; w < invert_.size(); ++w) { out[w] = _word(value, w); }}
+
+    /// @brief Gets the indices of every range containing a value, in range order.
+    std::vector<size_t> matches(const Data_t &value) const {
+        std::vector<size_t> ret;
+        for (size_t w = 0; w < invert_.size(); ++w) {
+            for (uint64_t bits = _word(value, w); bits; bits &= bits - 1) {
+                ret.push_back(w * 64 + _ctz(bits)); }}
+        return ret; }
+
+    /// @brief Gets the best score of every range containing a value.
+    /// @return Highest matching `VReturn_t`, or `FAIL` if no range contains the value.
+    VReturn_t query(const Data_t &value) const {
+        uint_t best = 0;
+        for (size_t w = 0; w < invert_.size(); ++w) {
+            for (uint64_t bits = _word(value, w); bits; bits &= bits - 1) {
+                const uint_t rank = ranks_[w * 64 + _ctz(bits)];
+                best = (rank > best) ? rank : best; }}
+        return VReturn_t(uint_t(best - 1)); }
+
+    /// @brief Operator overload to get the best score.
+    VReturn_t operator()(const Data_t &value) const { return query(value); }
+
+    /// @brief Checks many values against every range.
+    /// @param out Bitmasks as `uint64_t[count * numWords()]`, value major.
+    void match(const Data_t *values, const size_t &count, uint64_t *out) const {
+        const size_t words = invert_.size();
+        for (size_t v = 0; v < count; ++v) { match(values[v], out + v * words); }}
+
+    /// @brief Gets the best score for many values.
+    /// @param out Best scores as `VReturn_t[count]`.
+    void query(const Data_t *values, const size_t &count, VReturn_t *out) const {
+        for (size_t v = 0; v < count; ++v) { out[v] = query(values[v]); }}
+
+    private:
+    static constexpr Data_t LOWEST  = std::numeric_limits<Data_t>::has_infinity ? -std::numeric_limits<Data_t>::infinity() : std::numeric_limits<Data_t>::lowest();
+    static constexpr Data_t HIGHEST = std::numeric_limits<Data_t>::has_infinity ?  std::numeric_limits<Data_t>::infinity() : std::numeric_limits<Data_t>::max();
+    // An empty interval: lo > hi, so nothing matches
+    static constexpr Data_t LOWEST_BOUND_INV  = HIGHEST;
+    static constexpr Data_t HIGHEST_BOUND_INV = LOWEST;
+
+    AlignedVector_t<Data_t> lo_{};
+    AlignedVector_t<Data_t> hi_{};
+    std::vector<uint64_t> invert_{};
+    std::vector<uint_t> ranks_{}; // Score + 1, so FAIL wraps to 0 and ranks below every other score
+    size_t count_ = 0;
+
+    static size_t _ctz(const uint64_t &bits) {
+#if defined(__GNUC__) || defined(__clang__)
+        return size_t(__builtin_ctzll(bits));
+#else
+        size_t n = 0; for (uint64_t b = bits; !(b & 1); b >>= 1) { ++n; } return n;
+#endif
+    }
+    /// @brief Smallest value above `v`. Saturates at the type maximum.
+    static Data_t _next(const Data_t &v) {
+        if constexpr (std::is_floating_point<Data_t>::value) { return std::nextafter(v, HIGHEST); }
+        else { return v == HIGHEST ? v : Data_t(v + 1); }}
+    /// @brief Largest value below `v`. Saturates at the type minimum.
+    static Data_t _prev(const Data_t &v) {
+        if constexpr (std::is_floating_point<Data_t>::value) { return std::nextafter(v, LOWEST); }
+        else { return v == LOWEST ? v : Data_t(v - 1); }}
+
+    /// @brief Gets the match bits of bitmask word `w`. NaN matches nothing.
+    uint64_t _word(const Data_t &value, const size_t &w) const {
+        return (value == value) ? (_matchWord(value, w * 64) ^ invert_[w]) : 0; }
+
+    /// @brief Checks a value against 64 closed intervals starting at `first`. Returns one bit per interval.
+    uint64_t _matchWord(const Data_t &value, const size_t &first) const {
+        const Data_t *lo = lo_.data() + first, *hi = hi_.data() + first;
+#if defined(__AVX2__)
+        if constexpr (std::is_same<Data_t, float>::value) {
+            const __m256 v = _mm256_set1_ps(value);
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; j += 8) {
+                __m256 in = _mm256_and_ps(_mm256_cmp_ps(v, _mm256_load_ps(lo + j), _CMP_GE_OQ),
+                                          _mm256_cmp_ps(v, _mm256_load_ps(hi + j), _CMP_LE_OQ));
+                bits |= uint64_t(uint32_t(_mm256_movemask_ps(in))) << j; }
+            return bits; }
+        if constexpr (std::is_same<Data_t, double>::value) {
+            const __m256d v = _mm256_set1_pd(value);
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; j += 4) {
+                __m256d in = _mm256_and_pd(_mm256_cmp_pd(v, _mm256_load_pd(lo + j), _CMP_GE_OQ),
+                                           _mm256_cmp_pd(v, _mm256_load_pd(hi + j), _CMP_LE_OQ));
+                bits |= uint64_t(uint32_t(_mm256_movemask_pd(in))) << j; }
+            return bits; }
+#endif
+        // Portable path: branchless compares the compiler can vectorize
+        uint8_t in[64];
+        for (size_t j = 0; j < 64; ++j) { in[j] = uint8_t((value >= lo[j]) & (value <= hi[j])); }
+        uint64_t bits = 0;
+        for (size_t j = 0; j < 64; ++j) { bits |= uint64_t(in[j]) << j; }
+        return bits; }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+} // END: namespace Validspace                                                                                             ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1,6 +1,6 @@
 #pragma once
 /**
- * @file src/keyed_data_t.hpp
+ * @file src/range_t.hpp
  * @author Ray Richter
  * @brief VRange_t Class declaration. 
  * @note Operator overrides: 
@@ -46,6 +46,14 @@ public:
     bool operator~ () const { return cfg(EXCLUSIVE); }
     bool operator()(const Data_t &data) const { return query(data); }
 
+    /// @brief Gets a copy of the minimum. Only valid if `hasMin()`.
+    const Data_t getMin () const { return min; }
+    /// @brief Gets a copy of the maximum. Only valid if `hasMax()`.
+    const Data_t getMax () const { return max; }
+    bool hasMin   () const { return cfg(HAS_MIN); }
+    bool hasMax   () const { return cfg(HAS_MAX); }
+    bool isInvalid() const { return cfg(INVALID); }
+
     bool addMin(const Data_t &data) {
         if (cfg(HAS_MIN) || cfg(INVALID)) return false;
         if (cfg(HAS_MAX) && data == max) { cfg += INVALID; return false; }
@@ -58,14 +66,16 @@ public:
         max = data; cfg += HAS_MAX; return true; }
     /// @brief Adds keyed data to the range. Returns `false` if the key is invalid and no data is added.
     bool addKeyedData(const VKeyedData_t<Data_t> &kd) {
-        switch (kd.getKey()) {
-        case VKey_t::MINIMUM: return addMin(kd.getData());
-        case VKey_t::MAXIMUM: return addMax(kd.getData());
+        switch (--kd) {
+        case VKey_t::MINIMUM: return addMin(kd.getCData());
+        case VKey_t::MAXIMUM: return addMax(kd.getCData());
         default: return false; }}
-    /// @brief Checks if queried data is within the range.
+    /// @brief Checks if queried data is within the range. Exclusive ranges contain data >= min or <= max.
     bool query(const Data_t &data) const {
         if (cfg(INVALID  )) return false;
-        if (cfg(EXCLUSIVE)) return data < min || data > max;
+        if (cfg(EXCLUSIVE)) return data >= min || data <= max;
+        if (!cfg(HAS_MIN )) return cfg(HAS_MAX) && data <= max;
+        if (!cfg(HAS_MAX )) return data >= min;
         return data >= min && data <= max; }
 };
 
@@ -0,0 +1,108 @@
+#pragma once
+/**
+ * @file src/ranking_t.hpp
+ * @author Ray Richter
+ * @brief VDeadline_t and VRanking_t declarations. Top K ranking of candidates under a time budget.
+ * @note Candidates are scored a chunk at a time through the source's batch path, and the clock is read once per chunk,
+ * so a `steady_clock` read (~20 ns) costs well under a nanosecond per candidate. At least one chunk is always scored, and
+ * the deadline can be overrun by at most the time of one chunk. A ranking that stops early is marked `partial`. Scoring
+ * in priority order (see `VRanking_t::priorityOrder`) puts the likely winners in the chunks that run first.
+ */
+#include "Validator_core.hpp"
+#include "return_t.hpp"
+#include "result_column_t.hpp"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// @brief Internal Validator namespace.                                                                                  ////
+namespace Validspace {                                                                                                     ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief A point in time to stop work at.
+class VDeadline_t {
+    public:
+    using Clock_t = std::chrono::steady_clock;
+
+    /// @brief Constructor from a point in time.
+    VDeadline_t(const Clock_t::time_point &at) : at_(at) {}
+    /// @brief Constructor from a budget that starts now.
+    template <class Rep, class Period> VDeadline_t(const std::chrono::duration<Rep, Period> &budget)
+        : at_(Clock_t::now() + std::chrono::duration_cast<Clock_t::duration>(budget)) {}
+
+    /// @brief Gets a deadline that never passes. Checking it does not read the clock.
+    static VDeadline_t never() { return VDeadline_t(Clock_t::time_point::max()); }
+
+    /// @brief Checks if the deadline has passed.
+    bool expired() const { return at_ != Clock_t::time_point::max() && Clock_t::now() >= at_; }
+    /// @brief Gets the point in time.
+    Clock_t::time_point at() const { return at_; }
+
+    private:
+    Clock_t::time_point at_;
+};
+
+/// @brief The best candidates found before a deadline.
+struct VRanking_t {
+    std::vector<size_t>    indices;           // Candidate indices, best first. FAIL candidates are left out
+    std::vector<VReturn_t> results;           // Results of those candidates
+    size_t                 evaluated = 0;     // Candidates scored
+    bool                   partial   = false; // The deadline passed before every candidate was scored
+
+    /// @brief Gets the index of the best candidate, or `SIZE_MAX` if none passed.
+    size_t best() const { return indices.empty() ? SIZE_MAX : indices.front(); }
+    /// @brief Gets the number of ranked candidates.
+    size_t size() const { return indices.size(); }
+
+    /// @brief Gets candidate indices by descending priority, for `rankWithin`. Equal priorities keep their order.
+    /// @note Sorting is O(n log n). Compute the order ahead of the request when the budget is tight.
+    template <class P> static std::vector<size_t> priorityOrder(const P *priorities, const size_t &count) {
+        std::vector<size_t> ret(count);
+        for (size_t i = 0; i < count; ++i) { ret[i] = i; }
+        std::stable_sort(ret.begin(), ret.end(), [&](const size_t &a, const size_t &b) { return priorities[b] < priorities[a]; });
+        return ret; }
+};
+
+/// @brief Ranks the best `k` candidates found before a deadline.
+/// @tparam Source_t Any keyed list, index, curve, or validator. See `queryBatch`.
+/// @param order Optional candidate indices as `size_t[count]`, scored in that order. `nullptr` scores `values` in order.
+/// @param chunk Candidates scored between clock reads.
+/// @note Higher ranks win (see `resultRank`), ties go to the lower candidate index. FAIL candidates are never ranked.
+template <class Source_t, class T>
+VRanking_t rankWithin(const Source_t &source, const T *values, const size_t &count, const size_t &k,
+                      const VDeadline_t &deadline, const size_t *order = nullptr, const size_t &chunk = RESULT_BLOCK) {
+    using Entry_t = std::pair<uint_t, size_t>; // Rank, candidate index
+    // Heap order: the worst kept candidate is at the front
+    auto better = [](const Entry_t &a, const Entry_t &b) { return a.first > b.first || (a.first == b.first && a.second < b.second); };
+    VRanking_t ret;
+    if (k == 0 || count == 0) return ret;
+    const size_t step = std::max<size_t>(chunk, 1);
+    std::vector<VReturn_t> block(std::min(step, count));
+    std::vector<T> gathered;
+    std::vector<Entry_t> heap;
+    heap.reserve(std::min(k, count));
+    for (size_t first = 0; first < count; first += step) {
+        if (first != 0 && deadline.expired()) { ret.partial = true; break; }
+        const size_t n = std::min(step, count - first);
+        if (order) {
+            gathered.clear();
+            for (size_t i = 0; i < n; ++i) { gathered.push_back(values[order[first + i]]); }
+            queryBatch(source, gathered.data(), n, block.data()); }
+        else { queryBatch(source, values + first, n, block.data()); }
+        for (size_t i = 0; i < n; ++i) {
+            const Entry_t e{resultRank(block[i]), order ? order[first + i] : first + i};
+            if (e.first == 0) continue;
+            if (heap.size() < k) { heap.push_back(e); std::push_heap(heap.begin(), heap.end(), better); }
+            else if (better(e, heap.front())) {
+                std::pop_heap(heap.begin(), heap.end(), better);
+                heap.back() = e;
+                std::push_heap(heap.begin(), heap.end(), better); }}
+        ret.evaluated += n; }
+    std::sort(heap.begin(), heap.end(), better);
+    for (const auto &e : heap) { ret.indices.push_back(e.second); ret.results.push_back(VReturn_t(uint_t(e.first - 1))); }
+    return ret; }
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+} // END: namespace Validspace                                                                                             ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
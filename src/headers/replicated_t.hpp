@@ -0,0 +1,189 @@
+#pragma once
+/**
+ * @file src/replicated_t.hpp
+ * @author Ray Richter
+ * @brief VReplicated_t and VNumaTopology_t Class declarations.
+ * @note Keeps one copy of a read only validator (`VPerfectHash_t`, `VCompactKeyedList_t`, `Validator_t`, ...) per NUMA
+ * node so every thread queries memory on its own node. Each replica is built by a thread bound to its node, so its
+ * memory is placed there by first touch. When built with `V_USE_LIBNUMA`, the build thread also sets its preferred
+ * node through libnuma. Replicas are published together as one snapshot, so every node sees the same rule set version.
+ * Node discovery reads `/sys/devices/system/node` on Linux. Other platforms are treated as a single node.
+ */
+#include "Validator_core.hpp"
+#include "return_t.hpp"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#if defined(__linux__)
+#include <fstream>
+#include <sched.h>
+#endif
+#if defined(V_USE_LIBNUMA)
+#include <numa.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// @brief Internal Validator namespace.                                                                                  ////
+namespace Validspace {                                                                                                     ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief NUMA nodes and their CPUs.
+class VNumaTopology_t {
+    public:
+    /// @brief Gets the topology of this machine. Read once.
+    static const VNumaTopology_t& get() { static const VNumaTopology_t topology; return topology; }
+
+    /// @brief Gets the number of nodes. Always >= 1.
+    size_t numNodes() const { return cpus_.size(); }
+    /// @brief Gets the CPUs of a node. Empty if unknown.
+    const std::vector<int>& cpus(const size_t &node) const { return cpus_[node]; }
+    /// @brief Gets the node of a CPU, or 0 if unknown.
+    size_t nodeOf(const int &cpu) const { return (cpu >= 0 && size_t(cpu) < nodeOf_.size()) ? nodeOf_[cpu] : 0; }
+
+    /// @brief Gets the node the calling thread is running on, or 0 if unknown.
+    size_t currentNode() const {
+#if defined(__linux__)
+        if (cpus_.size() > 1) return nodeOf(sched_getcpu());
+#endif
+        return 0; }
+
+    /// @brief Binds the calling thread to the CPUs of a node.
+    /// @return `false` if the thread could not be bound.
+    bool bindThread(const size_t &node) const {
+        if (node >= cpus_.size()) return false;
+#if defined(V_USE_LIBNUMA)
+        if (numa_available() >= 0) { numa_set_preferred(int(node)); return numa_run_on_node(int(node)) == 0; }
+#endif
+#if defined(__linux__)
+        if (cpus_[node].empty()) return false;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (const int &cpu : cpus_[node]) { CPU_SET(cpu, &set); }
+        return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+        return false;
+#endif
+    }
+
+    private:
+    std::vector<std::vector<int>> cpus_{};
+    std::vector<size_t> nodeOf_{};
+
+    VNumaTopology_t() {
+#if defined(__linux__)
+        for (size_t node = 0;; ++node) {
+            std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            std::string list;
+            if (!file || !std::getline(file, list)) break;
+            cpus_.push_back(_parseList(list));
+            for (const int &cpu : cpus_.back()) {
+                if (size_t(cpu) >= nodeOf_.size()) { nodeOf_.resize(cpu + 1, 0); }
+                nodeOf_[cpu] = node; }}
+#endif
+        if (cpus_.empty()) { cpus_.emplace_back(); }}
+
+    /// @brief Parses a sysfs CPU list, "0-3,8-11".
+    static std::vector<int> _parseList(const std::string &list) {
+        std::vector<int> ret;
+        size_t pos = 0;
+        while (pos < list.size()) {
+            size_t end = list.find(',', pos);
+            if (end == std::string::npos) { end = list.size(); }
+            const std::string range = list.substr(pos, end - pos);
+            const size_t dash = range.find('-');
+            try {
+                int first = std::stoi(range), last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+                for (int cpu = first; cpu <= last; ++cpu) { ret.push_back(cpu); }}
+            catch (...) {}
+            pos = end + 1; }
+        return ret; }
+};
+
+/// @brief One read only copy of a validator per NUMA node.
+/// @tparam Index_t Read only validator type with `query` or `validate`, and a constructor from the published source.
+/// @note Query through a `Handle_t`, one per thread. A handle follows republished rule sets on its next query.
+template <class Index_t> class VReplicated_t {
+    public:
+    /// @brief Replicas of one rule set version.
+    struct Snapshot_t {
+        std::vector<std::shared_ptr<const Index_t>> replicas;
+        uint64_t generation; };
+
+    /// @brief A thread's view of the replicas. Not thread safe, keep one per thread.
+    class Handle_t {
+        public:
+        /// @brief Queries the replica of the handle's node.
+        template <class T> VReturn_t query(const T &qData) {
+            _refresh();
+            if constexpr (_hasQuery<Index_t, T>(0)) { return index_->query(qData); }
+            else { return index_->validate(qData); }}
+        /// @brief Operator overload to query data.
+        template <class T> VReturn_t operator()(const T &qData) { return query(qData); }
+        /// @brief Gets the node of the replica this handle queries.
+        size_t node() const { return node_; }
+        /// @brief Gets the replica this handle queries.
+        const Index_t& replica() { _refresh(); return *index_; }
+
+        private:
+        friend class VReplicated_t;
+        const VReplicated_t *owner_;
+        size_t node_;
+        uint64_t generation_ = 0;
+        std::shared_ptr<const Snapshot_t> snapshot_{};
+        const Index_t *index_ = nullptr;
+
+        Handle_t(const VReplicated_t &owner, const size_t &node) : owner_(&owner), node_(node) { _refresh(); }
+        /// @brief Picks up a republished snapshot. One atomic load when nothing changed.
+        void _refresh() {
+            if (generation_ == owner_->generation_.load(std::memory_order_acquire) && index_) return;
+            snapshot_ = std::atomic_load(&owner_->snapshot_);
+            generation_ = snapshot_->generation;
+            index_ = snapshot_->replicas[node_ % snapshot_->replicas.size()].get(); }
+    };
+
+    /// @brief Constructor from the source of the first rule set. See `publish`.
+    template <class Source> VReplicated_t(const Source &source, const bool &replicate = true) { publish(source, replicate); }
+
+    /// @brief Builds a replica of `source` on every node, then swaps all of them in at once. Handles switch on their
+    /// next query, and old replicas are freed when the last handle using them moves on.
+    /// @param source Anything `Index_t` can be constructed from, such as a `VKeyedList_t`.
+    /// @param replicate `false` builds a single copy shared by every node.
+    template <class Source> void publish(const Source &source, const bool &replicate = true) {
+        const VNumaTopology_t &topology = VNumaTopology_t::get();
+        const size_t numNodes = replicate ? topology.numNodes() : 1;
+        auto snapshot = std::make_shared<Snapshot_t>();
+        snapshot->replicas.resize(numNodes);
+        for (size_t node = 0; node < numNodes; ++node) {
+            // Build on a thread bound to the node so first touch places the replica's memory there
+            std::thread builder([&, node] {
+                if (numNodes > 1) { topology.bindThread(node); }
+                snapshot->replicas[node] = std::make_shared<const Index_t>(source); });
+            builder.join(); }
+        std::lock_guard<std::mutex> lock(publishMutex_);
+        snapshot->generation = generation_.load(std::memory_order_relaxed) + 1;
+        std::atomic_store(&snapshot_, std::shared_ptr<const Snapshot_t>(std::move(snapshot)));
+        generation_.store(snapshot_->generation, std::memory_order_release); }
+
+    /// @brief Gets a handle for the calling thread's node.
+    Handle_t handle() const { return Handle_t(*this, VNumaTopology_t::get().currentNode()); }
+    /// @brief Gets a handle for a given node. Used to measure remote queries.
+    Handle_t handle(const size_t &node) const { return Handle_t(*this, node); }
+
+    /// @brief Gets the number of replicas.
+    size_t numReplicas() const { return std::atomic_load(&snapshot_)->replicas.size(); }
+    /// @brief Gets the number of published rule sets.
+    uint64_t generation() const { return generation_.load(std::memory_order_acquire); }
+
+    private:
+    std::shared_ptr<const Snapshot_t> snapshot_{};
+    std::atomic<uint64_t> generation_{0};
+    std::mutex publishMutex_;
+
+    template <class I, class T> static constexpr auto _hasQuery(int) -> decltype(std::declval<const I&>().query(std::declval<const T&>()), bool()) { return true; }
+    template <class I, class T> static constexpr bool _hasQuery(...) { return false; }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+} // END: namespace Validspace                                                                                             ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
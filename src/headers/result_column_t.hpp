@@ -0,0 +1,232 @@
+#pragma once
+/**
+ * @file src/result_column_t.hpp
+ * @author Ray Richter
+ * @brief VResultColumn_t Class declaration. Compact batch result columns and fused batch reductions.
+ * @note A `VReturn_t` result is `sizeof(uint_t)` bytes. Columns pack results into 1 bit (pass/fail), 2 bits (result class)
+ * or 16 bits (saturated score) per item. Batches are queried a block at a time into a small buffer that stays in L1 and
+ * packed from there, so full width results never reach memory. The reductions (`summarize`, `countPassing`, `sumScores`,
+ * `argmax`) keep running totals per block and write no per item results at all.
+ */
+#include "Validator_core.hpp"
+#include "return_t.hpp"
+#include <algorithm>
+#include <bitset>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// @brief Internal Validator namespace.                                                                                  ////
+namespace Validspace {                                                                                                     ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Result column encodings.
+enum class VResultEncoding_t : uint8_t {
+    PASS_MASK, // 1 bit: 1 = not FAIL
+    CLASS,     // 2 bits: VResultClass_t
+    SCORE16,   // 16 bits: score saturated at SCORE16_MAX, FAIL = 0xffff, PERFECT = 0xfffe
+};
+
+/// @brief Result classes, in rank order.
+enum class VResultClass_t : uint8_t { FAIL, PASS, SCORE, PERFECT };
+
+/// @brief Gets the class of a result.
+inline VResultClass_t resultClass(const VReturn_t &ret) {
+    const uint_t score = ret();
+    if (score == VReturn_t::FAIL)    return VResultClass_t::FAIL;
+    if (score == VReturn_t::PERFECT) return VResultClass_t::PERFECT;
+    return (score == VReturn_t::PASS) ? VResultClass_t::PASS : VResultClass_t::SCORE; }
+
+/// @brief Gets a rank where better results are larger: FAIL = 0, then PASS, scores, and PERFECT.
+inline uint_t resultRank(const uint_t &score) { return uint_t(score + 1); } // FAIL wraps to 0
+/// @brief Gets the rank of a result. See `resultRank(uint_t)`.
+inline uint_t resultRank(const VReturn_t &ret) { return resultRank(ret()); }
+
+/// @brief A packed column of batch results.
+/// @tparam Encoding Column encoding as `VResultEncoding_t`.
+template <VResultEncoding_t Encoding> class VResultColumn_t {
+    public:
+    /// @brief Bits per item.
+    static constexpr size_t BITS = (Encoding == VResultEncoding_t::PASS_MASK) ? 1 : (Encoding == VResultEncoding_t::CLASS) ? 2 : 16;
+    /// @brief `SCORE16` codes.
+    static constexpr uint16_t SCORE16_FAIL = 0xffff, SCORE16_PERFECT = 0xfffe, SCORE16_MAX = 0xfffd;
+
+    /// @brief Constructor. Every item starts as `FAIL`.
+    VResultColumn_t(const size_t &size = 0) { resize(size); }
+
+    /// @brief Resizes the column. Every item is reset to `FAIL`.
+    void resize(const size_t &size) {
+        size_ = size;
+        words_.assign((size * BITS + 63) / 64, (Encoding == VResultEncoding_t::SCORE16) ? ~uint64_t(0) : 0); }
+
+    /// @brief Encodes a result.
+    static uint64_t encode(const VReturn_t &ret) {
+        const uint_t score = ret();
+        if constexpr (Encoding == VResultEncoding_t::PASS_MASK) { return uint64_t(score != VReturn_t::FAIL); }
+        else if constexpr (Encoding == VResultEncoding_t::CLASS) {
+            // Branchless VResultClass_t
+            return uint64_t(score != VReturn_t::FAIL) * (1 + uint64_t(score != VReturn_t::PASS) + uint64_t(score == VReturn_t::PERFECT)); }
+        else {
+            const uint64_t special = SCORE16_PERFECT + uint64_t(score == VReturn_t::FAIL);
+            return (score >= VReturn_t::PERFECT) ? special : std::min<uint64_t>(score, SCORE16_MAX); }}
+
+    /// @brief Stores results for items `[first, first + count)`. Whole words are packed in a register and written once.
+    void store(const VReturn_t *results, const size_t &count, const size_t &first) {
+        constexpr uint64_t MASK = (uint64_t(1) << BITS) - 1;
+        constexpr size_t PER_WORD = 64 / BITS;
+        size_t i = 0;
+        // Items up to the next word boundary
+        for (; i < count && ((first + i) * BITS & 63) != 0; ++i) { _put(first + i, encode(results[i]), MASK); }
+        // Whole words
+        for (; i + PER_WORD <= count; i += PER_WORD) {
+            uint64_t word = 0;
+            for (size_t k = 0; k < PER_WORD; ++k) { word |= encode(results[i + k]) << (k * BITS); }
+            words_[(first + i) * BITS >> 6] = word; }
+        // The rest
+        for (; i < count; ++i) { _put(first + i, encode(results[i]), MASK); }}
+    /// @brief Stores one result.
+    void set(const size_t &index, const VReturn_t &ret) { store(&ret, 1, index); }
+
+    /// @brief Gets the code of an item.
+    uint64_t code(const size_t &index) const {
+        const size_t bit = index * BITS;
+        return (words_[bit >> 6] >> (bit & 63)) & ((uint64_t(1) << BITS) - 1); }
+
+    /// @brief Gets the class of an item. `PASS_MASK` only knows `FAIL` and `PASS`.
+    VResultClass_t resultClass(const size_t &index) const {
+        const uint64_t c = code(index);
+        if constexpr (Encoding == VResultEncoding_t::PASS_MASK) { return c ? VResultClass_t::PASS : VResultClass_t::FAIL; }
+        else if constexpr (Encoding == VResultEncoding_t::CLASS) { return VResultClass_t(c); }
+        else {
+            if (c == SCORE16_FAIL)    return VResultClass_t::FAIL;
+            if (c == SCORE16_PERFECT) return VResultClass_t::PERFECT;
+            return c ? VResultClass_t::SCORE : VResultClass_t::PASS; }}
+
+    /// @brief Decodes an item. `PASS_MASK` decodes to `PASS` or `FAIL`, `CLASS` decodes scores to 1, and `SCORE16`
+    /// decodes scores above `SCORE16_MAX` to `SCORE16_MAX`.
+    VReturn_t operator[](const size_t &index) const {
+        if constexpr (Encoding == VResultEncoding_t::SCORE16) {
+            const uint64_t c = code(index);
+            if (c == SCORE16_FAIL)    return VReturn_t::FAIL;
+            if (c == SCORE16_PERFECT) return VReturn_t::PERFECT;
+            return uint_t(c); }
+        else {
+            switch (resultClass(index)) {
+            case VResultClass_t::FAIL:    return VReturn_t::FAIL;
+            case VResultClass_t::PASS:    return VReturn_t::PASS;
+            case VResultClass_t::PERFECT: return VReturn_t::PERFECT;
+            default:                      return uint_t(1); }}}
+
+    /// @brief Counts items that are not `FAIL`, a word at a time.
+    size_t countPassing() const {
+        size_t count = 0;
+        if constexpr (Encoding == VResultEncoding_t::PASS_MASK) {
+            for (const auto &w : words_) { count += std::bitset<64>(w).count(); }}
+        else if constexpr (Encoding == VResultEncoding_t::CLASS) {
+            // A class is FAIL when both of its bits are 0. Padding bits are 0
+            for (const auto &w : words_) { count += std::bitset<64>((w | (w >> 1)) & 0x5555555555555555ULL).count(); }}
+        else { for (size_t i = 0; i < size_; ++i) { count += code(i) != SCORE16_FAIL; }}
+        return count; }
+
+    /// @brief Gets the number of items.
+    size_t size() const { return size_; }
+    /// @brief Gets the packed words.
+    const std::vector<uint64_t>& words() const { return words_; }
+    /// @brief Gets the column memory in bytes.
+    size_t memoryBytes() const { return words_.size() * sizeof(uint64_t); }
+
+    private:
+    std::vector<uint64_t> words_{};
+    size_t size_ = 0;
+
+    void _put(const size_t &index, const uint64_t &code, const uint64_t &mask) {
+        const size_t bit = index * BITS, shift = bit & 63;
+        uint64_t &word = words_[bit >> 6];
+        word = (word & ~(mask << shift)) | (code << shift); }
+};
+
+/// @brief Pass/fail bitmask column.
+using VPassMask_t    = VResultColumn_t<VResultEncoding_t::PASS_MASK>;
+/// @brief 2 bit result class column.
+using VClassColumn_t = VResultColumn_t<VResultEncoding_t::CLASS>;
+/// @brief 16 bit saturated score column.
+using VScoreColumn_t = VResultColumn_t<VResultEncoding_t::SCORE16>;
+
+/// @brief Items per block. Block results stay in L1.
+constexpr size_t RESULT_BLOCK = 256;
+
+template <class S, class T> constexpr auto _hasBatchQuery(int) -> decltype(std::declval<const S&>().query(std::declval<const T*>(), size_t(), std::declval<VReturn_t*>()), bool()) { return true; }
+template <class S, class T> constexpr bool _hasBatchQuery(...) { return false; }
+template <class S, class T> constexpr auto _hasBatchValidate(int) -> decltype(std::declval<const S&>().validate(std::declval<const T*>(), size_t(), std::declval<VReturn_t*>()), bool()) { return true; }
+template <class S, class T> constexpr bool _hasBatchValidate(...) { return false; }
+template <class S, class T> constexpr auto _hasQuery(int) -> decltype(std::declval<const S&>().query(std::declval<const T&>()), bool()) { return true; }
+template <class S, class T> constexpr bool _hasQuery(...) { return false; }
+template <class S, class T> constexpr auto _hasValidate(int) -> decltype(std::declval<const S&>().validate(std::declval<const T&>()), bool()) { return true; }
+template <class S, class T> constexpr bool _hasValidate(...) { return false; }
+
+/// @brief Queries one value with a source's `query`, `validate`, or call operator.
+template <class Source_t, class T> VReturn_t queryOne(const Source_t &source, const T &value) {
+    if constexpr (_hasQuery<Source_t, T>(0))         { return source.query(value); }
+    else if constexpr (_hasValidate<Source_t, T>(0)) { return source.validate(value); }
+    else { return source(value); }}
+
+/// @brief Queries a batch with the best call a source has: a batch `query`, a batch `validate`, or one `query`,
+/// `validate`, or call per value.
+/// @tparam Source_t Any keyed list, index, curve, or validator.
+template <class Source_t, class T> void queryBatch(const Source_t &source, const T *values, const size_t &count, VReturn_t *out) {
+    if constexpr (_hasBatchQuery<Source_t, T>(0))         { source.query(values, count, out); }
+    else if constexpr (_hasBatchValidate<Source_t, T>(0)) { source.validate(values, count, out); }
+    else { for (size_t i = 0; i < count; ++i) { out[i] = queryOne(source, values[i]); }}}
+
+/// @brief Queries a batch into a compact column. The column is resized to `count`.
+template <VResultEncoding_t Encoding, class Source_t, class T>
+void queryColumn(const Source_t &source, const T *values, const size_t &count, VResultColumn_t<Encoding> &column) {
+    VReturn_t block[RESULT_BLOCK];
+    column.resize(count);
+    for (size_t first = 0; first < count; first += RESULT_BLOCK) {
+        const size_t n = std::min(RESULT_BLOCK, count - first);
+        queryBatch(source, values + first, n, block);
+        column.store(block, n, first); }}
+
+/// @brief Totals of a batch. See `summarize`.
+struct VResultSummary_t {
+    size_t    count    = 0;              // Items
+    size_t    passing  = 0;              // Items that are not FAIL
+    size_t    perfect  = 0;              // PERFECT items
+    size_t    scored   = 0;              // Items with a score other than PASS, FAIL, or PERFECT
+    uint64_t  scoreSum = 0;              // Sum of those scores
+    size_t    best     = SIZE_MAX;       // Index of the first best item, SIZE_MAX if every item FAILs
+    VReturn_t bestResult{VReturn_t::FAIL};
+};
+
+/// @brief Queries a batch and reduces it to totals and the best item in one pass, without per item output.
+template <class Source_t, class T> VResultSummary_t summarize(const Source_t &source, const T *values, const size_t &count) {
+    VReturn_t block[RESULT_BLOCK];
+    VResultSummary_t sum;
+    uint_t bestRank = 0;
+    for (size_t first = 0; first < count; first += RESULT_BLOCK) {
+        const size_t n = std::min(RESULT_BLOCK, count - first);
+        queryBatch(source, values + first, n, block);
+        for (size_t i = 0; i < n; ++i) {
+            const uint_t score = block[i](), rank = resultRank(block[i]);
+            const bool isScore = score != VReturn_t::PASS && score < VReturn_t::PERFECT;
+            sum.passing  += score != VReturn_t::FAIL;
+            sum.perfect  += score == VReturn_t::PERFECT;
+            sum.scored   += isScore;
+            sum.scoreSum += isScore ? uint64_t(score) : 0;
+            if (rank > bestRank) { bestRank = rank; sum.best = first + i; sum.bestResult = block[i]; }}}
+    sum.count = count;
+    return sum; }
+
+/// @brief Counts batch items that are not `FAIL`. See `summarize`.
+template <class Source_t, class T> size_t countPassing(const Source_t &source, const T *values, const size_t &count) {
+    return summarize(source, values, count).passing; }
+/// @brief Sums batch scores, leaving out `PASS`, `FAIL`, and `PERFECT`. See `summarize`.
+template <class Source_t, class T> uint64_t sumScores(const Source_t &source, const T *values, const size_t &count) {
+    return summarize(source, values, count).scoreSum; }
+/// @brief Gets the index of the first best batch item, or `SIZE_MAX` if every item FAILs. See `summarize`.
+template <class Source_t, class T> size_t argmax(const Source_t &source, const T *values, const size_t &count) {
+    return summarize(source, values, count).best; }
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+} // END: namespace Validspace                                                                                             ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,417 @@
+#pragma once
+/**
+ * @file src/roaring_set_t.hpp
+ * @author Ray Richter
+ * @brief VRoaringSet_t and VRoaringKeyedList_t Class declarations.
+ * @note Compressed integer sets in the Roaring layout. Values are split by their high bits into chunks of 65536, and
+ * each chunk that holds values gets the smallest of three containers:
+ *  - ARRAY:  Sorted 16 bit low values. 2 bytes per value, up to 4096 values.
+ *  - BITMAP: One bit per low value. Always 8 KB.
+ *  - RUNS:   Sorted (start, length - 1) pairs. 4 bytes per run of consecutive values.
+ * A membership check is a binary search over chunk keys, then a bit test or a branchless search in one container.
+ * Batches reuse the chunk of the last value, so clustered queries skip the chunk search. Union, intersection and
+ * difference work a chunk at a time: sorted merges of arrays, filters of arrays, and word loops over bitmaps.
+ */
+#include "Validator_core.hpp"
+#include "keyed_list_t.hpp"
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// @brief Internal Validator namespace.                                                                                  ////
+namespace Validspace {                                                                                                     ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Roaring container types.
+enum class VContainer_t : uint8_t { ARRAY, BITMAP, RUNS };
+
+/// @brief A compressed set of integers.
+/// @tparam Data_t Integral type, up to 64 bits.
+template <class Data_t> class VRoaringSet_t {
+    static_assert(std::is_integral<Data_t>::value && sizeof(Data_t) <= 8, "VRoaringSet_t ERROR: Data_t must be an integer type.");
+    public:
+    /// @brief Largest array container. Past this a bitmap is smaller.
+    static constexpr size_t ARRAY_MAX    = 4096;
+    /// @brief Words in a bitmap container.
+    static constexpr size_t BITMAP_WORDS = 1024;
+
+    /// @brief Constructor from values, in any order. Repeats are dropped.
+    VRoaringSet_t(const std::vector<Data_t> &values) { build(values.data(), values.size()); }
+    /// @brief Constructor from values, in any order. Repeats are dropped.
+    VRoaringSet_t(const Data_t *values, const size_t &count) { build(values, count); }
+    /// @brief Default constructor. Empty set.
+    VRoaringSet_t() {}
+
+    /// @brief Builds the set from values, in any order, replacing any previous contents.
+    void build(const Data_t *values, const size_t &count) {
+        std::vector<uint64_t> keys(count);
+        for (size_t i = 0; i < count; ++i) { keys[i] = _ordinal(values[i]); }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        highs_.clear(); containers_.clear(); size_ = keys.size();
+        std::vector<uint16_t> lows;
+        for (size_t i = 0; i < keys.size();) {
+            const uint64_t high = keys[i] >> 16;
+            lows.clear();
+            for (; i < keys.size() && (keys[i] >> 16) == high; ++i) { lows.push_back(uint16_t(keys[i])); }
+            highs_.push_back(high);
+            containers_.push_back(_fromSorted(lows)); }}
+
+    /// @brief Checks if a value is in the set.
+    bool contains(const Data_t &value) const {
+        const uint64_t key = _ordinal(value);
+        const size_t c = _findHigh(key >> 16);
+        return c != highs_.size() && _contains(containers_[c], uint16_t(key)); }
+    /// @brief Checks if a value is in the set. See `contains`.
+    bool operator()(const Data_t &value) const { return contains(value); }
+
+    /// @brief Checks many values. Values in the same chunk as the one before skip the chunk search.
+    /// @param out Output as `bool[count]`.
+    void contains(const Data_t *values, const size_t &count, bool *out) const {
+        uint64_t lastHigh = UINT64_MAX; size_t c = highs_.size();
+        for (size_t i = 0; i < count; ++i) {
+            const uint64_t key = _ordinal(values[i]), high = key >> 16;
+            if (high != lastHigh) { lastHigh = high; c = _findHigh(high); }
+            out[i] = c != highs_.size() && _contains(containers_[c], uint16_t(key)); }}
+
+    /// @brief Gets the union of two sets.
+    VRoaringSet_t operator|(const VRoaringSet_t &rhs) const { return _combine(*this, rhs, OR); }
+    /// @brief Gets the intersection of two sets.
+    VRoaringSet_t operator&(const VRoaringSet_t &rhs) const { return _combine(*this, rhs, AND); }
+    /// @brief Gets the values of this set that are not in `rhs`.
+    VRoaringSet_t operator-(const VRoaringSet_t &rhs) const { return _combine(*this, rhs, AND_NOT); }
+    VRoaringSet_t& operator|=(const VRoaringSet_t &rhs) { return *this = *this | rhs; }
+    VRoaringSet_t& operator&=(const VRoaringSet_t &rhs) { return *this = *this & rhs; }
+    VRoaringSet_t& operator-=(const VRoaringSet_t &rhs) { return *this = *this - rhs; }
+
+    /// @brief Gets every value in ascending order.
+    std::vector<Data_t> values() const {
+        std::vector<Data_t> ret;
+        ret.reserve(size_);
+        for (size_t c = 0; c < containers_.size(); ++c) {
+            _forEach(containers_[c], [&](const uint16_t &low) { ret.push_back(_value((highs_[c] << 16) | low)); }); }
+        return ret; }
+
+    /// @brief Gets the number of values.
+    size_t size() const { return size_; }
+    /// @brief Checks if the set is empty.
+    bool empty() const { return size_ == 0; }
+    /// @brief Gets the number of containers of a type.
+    size_t numContainers(const VContainer_t &type) const {
+        return size_t(std::count_if(containers_.begin(), containers_.end(), [&](const Container_t &c) { return c.type == type; })); }
+    /// @brief Memory used by the set in bytes. See `memoryUsage`.
+    size_t memoryBytes() const { return memoryUsage().total(); }
+    /// @brief Gets the bytes used by the set, by component. `data` is the container contents and `index` the chunk keys
+    /// and container headers.
+    VMemoryUsage_t memoryUsage() const {
+        VMemoryUsage_t ret;
+        ret.storage = VStorage_t::ROARING;
+        ret.index   = highs_.size() * sizeof(uint64_t) + containers_.size() * sizeof(Container_t);
+        ret.slack   = VMemoryUsage_t::slackOf(highs_) + VMemoryUsage_t::slackOf(containers_);
+        for (const auto &c : containers_) {
+            ret.data  += c.lows.size() * sizeof(uint16_t) + c.words.size() * sizeof(uint64_t);
+            ret.slack += VMemoryUsage_t::slackOf(c.lows) + VMemoryUsage_t::slackOf(c.words); }
+        ret.object  = sizeof(*this);
+        return ret; }
+    /// @brief Releases unused capacity left by `build` and the set operations.
+    /// @return Bytes released.
+    size_t shrinkToFit() {
+        const size_t before = memoryUsage().total();
+        highs_.shrink_to_fit(); containers_.shrink_to_fit();
+        for (auto &c : containers_) { c.lows.shrink_to_fit(); c.words.shrink_to_fit(); }
+        return before - memoryUsage().total(); }
+
+    private:
+    /// @brief One chunk of 65536 values.
+    struct Container_t {
+        VContainer_t type = VContainer_t::ARRAY;
+        uint32_t size = 0;
+        std::vector<uint16_t> lows{};  // ARRAY: sorted values, RUNS: (start, length - 1) pairs
+        std::vector<uint64_t> words{}; // BITMAP
+    };
+    enum SetOp_t : uint8_t { OR, AND, AND_NOT };
+
+    std::vector<uint64_t> highs_{};        // Chunk keys, ascending
+    std::vector<Container_t> containers_{};
+    size_t size_ = 0;
+
+    /// @brief Maps a value to an unsigned key with the same order.
+    static uint64_t _ordinal(const Data_t &value) {
+        if constexpr (std::is_signed<Data_t>::value) { return uint64_t(int64_t(value)) ^ (uint64_t(1) << 63); }
+        else { return uint64_t(value); }}
+    static Data_t _value(const uint64_t &key) {
+        if constexpr (std::is_signed<Data_t>::value) { return Data_t(int64_t(key ^ (uint64_t(1) << 63))); }
+        else { return Data_t(key); }}
+
+    /// @brief Gets the container of a chunk key, or `highs_.size()`.
+    size_t _findHigh(const uint64_t &high) const {
+        const auto it = std::lower_bound(highs_.begin(), highs_.end(), high);
+        return (it != highs_.end() && *it == high) ? size_t(it - highs_.begin()) : highs_.size(); }
+
+    static bool _contains(const Container_t &c, const uint16_t &low) {
+        switch (c.type) {
+        case VContainer_t::BITMAP: return (c.words[low >> 6] >> (low & 63)) & 1;
+        case VContainer_t::ARRAY: {
+            const uint16_t *base = c.lows.data();
+            size_t n = c.lows.size();
+            while (n > 1) { const size_t half = n / 2; base = (base[half] <= low) ? base + half : base; n -= half; }
+            return base[0] == low; }
+        default: {
+            // Last run starting at or before `low`
+            const uint16_t *base = c.lows.data();
+            size_t n = c.lows.size() / 2;
+            while (n > 1) { const size_t half = n / 2; base = (base[2 * half] <= low) ? base + 2 * half : base; n -= half; }
+            return base[0] <= low && uint32_t(low - base[0]) <= base[1]; }}}
+
+    /// @brief Calls `fn(low)` for every value of a container in ascending order.
+    template <class Fn> static void _forEach(const Container_t &c, Fn &&fn) {
+        switch (c.type) {
+        case VContainer_t::ARRAY: for (const auto &low : c.lows) { fn(low); } break;
+        case VContainer_t::BITMAP:
+            for (size_t w = 0; w < BITMAP_WORDS; ++w) {
+                for (uint64_t bits = c.words[w]; bits; bits &= bits - 1) { fn(uint16_t(w * 64 + __builtin_ctzll(bits))); }}
+            break;
+        default:
+            for (size_t r = 0; r < c.lows.size(); r += 2) {
+                for (uint32_t v = c.lows[r]; v <= uint32_t(c.lows[r]) + c.lows[r + 1]; ++v) { fn(uint16_t(v)); }}}}
+
+    /// @brief Makes the smallest container for sorted, distinct low values.
+    static Container_t _fromSorted(const std::vector<uint16_t> &lows) {
+        Container_t c;
+        c.size = uint32_t(lows.size());
+        size_t runs = 0;
+        for (size_t i = 0; i < lows.size(); ++i) { runs += (i == 0 || lows[i] != lows[i - 1] + 1); }
+        const size_t arrayBytes = (lows.size() <= ARRAY_MAX) ? lows.size() * 2 : SIZE_MAX, runBytes = runs * 4;
+        if (runBytes < arrayBytes && runBytes < BITMAP_WORDS * 8) {
+            c.type = VContainer_t::RUNS;
+            c.lows.reserve(runs * 2);
+            for (size_t i = 0; i < lows.size();) {
+                size_t j = i + 1;
+                while (j < lows.size() && lows[j] == lows[j - 1] + 1) { ++j; }
+                c.lows.push_back(lows[i]); c.lows.push_back(uint16_t(j - i - 1));
+                i = j; }}
+        else if (arrayBytes <= BITMAP_WORDS * 8) { c.type = VContainer_t::ARRAY; c.lows = lows; }
+        else {
+            c.type = VContainer_t::BITMAP;
+            c.words.assign(BITMAP_WORDS, 0);
+            for (const auto &low : lows) { c.words[low >> 6] |= uint64_t(1) << (low & 63); }}
+        return c; }
+
+    /// @brief Makes the smallest container for a bitmap. Keeps the bitmap when it is smallest.
+    static Container_t _fromBitmap(std::vector<uint64_t> &&words) {
+        size_t size = 0, runs = 0;
+        uint64_t carry = 0; // Top bit of the previous word
+        for (const auto &w : words) {
+            size += size_t(__builtin_popcountll(w));
+            runs += size_t(__builtin_popcountll(w & ~((w << 1) | carry)));
+            carry = w >> 63; }
+        if (size > ARRAY_MAX && runs * 4 >= BITMAP_WORDS * 8) {
+            Container_t c;
+            c.type = VContainer_t::BITMAP; c.size = uint32_t(size); c.words = std::move(words);
+            return c; }
+        Container_t bitmap;
+        bitmap.type = VContainer_t::BITMAP; bitmap.words = std::move(words);
+        std::vector<uint16_t> lows;
+        lows.reserve(size);
+        _forEach(bitmap, [&](const uint16_t &low) { lows.push_back(low); });
+        return _fromSorted(lows); }
+
+    static void _toBitmap(const Container_t &c, uint64_t *words) {
+        if (c.type == VContainer_t::BITMAP) { std::copy(c.words.begin(), c.words.end(), words); return; }
+        std::fill(words, words + BITMAP_WORDS, 0);
+        if (c.type == VContainer_t::ARRAY) { for (const auto &low : c.lows) { words[low >> 6] |= uint64_t(1) << (low & 63); } return; }
+        for (size_t r = 0; r < c.lows.size(); r += 2) {
+            const uint32_t first = c.lows[r], last = first + c.lows[r + 1];
+            for (uint32_t w = first >> 6; w <= last >> 6; ++w) {
+                const uint32_t lo = std::max(first, w * 64) - w * 64, hi = std::min(last, w * 64 + 63) - w * 64;
+                words[w] |= (~uint64_t(0) >> (63 - hi + lo)) << lo; }}}
+
+    /// @brief Combines two containers of the same chunk.
+    static Container_t _combine(const Container_t &a, const Container_t &b, const SetOp_t &op) {
+        std::vector<uint16_t> lows;
+        if (a.type == VContainer_t::ARRAY && b.type == VContainer_t::ARRAY) {
+            switch (op) {
+            case OR:  std::set_union       (a.lows.begin(), a.lows.end(), b.lows.begin(), b.lows.end(), std::back_inserter(lows)); break;
+            case AND: std::set_intersection(a.lows.begin(), a.lows.end(), b.lows.begin(), b.lows.end(), std::back_inserter(lows)); break;
+            default:  std::set_difference  (a.lows.begin(), a.lows.end(), b.lows.begin(), b.lows.end(), std::back_inserter(lows)); }
+            return _fromSorted(lows); }
+        if (op != OR && a.type == VContainer_t::ARRAY) {
+            for (const auto &low : a.lows) { if (_contains(b, low) == (op == AND)) lows.push_back(low); }
+            return _fromSorted(lows); }
+        if (op == AND && b.type == VContainer_t::ARRAY) {
+            for (const auto &low : b.lows) { if (_contains(a, low)) lows.push_back(low); }
+            return _fromSorted(lows); }
+        std::vector<uint64_t> words(BITMAP_WORDS);
+        uint64_t other[BITMAP_WORDS];
+        _toBitmap(a, words.data()); _toBitmap(b, other);
+        switch (op) {
+        case OR:  for (size_t w = 0; w < BITMAP_WORDS; ++w) { words[w] |=  other[w]; } break;
+        case AND: for (size_t w = 0; w < BITMAP_WORDS; ++w) { words[w] &=  other[w]; } break;
+        default:  for (size_t w = 0; w < BITMAP_WORDS; ++w) { words[w] &= ~other[w]; }}
+        return _fromBitmap(std::move(words)); }
+
+    /// @brief Combines two sets a chunk at a time.
+    static VRoaringSet_t _combine(const VRoaringSet_t &a, const VRoaringSet_t &b, const SetOp_t &op) {
+        VRoaringSet_t ret;
+        auto keep = [&](const uint64_t &high, Container_t &&c) {
+            if (c.size == 0) return;
+            ret.size_ += c.size; ret.highs_.push_back(high); ret.containers_.push_back(std::move(c)); };
+        size_t i = 0, j = 0;
+        while (i < a.highs_.size() || j < b.highs_.size()) {
+            if (j == b.highs_.size() || (i < a.highs_.size() && a.highs_[i] < b.highs_[j])) {
+                if (op != AND) { keep(a.highs_[i], Container_t(a.containers_[i])); }
+                ++i; }
+            else if (i == a.highs_.size() || b.highs_[j] < a.highs_[i]) {
+                if (op == OR) { keep(b.highs_[j], Container_t(b.containers_[j])); }
+                ++j; }
+            else { keep(a.highs_[i], _combine(a.containers_[i], b.containers_[j], op)); ++i; ++j; }}
+        return ret; }
+};
+
+/// @brief A frozen, read only copy of an integral `VKeyedList_t` whose entries are all `WHITELIST` or `BLACKLIST`,
+/// stored as two Roaring sets.
+/// @tparam Data_t Integral data type, up to 64 bits.
+/// @note Query results match `VKeyedList_t::query` on the source list, including the first key added winning.
+template <class Data_t> class VRoaringKeyedList_t {
+    public:
+    using Set_t = VRoaringSet_t<Data_t>;
+
+    /// @brief Constructor from a keyed list. See `build`.
+    VRoaringKeyedList_t(const VKeyedList_t<Data_t> &kl) { build(kl); }
+    /// @brief Constructor from a set of values with one key, `WHITELIST` or `BLACKLIST`.
+    VRoaringKeyedList_t(const VKey_t &key, const std::vector<Data_t> &values) {
+        if (key == VKey_t::BLACKLIST) { black_.build(values.data(), values.size()); miss_ = VReturn_t::PASS; }
+        else if (key == VKey_t::WHITELIST) { white_.build(values.data(), values.size()); miss_ = VReturn_t::FAIL; }
+        else { V_DEBUG_MSG("VRoaringKeyedList_t ERROR: Keys must be WHITELIST or BLACKLIST!"); return; }
+        version_ = nextVersion(); }
+    /// @brief Default constructor. Every query returns `FAIL` until `build` is called.
+    VRoaringKeyedList_t() {}
+
+    /// @brief Builds the sets from a keyed list, replacing any previous contents.
+    /// @return `false` if a listed entry has a key other than `WHITELIST` or `BLACKLIST`. The list is left empty.
+    bool build(const VKeyedList_t<Data_t> &kl) {
+        const auto &list = kl.getList();
+        _clear();
+        std::vector<Data_t> black, white;
+        for (const auto &kd : list) {
+            if (!kd.matchable()) continue;
+            if (-kd == VKey_t::BLACKLIST) { black.push_back(kd.getCData()); }
+            else if (-kd == VKey_t::WHITELIST) { white.push_back(kd.getCData()); }
+            else { V_DEBUG_MSG("VRoaringKeyedList_t ERROR: Keys must be WHITELIST or BLACKLIST!"); return false; }}
+        black_.build(black.data(), black.size());
+        white_.build(white.data(), white.size());
+        // Values listed with both keys keep the key added first
+        const Set_t both = black_ & white_;
+        if (!both.empty()) {
+            std::unordered_map<Data_t, bool> firstBlack;
+            for (const auto &kd : list) {
+                if (kd.matchable() && both.contains(kd.getCData())) { firstBlack.emplace(kd.getCData(), -kd == VKey_t::BLACKLIST); }}
+            std::vector<Data_t> toBlack, toWhite;
+            for (const auto &f : firstBlack) { (f.second ? toBlack : toWhite).push_back(f.first); }
+            black_ -= Set_t(toWhite);
+            white_ -= Set_t(toBlack); }
+        miss_ = kl.fallback(); curve_ = kl.curve(); version_ = kl.version();
+        return true; }
+
+    /// @brief Queries data to get a score or key. Same results as `VKeyedList_t::query` on the source list.
+    VReturn_t query(const Data_t &qData) const {
+        if (black_.contains(qData)) return VKey_t(VKey_t::BLACKLIST);
+        if (white_.contains(qData)) return VKey_t(VKey_t::WHITELIST);
+        return _miss(qData); }
+    /// @brief Operator overload to query data.
+    VReturn_t operator()(const Data_t &qData) const { return query(qData); }
+
+    /// @brief Queries many values. Same results as `query` on every value.
+    /// @param out Results as `VReturn_t[count]`.
+    void query(const Data_t *values, const size_t &count, VReturn_t *out) const {
+        constexpr size_t BLOCK = 256;
+        bool black[BLOCK], white[BLOCK];
+        const VReturn_t blackResult = VKey_t(VKey_t::BLACKLIST), whiteResult = VKey_t(VKey_t::WHITELIST);
+        for (size_t first = 0; first < count; first += BLOCK) {
+            const size_t n = std::min(BLOCK, count - first);
+            black_.contains(values + first, n, black);
+            white_.contains(values + first, n, white);
+            for (size_t i = 0; i < n; ++i) {
+                out[first + i] = black[i] ? blackResult : (white[i] ? whiteResult : _miss(values[first + i])); }}}
+
+    /// @brief Gets the blacklisted values.
+    const Set_t& blacklist() const { return black_; }
+    /// @brief Gets the whitelisted values.
+    const Set_t& whitelist() const { return white_; }
+    /// @brief Gets the result for data that is not listed, without the curve.
+    VReturn_t fallback() const { return miss_; }
+    /// @brief Gets the miss curve.
+    const VScoreCurve_t<Data_t>& curve() const { return curve_; }
+    /// @brief Gets the number of listed values.
+    size_t size() const { return black_.size() + white_.size(); }
+    /// @brief Gets the version of the list the sets were built from.
+    uint64_t version() const { return version_; }
+    /// @brief Memory used by both sets in bytes. See `memoryUsage`.
+    size_t memoryBytes() const { return memoryUsage().total(); }
+    /// @brief Gets the bytes used by both sets, by component. Keys are implied by the set a value is in.
+    VMemoryUsage_t memoryUsage() const {
+        VMemoryUsage_t ret = black_.memoryUsage();
+        ret += white_.memoryUsage();
+        ret.curve  = curve_.memoryBytes();
+        ret.object = sizeof(*this);
+        return ret; }
+    /// @brief Releases unused capacity in both sets. See `VRoaringSet_t::shrinkToFit`.
+    size_t shrinkToFit() { return black_.shrinkToFit() + white_.shrinkToFit(); }
+
+    /// @brief Combines two lists the way `VKeyedList_t::merge` does, with set algebra on the containers.
+    /// @param precedence Key kept for values in both lists as `VPrecedence_t`. Ignored by `DIFFERENCE`.
+    static VRoaringKeyedList_t combine(const VRoaringKeyedList_t &lhs, const VRoaringKeyedList_t &rhs, const VSetOp_t &op,
+                                       const VPrecedence_t &precedence = VPrecedence_t::LEFT) {
+        VRoaringKeyedList_t ret;
+        const Set_t lhsAll = lhs.black_ | lhs.white_, rhsAll = rhs.black_ | rhs.white_;
+        if (op == VSetOp_t::UNION) {
+            switch (precedence) {
+            case VPrecedence_t::LEFT:  ret.black_ = lhs.black_ | (rhs.black_ - lhs.white_); ret.white_ = lhs.white_ | (rhs.white_ - lhs.black_); break;
+            case VPrecedence_t::RIGHT: ret.black_ = rhs.black_ | (lhs.black_ - rhs.white_); ret.white_ = rhs.white_ | (lhs.white_ - rhs.black_); break;
+            case VPrecedence_t::STRICTEST: ret.black_ = lhs.black_ | rhs.black_; ret.white_ = (lhs.white_ | rhs.white_) - ret.black_; break;
+            default:                       ret.white_ = lhs.white_ | rhs.white_; ret.black_ = (lhs.black_ | rhs.black_) - ret.white_; }}
+        else if (op == VSetOp_t::INTERSECTION) {
+            const Set_t both = lhsAll & rhsAll;
+            switch (precedence) {
+            case VPrecedence_t::LEFT:  ret.black_ = lhs.black_ & both; ret.white_ = lhs.white_ & both; break;
+            case VPrecedence_t::RIGHT: ret.black_ = rhs.black_ & both; ret.white_ = rhs.white_ & both; break;
+            case VPrecedence_t::STRICTEST: ret.black_ = both & (lhs.black_ | rhs.black_); ret.white_ = both - ret.black_; break;
+            default:                       ret.white_ = both & (lhs.white_ | rhs.white_); ret.black_ = both - ret.white_; }}
+        else { ret.black_ = lhs.black_ - rhsAll; ret.white_ = lhs.white_ - rhsAll; }
+        // Same list mode rules as `VKeyedList_t::merge`: blacklist mode needs both inputs in it for a union, and no
+        // whitelisted values left
+        const bool blacklist = lhs.miss_() == VReturn_t::PASS && (op != VSetOp_t::UNION || rhs.miss_() == VReturn_t::PASS);
+        ret.miss_  = (blacklist && ret.white_.empty()) ? VReturn_t::PASS : VReturn_t::FAIL;
+        ret.curve_ = (lhs.curve_ || op != VSetOp_t::UNION) ? lhs.curve_ : rhs.curve_;
+        ret.version_ = nextVersion();
+        return ret; }
+
+    private:
+    Set_t black_{};
+    Set_t white_{};
+    VReturn_t miss_ = VReturn_t::FAIL;
+    VScoreCurve_t<Data_t> curve_{}; // Scores misses if the list has a curve
+    uint64_t version_ = 0;
+
+    void _clear() { black_ = Set_t(); white_ = Set_t(); miss_ = VReturn_t::FAIL; curve_ = {}; version_ = 0; }
+    VReturn_t _miss(const Data_t &qData) const { return curve_ ? curve_(qData) : miss_; }
+};
+
+/// @brief Union of two Roaring keyed lists. See `VKeyedList_t::merge`.
+template <class Data_t> VRoaringKeyedList_t<Data_t> unionOf(const VRoaringKeyedList_t<Data_t> &lhs, const VRoaringKeyedList_t<Data_t> &rhs,
+                                                            const VPrecedence_t &precedence = VPrecedence_t::LEFT) {
+    return VRoaringKeyedList_t<Data_t>::combine(lhs, rhs, VSetOp_t::UNION, precedence); }
+
+/// @brief Intersection of two Roaring keyed lists. See `VKeyedList_t::merge`.
+template <class Data_t> VRoaringKeyedList_t<Data_t> intersectionOf(const VRoaringKeyedList_t<Data_t> &lhs, const VRoaringKeyedList_t<Data_t> &rhs,
+                                                                   const VPrecedence_t &precedence = VPrecedence_t::LEFT) {
+    return VRoaringKeyedList_t<Data_t>::combine(lhs, rhs, VSetOp_t::INTERSECTION, precedence); }
+
+/// @brief Values of a Roaring keyed list that are not in another. See `VKeyedList_t::merge`.
+template <class Data_t> VRoaringKeyedList_t<Data_t> differenceOf(const VRoaringKeyedList_t<Data_t> &lhs, const VRoaringKeyedList_t<Data_t> &rhs) {
+    return VRoaringKeyedList_t<Data_t>::combine(lhs, rhs, VSetOp_t::DIFFERENCE); }
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+} // END: namespace Validspace                                                                                             ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,169 @@
+#pragma once
+/**
+ * @file src/score_curve_t.hpp
+ * @author Ray Richter
+ * @brief VScoreCurve_t Class declaration.
+ * @note Scores a value with a step or piecewise linear curve over sorted breakpoints. Breakpoints are padded to a power
+ * of two so the segment search is a fixed number of conditional moves with no data dependent branches. Values outside
+ * the first and last breakpoints are FAIL. Used by `VKeyedList_t` to score values that are not in the list.
+ */
+#include "Validator_core.hpp"
+#include "return_t.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// @brief Internal Validator namespace.                                                                                  ////
+namespace Validspace {                                                                                                     ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Curve interpolation modes.
+enum class VCurve_t : uint8_t {
+    STEP,   // Score of the breakpoint at or below the value
+    LINEAR, // Linear interpolation between the breakpoints around the value
+};
+
+/// @brief A scoring curve over a comparable type.
+/// @tparam Data_t Comparable data type. `LINEAR` mode needs an arithmetic type, other types always score like `STEP`.
+/// @note Default = empty curve, every query returns `FAIL`. Breakpoint scores may be any `VReturn_t`. In `LINEAR` mode, a
+/// segment with a special (`FAIL` or `PERFECT`) end scores like `STEP`.
+template <class Data_t> class VScoreCurve_t {
+    public:
+    /// @brief Constructor from breakpoints.
+    /// @param points Breakpoints as `{value, score}` pairs, in any order.
+    VScoreCurve_t(const std::vector<std::pair<Data_t, VReturn_t>> &points, const VCurve_t &mode = VCurve_t::LINEAR) {
+        build(points, mode); }
+    /// @brief Default constructor.
+    VScoreCurve_t() {}
+
+    /// @brief Builds the curve, replacing any previous breakpoints. Duplicate values keep the last score.
+    void build(std::vector<std::pair<Data_t, VReturn_t>> points, const VCurve_t &mode = VCurve_t::LINEAR) {
+        mode_ = mode; xs_.clear(); ys_.clear(); slopes_.clear(); size_ = 0;
+        // Curves need ordered data. Others stay empty
+        if constexpr ((type_flags<Data_t> & COMPARISON_OP) == 0) { return; } else {
+        std::stable_sort(points.begin(), points.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+        for (const auto &p : points) {
+            if (!(p.first == p.first)) continue; // Skip NaN
+            if (!xs_.empty() && xs_.back() == p.first) { ys_.back() = p.second(); continue; }
+            xs_.push_back(p.first); ys_.push_back(p.second()); }
+        size_ = xs_.size();
+        if (size_ == 0) return;
+        size_t padded = 1;
+        while (padded < size_) { padded *= 2; }
+        xs_.resize(padded, xs_.back());
+        ys_.resize(padded, ys_.back());
+        // Precompute segment slopes. Special end scores and STEP mode get a slope of 0
+        slopes_.assign(padded, 0.0);
+        if constexpr (std::is_arithmetic<Data_t>::value) {
+            for (size_t i = 0; i + 1 < size_ && mode_ == VCurve_t::LINEAR; ++i) {
+                if (ys_[i] >= VReturn_t::PERFECT || ys_[i + 1] >= VReturn_t::PERFECT) continue;
+                slopes_[i] = (double(ys_[i + 1]) - double(ys_[i])) / (double(xs_[i + 1]) - double(xs_[i])); }}}}
+
+    /// @brief Scores a value.
+    /// @return `FAIL` if the curve is empty or the value is outside it.
+    VReturn_t query(const Data_t &value) const {
+        if (!_inside(value)) return VReturn_t::FAIL;
+        return _score(_segment(value), value); }
+
+    /// @brief Operator overload to score a value.
+    VReturn_t operator()(const Data_t &value) const { return query(value); }
+
+    /// @brief Scores many values. The segment search runs over a block of values at a time, with AVX2 gathers for
+    /// `float` and `double` when available.
+    /// @param out Scores as `VReturn_t[count]`.
+    void query(const Data_t *values, const size_t &count, VReturn_t *out) const {
+        constexpr size_t BLOCK = 16;
+        size_t seg[BLOCK];
+        for (size_t first = 0; first < count; first += BLOCK) {
+            const size_t n = std::min(BLOCK, count - first);
+            const Data_t *v = values + first;
+            _segments(v, n, seg);
+            for (size_t i = 0; i < n; ++i) {
+                out[first + i] = _inside(v[i]) ? _score(seg[i], v[i]) : VReturn_t(VReturn_t::FAIL); }}}
+
+    /// @brief Checks if the curve has breakpoints.
+    explicit operator bool() const { return size_ != 0; }
+    /// @brief Gets the number of breakpoints.
+    size_t size() const { return size_; }
+    /// @brief Gets the interpolation mode.
+    VCurve_t mode() const { return mode_; }
+    /// @brief Memory used by the breakpoints in bytes.
+    size_t memoryBytes() const {
+        return xs_.capacity() * sizeof(Data_t) + ys_.capacity() * sizeof(uint_t) + slopes_.capacity() * sizeof(double); }
+
+    private:
+    std::vector<Data_t> xs_{}; // Sorted breakpoints, padded to a power of two with the last one
+    std::vector<uint_t> ys_{}; // Breakpoint scores
+    std::vector<double> slopes_{}; // Score change per unit from every breakpoint to the next
+    size_t   size_ = 0;
+    VCurve_t mode_ = VCurve_t::LINEAR;
+
+    /// @brief Checks if a value is between the first and last breakpoints. NaN is never inside.
+    bool _inside(const Data_t &value) const {
+        if constexpr ((type_flags<Data_t> & COMPARISON_OP) == 0) { return false; }
+        else { return size_ != 0 && xs_[0] <= value && !(xs_[size_ - 1] < value); }}
+
+    /// @brief Branchless search for the last breakpoint <= value. Value must be inside the curve. The padding repeats the
+    /// last breakpoint with a slope of 0, so landing in it scores like the last breakpoint.
+    size_t _segment(const Data_t &value) const {
+        size_t seg = 0;
+        if constexpr ((type_flags<Data_t> & COMPARISON_OP) != 0) {
+            for (size_t step = xs_.size() / 2; step > 0; step /= 2) { seg += size_t(xs_[seg + step] <= value) * step; }}
+        return seg; }
+
+    /// @brief `_segment` for up to 16 values, searched side by side. Every search takes the same steps.
+    void _segments(const Data_t *v, const size_t &count, size_t *seg) const {
+        for (size_t i = 0; i < count; ++i) { seg[i] = 0; }
+        if constexpr ((type_flags<Data_t> & COMPARISON_OP) != 0) {
+        const Data_t *xs = xs_.data();
+        const size_t size = xs_.size();
+        size_t i = 0;
+#if defined(__AVX2__)
+        if constexpr (std::is_same<Data_t, float>::value) {
+            if (size <= size_t(INT32_MAX)) {
+                for (; i + 8 <= count; i += 8) {
+                    const __m256 x = _mm256_loadu_ps(v + i);
+                    __m256i base = _mm256_setzero_si256();
+                    for (size_t step = size / 2; step > 0; step /= 2) {
+                        const __m256i probe = _mm256_add_epi32(base, _mm256_set1_epi32(int32_t(step)));
+                        const __m256 le = _mm256_cmp_ps(_mm256_i32gather_ps(xs, probe, 4), x, _CMP_LE_OQ);
+                        base = _mm256_blendv_epi8(base, probe, _mm256_castps_si256(le)); }
+                    alignas(32) int32_t out[8];
+                    _mm256_store_si256(reinterpret_cast<__m256i*>(out), base);
+                    for (size_t j = 0; j < 8; ++j) { seg[i + j] = size_t(out[j]); }}}}
+        if constexpr (std::is_same<Data_t, double>::value) {
+            for (; i + 4 <= count; i += 4) {
+                const __m256d x = _mm256_loadu_pd(v + i);
+                __m256i base = _mm256_setzero_si256();
+                for (size_t step = size / 2; step > 0; step /= 2) {
+                    const __m256i probe = _mm256_add_epi64(base, _mm256_set1_epi64x(int64_t(step)));
+                    const __m256d le = _mm256_cmp_pd(_mm256_i64gather_pd(xs, probe, 8), x, _CMP_LE_OQ);
+                    base = _mm256_blendv_epi8(base, probe, _mm256_castpd_si256(le)); }
+                alignas(32) int64_t out[4];
+                _mm256_store_si256(reinterpret_cast<__m256i*>(out), base);
+                for (size_t j = 0; j < 4; ++j) { seg[i + j] = size_t(out[j]); }}}
+#endif
+        // Portable path: the searches are independent, so their loads overlap
+        for (size_t step = size / 2; step > 0; step /= 2) {
+            for (size_t j = i; j < count; ++j) { seg[j] += size_t(xs[seg[j] + step] <= v[j]) * step; }}}}
+
+    /// @brief Scores a value in segment `seg`.
+    VReturn_t _score(const size_t &seg, const Data_t &value) const {
+        const uint_t y0 = ys_[seg];
+        if constexpr (std::is_arithmetic<Data_t>::value) {
+            if (slopes_[seg] == 0.0) return y0;
+            const double y = double(y0) + slopes_[seg] * (double(value) - double(xs_[seg])) + 0.5;
+            // Clamp in integer space. With a 64 bit `uint_t`, `PERFECT - 1` rounds up to 2^64 as a double
+            if (!(y > 0.0)) return uint_t(0);
+            if (y >= std::ldexp(1.0, std::numeric_limits<uint_t>::digits)) return VReturn_t::PERFECT - 1;
+            return std::min<uint_t>(uint_t(y), VReturn_t::PERFECT - 1); }
+        return y0; }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+} // END: namespace Validspace                                                                                             ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
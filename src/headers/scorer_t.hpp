@@ -0,0 +1,123 @@
+#pragma once
+/**
+ * @file src/scorer_t.hpp
+ * @author Ray Richter
+ * @brief VScore_t and VScorer_t Class declarations.
+ * @note `VReturn_t` sums in `uint_t`, which may be as small as 8 bits. `VScorer_t` combines per trait `VReturn_t`s with
+ * fixed point weights into a 64 bit saturating accumulator, so stored keys can stay small while totals stay correct.
+ * Combination rules match `VReturn_t::operator+`: any FAIL = FAIL, else any PERFECT = PERFECT, else weighted sum.
+ */
+#include "Validator_core.hpp"
+#include "return_t.hpp"
+#include <algorithm>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// @brief Internal Validator namespace.                                                                                  ////
+namespace Validspace {                                                                                                     ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief A wide, weighted score total.
+/// @note Default = `PASS` (no points).
+struct VScore_t {
+    uint64_t total   = 0;     // Weighted sum of non-special scores in `VScorer_t::WEIGHT_ONE` units
+    bool     fail    = false; // A trait returned FAIL
+    bool     perfect = false; // A trait returned PERFECT
+
+    /// @brief Gets the total in score points, rounded down.
+    uint64_t points() const;
+    /// @brief Converts to `VReturn_t`. Totals too large for `uint_t` saturate below `PERFECT`.
+    VReturn_t toReturn() const {
+        if (fail)    return VReturn_t::FAIL;
+        if (perfect) return VReturn_t::PERFECT;
+        uint64_t p = points(), max = uint64_t(VReturn_t::PERFECT) - 1;
+        return VReturn_t(uint_t(p < max ? p : max)); }
+    /// @brief Ranking order: FAIL < any total < PERFECT.
+    bool operator< (const VScore_t &rhs) const { return _rank() < rhs._rank() || (_rank() == rhs._rank() && total < rhs.total); }
+    /// @brief Ranking order: FAIL < any total < PERFECT.
+    bool operator> (const VScore_t &rhs) const { return rhs < *this; }
+    /// @brief Equal rank and total.
+    bool operator==(const VScore_t &rhs) const { return _rank() == rhs._rank() && (_rank() != 1 || total == rhs.total); }
+
+    private:
+    int _rank() const { return fail ? 0 : (perfect ? 2 : 1); }
+};
+
+/// @brief Combines per trait `VReturn_t`s into a weighted `VScore_t`.
+/// @note Weights are 8.8 fixed point: `WEIGHT_ONE` = 1.0. Default weight = 1.0 for every trait.
+class VScorer_t {
+    public:
+    /// @brief Fixed point weight of 1.0.
+    static constexpr uint16_t WEIGHT_ONE = 256;
+    /// @brief Largest trait score used before weighting. Keeps `score * weight` inside 64 bits.
+    static constexpr uint64_t SCORE_CAP  = (uint64_t(1) << 48) - 1;
+
+    /// @brief Constructor from fixed point weights, one per trait.
+    VScorer_t(const std::vector<uint16_t> &weights) : weights_(weights) {}
+    /// @brief Constructor from real weights, one per trait. Weights are clamped to `[0, 255.99]`.
+    VScorer_t(const std::vector<double> &weights) {
+        for (const auto &w : weights) { weights_.push_back(_toFixed(w)); }}
+    /// @brief Constructor from a trait count. Every trait has weight 1.0.
+    VScorer_t(const size_t &numTraits) : weights_(numTraits, WEIGHT_ONE) {}
+    /// @brief Default constructor.
+    VScorer_t() {}
+
+    /// @brief Sets the weight of one trait, adding traits with weight 1.0 as needed.
+    void setWeight(const size_t &trait, const double &weight) {
+        if (trait >= weights_.size()) { weights_.resize(trait + 1, WEIGHT_ONE); }
+        weights_[trait] = _toFixed(weight); }
+
+    /// @brief Scores one candidate's trait results in a single branchless pass.
+    /// @param results Trait results as `VReturn_t[numTraits()]`. Missing weights count as 1.0.
+    /// @param count Number of results.
+    VScore_t score(const VReturn_t *results, const size_t &count) const {
+        VScore_t ret;
+        const size_t n = std::min(count, weights_.size());
+        for (size_t i = 0; i < n;     ++i) { _accumulate(ret, results[i], weights_[i]); }
+        for (size_t i = n; i < count; ++i) { _accumulate(ret, results[i], WEIGHT_ONE ); }
+        return ret; }
+
+    /// @brief Scores one candidate's trait results.
+    VScore_t score(const std::vector<VReturn_t> &results) const { return score(results.data(), results.size()); }
+
+    /// @brief Scores many candidates stored row major: `results[candidate * numTraits + trait]`.
+    /// @param out Output as `VScore_t[numCandidates]`.
+    void score(const VReturn_t *results, const size_t &numCandidates, const size_t &numTraits, VScore_t *out) const {
+        for (size_t c = 0; c < numCandidates; ++c) { out[c] = score(results + c * numTraits, numTraits); }}
+
+    /// @brief Normalizes a score to `[0, 1]`. FAIL = 0, PERFECT = 1.
+    /// @param maxTraitScore Highest score a single trait can return.
+    double normalize(const VScore_t &s, const uint64_t &maxTraitScore) const {
+        if (s.fail)    return 0.0;
+        if (s.perfect) return 1.0;
+        double max = 0.0;
+        for (const auto &w : weights_) { max += double(w) * double(maxTraitScore); }
+        return (max > 0.0) ? std::min(double(s.total) / max, 1.0) : 0.0; }
+
+    /// @brief Gets the number of weighted traits.
+    size_t numTraits() const { return weights_.size(); }
+    /// @brief Gets the fixed point weights.
+    const std::vector<uint16_t>& weights() const { return weights_; }
+
+    private:
+    std::vector<uint16_t> weights_{};
+
+    /// @brief Adds one weighted trait result. Branchless so the scoring loop vectorizes.
+    static void _accumulate(VScore_t &ret, const VReturn_t &result, const uint16_t &weight) {
+        uint64_t s = result();
+        ret.fail    |= (s == VReturn_t::FAIL);
+        ret.perfect |= (s == VReturn_t::PERFECT);
+        // Special values add no points, the rest are capped so the product cannot overflow
+        uint64_t points = (s >= uint64_t(VReturn_t::PERFECT)) ? 0 : (s < SCORE_CAP ? s : SCORE_CAP);
+        uint64_t sum = ret.total + points * weight;
+        ret.total = (sum < ret.total) ? UINT64_MAX : sum; }
+
+    static uint16_t _toFixed(const double &w) {
+        double f = w * WEIGHT_ONE + 0.5;
+        return uint16_t(f <= 0.0 ? 0 : (f >= double(UINT16_MAX) ? UINT16_MAX : f)); }
+};
+
+inline uint64_t VScore_t::points() const { return total / VScorer_t::WEIGHT_ONE; }
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+} // END: namespace Validspace                                                                                             ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
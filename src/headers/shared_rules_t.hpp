@@ -0,0 +1,294 @@
+#pragma once
+/**
+ * @file src/shared_rules_t.hpp
+ * @author Ray Richter
+ * @brief VSharedRules_t Class declaration.
+ * @note A frozen keyed list stored in one shared memory segment, so many processes on a host map the same pages
+ * instead of each building a private copy. The segment holds a header, an open addressing hash table of entry indices,
+ * and the entries. Every reference is an offset from the segment start, so it works at any mapping address.
+ *
+ * A named rule set is a small control segment `/<name>` with the current generation, plus one immutable segment per
+ * generation, `/<name>.<generation>`. `publish` writes the next generation in full, then bumps the control counter, then
+ * unlinks the old segment. Of two processes publishing at once, one fails and only removes a segment it created.
+ * Processes that still map the old segment keep using it until they `refresh`. An `attach` or `refresh` that opens a
+ * generation just as it is unlinked retries with the newer one. `publishFd` makes an anonymous, sealed memfd instead,
+ * for handing to child processes.
+ *
+ * POSIX only. Values are hashed with `std::hash`, so every attached process must use the same standard library build.
+ */
+#include "Validator_core.hpp"
+#include "keyed_list_t.hpp"
+#include "return_t.hpp"
+#include <cstring>
+#include <string>
+#if defined(__unix__) || defined(__APPLE__)
+#define V_SHARED_RULES 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// @brief Internal Validator namespace.                                                                                  ////
+namespace Validspace {                                                                                                     ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#if defined(V_SHARED_RULES)
+
+/// @brief A read only keyed list in shared memory.
+/// @tparam Data_t Trivially copyable, hashable data type.
+/// @note Query results match `VKeyedList_t::query` on the published list. Lists with a score curve cannot be shared.
+template <class Data_t> class VSharedRules_t {
+    static_assert(std::is_trivially_copyable<Data_t>::value, "VSharedRules_t ERROR: Data_t must be trivially copyable.");
+    static_assert((type_flags<Data_t> & HASHABLE_OP) != 0, "VSharedRules_t ERROR: Data_t must have a std::hash.");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "VSharedRules_t ERROR: Needs lock free 64 bit atomics.");
+    public:
+    /// @brief Constructor. Attaches to a named rule set, see `attach`.
+    VSharedRules_t(const std::string &name) { attach(name); }
+    /// @brief Default constructor. Every query returns `FAIL` until attached.
+    VSharedRules_t() {}
+    ~VSharedRules_t() { _unmap(); }
+    VSharedRules_t(const VSharedRules_t&) = delete;
+    VSharedRules_t& operator=(const VSharedRules_t&) = delete;
+
+    /// @brief Publishes a keyed list as the next generation of a named rule set.
+    /// @param name Rule set name, without a leading '/'.
+    /// @return Published generation, or 0 on failure.
+    static uint64_t publish(const std::string &name, const VKeyedList_t<Data_t> &kl) {
+        Control_t *control = _openControl(name, true);
+        if (!control) return 0;
+        const uint64_t old = control->generation.load(std::memory_order_acquire), generation = old + 1;
+        const std::string segment = _segmentName(name, generation);
+        int fd = shm_open(segment.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        // Another publisher is writing this generation. Its segment is not ours to remove
+        if (fd < 0) { V_DEBUG_MSG("VSharedRules_t ERROR: Could not create " << segment); munmap(control, sizeof(Control_t)); return 0; }
+        const bool ok = _write(fd, kl, generation);
+        close(fd);
+        if (!ok) { V_DEBUG_MSG("VSharedRules_t ERROR: Could not write " << segment); shm_unlink(segment.c_str()); munmap(control, sizeof(Control_t)); return 0; }
+        // Only fully written segments are ever named by the control counter
+        uint64_t expected = old;
+        if (!control->generation.compare_exchange_strong(expected, generation, std::memory_order_acq_rel)) {
+            V_DEBUG_MSG("VSharedRules_t ERROR: Another process published " << name << " at the same time");
+            shm_unlink(segment.c_str()); munmap(control, sizeof(Control_t)); return 0; }
+        if (old != 0) { shm_unlink(_segmentName(name, old).c_str()); }
+        munmap(control, sizeof(Control_t));
+        return generation; }
+
+    /// @brief Publishes a keyed list to an anonymous, sealed memfd. Linux only.
+    /// @return File descriptor to pass to `attachFd`, or -1 on failure.
+    static int publishFd(const VKeyedList_t<Data_t> &kl) {
+#if defined(__linux__) && defined(MFD_ALLOW_SEALING)
+        int fd = memfd_create("validator_rules", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (fd < 0) return -1;
+        if (!_write(fd, kl, 1) || fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) != 0) { close(fd); return -1; }
+        return fd;
+#else
+        (void)kl; return -1;
+#endif
+    }
+
+    /// @brief Removes a named rule set. Attached processes keep their mappings.
+    static void unlink(const std::string &name) {
+        if (Control_t *control = _openControl(name, false)) {
+            const uint64_t generation = control->generation.load(std::memory_order_acquire);
+            if (generation != 0) { shm_unlink(_segmentName(name, generation).c_str()); }
+            munmap(control, sizeof(Control_t)); }
+        shm_unlink(_controlName(name).c_str()); }
+
+    /// @brief Maps the current generation of a named rule set read only.
+    /// @return `false` if the rule set does not exist or is not a `VSharedRules_t<Data_t>` segment.
+    bool attach(const std::string &name) {
+        _unmap();
+        name_ = name;
+        control_ = _openControl(name, false);
+        return control_ && refresh(); }
+
+    /// @brief Maps a segment made by `publishFd`. The descriptor can be closed afterwards.
+    bool attachFd(const int &fd) {
+        _unmap();
+        size_t bytes = 0;
+        void *p = _map(fd, bytes);
+        if (p) { _use(p, bytes); }
+        return p != nullptr; }
+
+    /// @brief Maps the newest generation if it changed since the last call. One atomic load when nothing changed. If the
+    /// new segment cannot be mapped or is not valid, the current mapping is kept.
+    /// @return `false` if no valid segment is mapped.
+    bool refresh() {
+        if (!control_) return base_ != nullptr;
+        uint64_t generation = control_->generation.load(std::memory_order_acquire);
+        if (generation == generation_ && base_) return true;
+        int fd = shm_open(_segmentName(name_, generation).c_str(), O_RDONLY, 0);
+        // A publish may unlink the generation between the load and the open. Retry while the generation moves
+        while (fd < 0) {
+            const uint64_t newer = control_->generation.load(std::memory_order_acquire);
+            if (newer == generation) return base_ != nullptr;
+            generation = newer;
+            fd = shm_open(_segmentName(name_, generation).c_str(), O_RDONLY, 0); }
+        size_t bytes = 0;
+        void *p = _map(fd, bytes);
+        close(fd);
+        if (!p) return base_ != nullptr;
+        _use(p, bytes);
+        return true; }
+
+    /// @brief Checks if a newer generation was published since the last `refresh`.
+    bool stale() const { return control_ && control_->generation.load(std::memory_order_acquire) != generation_; }
+
+    /// @brief Queries data to get a score or key.
+    VReturn_t query(const Data_t &qData) const {
+        if (!base_) return VReturn_t::FAIL;
+        const uint64_t mask = header_->tableSize - 1;
+        for (uint64_t pos = hashData(qData) & mask;; pos = (pos + 1) & mask) {
+            const uint32_t slot = table_[pos];
+            if (slot == 0) return VReturn_t(uint_t(header_->missScore));
+            if (entries_[slot - 1].data == qData) return VReturn_t(entries_[slot - 1].score); }}
+
+    /// @brief Operator overload to query data.
+    VReturn_t operator()(const Data_t &qData) const { return query(qData); }
+
+    /// @brief Gets the mapped generation, 0 if not attached.
+    uint64_t generation() const { return generation_; }
+    /// @brief Gets the number of unique values.
+    size_t size() const { return base_ ? size_t(header_->numEntries) : 0; }
+    /// @brief Gets the size of the mapped segment in bytes. Shared by every attached process.
+    size_t mappedBytes() const { return mappedBytes_; }
+
+    private:
+    static constexpr uint64_t MAGIC  = 0x5356414c49445231ULL; // "SVALIDR1"
+    static constexpr uint32_t LAYOUT = 1;
+
+    /// @brief Control segment. Only the generation changes after creation.
+    struct Control_t {
+        std::atomic<uint64_t> generation; };
+    /// @brief Segment header. Offsets are from the segment start.
+    struct Header_t {
+        uint64_t magic;
+        uint32_t layout;
+        uint32_t dataSize;
+        uint32_t scoreSize;
+        uint32_t reserved;
+        uint64_t generation;
+        uint64_t numEntries;
+        uint64_t tableOffset;
+        uint64_t tableSize;   // Power of two, at most half full
+        uint64_t entriesOffset;
+        uint64_t missScore;
+        uint64_t totalBytes; };
+    /// @brief A unique value and its score.
+    struct Entry_t {
+        Data_t   data;
+        uint_t   score; };
+
+    std::string name_{};
+    Control_t *control_ = nullptr;
+    void *base_ = nullptr;
+    const Header_t *header_ = nullptr;
+    const uint32_t *table_ = nullptr;
+    const Entry_t *entries_ = nullptr;
+    size_t mappedBytes_ = 0;
+    uint64_t generation_ = 0;
+
+    static std::string _controlName(const std::string &name) { return "/" + name; }
+    static std::string _segmentName(const std::string &name, const uint64_t &generation) {
+        return "/" + name + "." + std::to_string(generation); }
+    static uint64_t _align(const uint64_t &offset) { return (offset + 63) & ~uint64_t(63); }
+
+    static Control_t* _openControl(const std::string &name, const bool &create) {
+        int fd = shm_open(_controlName(name).c_str(), create ? (O_CREAT | O_RDWR) : O_RDWR, 0644);
+        if (fd < 0 && !create) { fd = shm_open(_controlName(name).c_str(), O_RDONLY, 0); }
+        if (fd < 0) return nullptr;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t(st.st_size) < sizeof(Control_t) && (!create || ftruncate(fd, sizeof(Control_t)) != 0))) {
+            close(fd); return nullptr; }
+        // A new control segment is zero filled, which is generation 0
+        void *p = mmap(nullptr, sizeof(Control_t), (fcntl(fd, F_GETFL) & O_ACCMODE) == O_RDONLY ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        return (p == MAP_FAILED) ? nullptr : static_cast<Control_t*>(p); }
+
+    /// @brief Sizes and fills a segment.
+    static bool _write(const int &fd, const VKeyedList_t<Data_t> &kl, const uint64_t &generation) {
+        if (kl.config(CURVE_FLAG)) { V_DEBUG_MSG("VSharedRules_t ERROR: Lists with a score curve cannot be shared"); return false; }
+        const auto &list = kl.getList();
+        uint64_t tableSize = 2;
+        while (tableSize < 2 * list.size()) { tableSize *= 2; }
+        Header_t h{MAGIC, LAYOUT, uint32_t(sizeof(Data_t)), uint32_t(sizeof(uint_t)), 0, generation, 0,
+                   _align(sizeof(Header_t)), tableSize, 0, uint64_t(kl.fallback()()), 0};
+        h.entriesOffset = _align(h.tableOffset + tableSize * sizeof(uint32_t));
+        const uint64_t maxBytes = h.entriesOffset + list.size() * sizeof(Entry_t);
+        if (list.size() >= UINT32_MAX || ftruncate(fd, off_t(maxBytes)) != 0) return false;
+        void *p = mmap(nullptr, maxBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) return false;
+        uint8_t *base = static_cast<uint8_t*>(p);
+        uint32_t *table = reinterpret_cast<uint32_t*>(base + h.tableOffset);
+        Entry_t *entries = reinterpret_cast<Entry_t*>(base + h.entriesOffset);
+        // Unique values, first key wins like a list scan
+        for (const auto &kd : list) {
+            if (!kd.matchable()) continue;
+            const Data_t data = kd.getCData();
+            uint64_t pos = hashData(data) & (tableSize - 1);
+            while (table[pos] != 0 && !(entries[table[pos] - 1].data == data)) { pos = (pos + 1) & (tableSize - 1); }
+            if (table[pos] != 0) continue;
+            std::memset(&entries[h.numEntries], 0, sizeof(Entry_t));
+            entries[h.numEntries].data  = data;
+            entries[h.numEntries].score = VReturn_t(-kd)();
+            table[pos] = uint32_t(++h.numEntries); }
+        h.totalBytes = h.entriesOffset + h.numEntries * sizeof(Entry_t);
+        std::memcpy(base, &h, sizeof(h));
+        munmap(p, maxBytes);
+        return ftruncate(fd, off_t(h.totalBytes)) == 0 || h.totalBytes == maxBytes; }
+
+    /// @brief Maps and checks a segment. The current mapping is not touched.
+    /// @param bytes Set to the size of the mapping.
+    /// @return The mapping, or `nullptr` if the segment cannot be mapped or is not valid.
+    static void* _map(const int &fd, size_t &bytes) {
+        struct stat st;
+        if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(Header_t)) return nullptr;
+        void *p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) return nullptr;
+        if (!_valid(static_cast<const uint8_t*>(p), uint64_t(st.st_size))) {
+            V_DEBUG_MSG("VSharedRules_t ERROR: Segment does not match this type or layout");
+            munmap(p, size_t(st.st_size)); return nullptr; }
+        bytes = size_t(st.st_size);
+        return p; }
+
+    /// @brief Checks that a header matches this type and that every offset, and every slot in the table, stays inside
+    /// the segment. Reads the whole table once, so `query` can probe and mask without checks.
+    static bool _valid(const uint8_t *base, const uint64_t &bytes) {
+        const Header_t *h = reinterpret_cast<const Header_t*>(base);
+        if (h->magic != MAGIC || h->layout != LAYOUT || h->dataSize != sizeof(Data_t) || h->scoreSize != sizeof(uint_t) ||
+            h->totalBytes > bytes) return false;
+        // Table: a power of two with an empty slot, after the header and inside the segment
+        if (h->tableSize == 0 || (h->tableSize & (h->tableSize - 1)) != 0 || h->numEntries >= h->tableSize ||
+            h->tableOffset < sizeof(Header_t) || h->tableOffset % alignof(uint32_t) != 0 || h->tableOffset > h->totalBytes ||
+            h->tableSize > (h->totalBytes - h->tableOffset) / sizeof(uint32_t)) return false;
+        // Entries: after the header and inside the segment
+        if (h->entriesOffset < sizeof(Header_t) || h->entriesOffset % alignof(Entry_t) != 0 || h->entriesOffset > h->totalBytes ||
+            h->numEntries > (h->totalBytes - h->entriesOffset) / sizeof(Entry_t)) return false;
+        const uint32_t *table = reinterpret_cast<const uint32_t*>(base + h->tableOffset);
+        uint64_t used = 0;
+        for (uint64_t pos = 0; pos < h->tableSize; ++pos) {
+            if (table[pos] > h->numEntries) return false;
+            used += (table[pos] != 0); }
+        return used == h->numEntries; }
+
+    /// @brief Switches to a mapping made by `_map`, unmapping the current one.
+    void _use(void *p, const size_t &bytes) {
+        _unmapSegment();
+        const Header_t *h = static_cast<const Header_t*>(p);
+        base_ = p; header_ = h; mappedBytes_ = bytes; generation_ = h->generation;
+        table_   = reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(p) + h->tableOffset);
+        entries_ = reinterpret_cast<const Entry_t*>(static_cast<const uint8_t*>(p) + h->entriesOffset); }
+
+    void _unmapSegment() {
+        if (base_) { munmap(base_, mappedBytes_); }
+        base_ = nullptr; header_ = nullptr; table_ = nullptr; entries_ = nullptr; mappedBytes_ = 0; generation_ = 0; }
+    void _unmap() {
+        _unmapSegment();
+        if (control_) { munmap(control_, sizeof(Control_t)); control_ = nullptr; }}
+};
+
+#endif // V_SHARED_RULES
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+} // END: namespace Validspace                                                                                             ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
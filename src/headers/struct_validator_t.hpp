@@ -0,0 +1,160 @@
+#pragma once
+/**
+ * @file src/struct_validator_t.hpp
+ * @author Ray Richter
+ * @brief VStructValidator_t Class declaration.
+ * @note A struct validator is a list of trait validators. Any FAIL makes the total FAIL, so traits are evaluated in an
+ * order that puts the most selective and cheapest traits first and evaluation stops at the first FAIL. The result is the
+ * same as evaluating every trait in declaration order.
+ */
+#include "Validator_core.hpp"
+#include "return_t.hpp"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <numeric>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// @brief Internal Validator namespace.                                                                                  ////
+namespace Validspace {                                                                                                     ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Trait evaluation order modes.
+enum class VOrder_t : uint8_t {
+    DECLARED,   // Evaluate traits in the order they were added
+    HINTED,     // Evaluate traits by their fail rate and cost hints. Fixed and deterministic.
+    ADAPTIVE,   // Evaluate traits by measured fail rate and cost, using hints until enough calls are measured
+};
+
+/// @brief A validator made of trait validators over parts of `T`.
+/// @tparam T Candidate type, usually a struct.
+/// @note Default order = `VOrder_t::DECLARED`. Ties always resolve in declaration order.
+template <class T> class VStructValidator_t {
+    public:
+    using Trait_t = std::function<VReturn_t(const T&)>;
+
+    /// @brief Constructor from an order mode.
+    /// @param mode Trait order mode as `VOrder_t`.
+    /// @param reorderInterval Number of validations between adaptive reorders as `uint64_t`.
+    VStructValidator_t(const VOrder_t &mode = VOrder_t::DECLARED, const uint64_t &reorderInterval = 4096)
+        : mode_(mode), interval_(std::max<uint64_t>(reorderInterval, 1)) { _publishOrder(); }
+    /// @brief Copy constructor. Measured statistics are not copied.
+    VStructValidator_t(const VStructValidator_t &other) { *this = other; }
+    /// @brief Copy assignment. Measured statistics are not copied.
+    VStructValidator_t& operator=(const VStructValidator_t &rhs) {
+        if (this == &rhs) { return *this; }
+        traits_ = rhs.traits_; mode_ = rhs.mode_; interval_ = rhs.interval_; version_ = rhs.version_;
+        resetStats(); return *this; }
+
+    /// @brief Adds a trait validator.
+    /// @param trait Function validating one trait of a candidate.
+    /// @param costHint Relative evaluation cost, used before the cost is measured.
+    /// @param failHint Expected FAIL rate in `[0, 1]`, used before the FAIL rate is measured.
+    /// @return Trait index as `size_t`.
+    size_t addTrait(const Trait_t &trait, const double &costHint = 1.0, const double &failHint = 0.0) {
+        traits_.push_back({trait, std::max(costHint, 1e-9), std::min(std::max(failHint, 0.0), 1.0)});
+        version_ = nextVersion(); reorder();
+        return traits_.size() - 1; }
+
+    /// @brief Adds a validator for a member or derived value of the candidate.
+    /// @param validator Any validator with `validate(const U&)`. Copied into the struct validator.
+    /// @param project Function getting the trait value from a candidate.
+    /// @return Trait index as `size_t`.
+    template <class V, class Project, std::enable_if_t<std::is_invocable_v<Project, const T&>, int> = 0>
+    size_t addTrait(const V &validator, const Project &project, const double &costHint = 1.0, const double &failHint = 0.0) {
+        return addTrait([validator, project](const T &t) { return VReturn_t(validator.validate(project(t))); },
+            costHint, failHint); }
+
+    /// @brief Validates a candidate. Stops at the first FAIL.
+    VReturn_t validate(const T &qData) const {
+        std::shared_ptr<const std::vector<size_t>> order = std::atomic_load(&order_);
+        VReturn_t ret = VReturn_t::PASS;
+        if (mode_ != VOrder_t::ADAPTIVE) {
+            for (const auto &i : *order) { ret += traits_[i].trait(qData); if (!ret) break; }
+            return ret; }
+
+        // Adaptive: count fails on every call, time one call in 64
+        uint64_t call = calls_.fetch_add(1, std::memory_order_relaxed);
+        bool timed = (call & 63) == 0;
+        for (const auto &i : *order) {
+            const Trait_t &trait = traits_[i].trait;
+            VReturn_t r;
+            if (timed) {
+                auto start = std::chrono::steady_clock::now();
+                r = trait(qData);
+                traits_[i].stats->timedNs.fetch_add(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count()), std::memory_order_relaxed);
+                traits_[i].stats->timed.fetch_add(1, std::memory_order_relaxed); }
+            else { r = trait(qData); }
+            traits_[i].stats->calls.fetch_add(1, std::memory_order_relaxed);
+            if (!r) { traits_[i].stats->fails.fetch_add(1, std::memory_order_relaxed); ret = r; break; }
+            ret += r; }
+        if ((call + 1) % interval_ == 0) { _publishOrder(); }
+        return ret; }
+
+    /// @brief Operator overload to validate a candidate.
+    VReturn_t operator()(const T &qData) const { return validate(qData); }
+
+    /// @brief Sets the trait order mode and reorders.
+    void setOrder(const VOrder_t &mode) { mode_ = mode; reorder(); }
+    /// @brief Recomputes the trait order from hints or measurements.
+    void reorder() { _publishOrder(); }
+    /// @brief Clears measured fail rates and costs.
+    void resetStats() { for (auto &t : traits_) { t.stats = std::make_shared<Stats_t>(); } calls_ = 0; reorder(); }
+
+    /// @brief Gets the current evaluation order as trait indices.
+    std::vector<size_t> order() const { return *std::atomic_load(&order_); }
+    /// @brief Gets the fail rate used for ordering a trait.
+    double failRate(const size_t &trait) const { return _failRate(traits_.at(trait)); }
+    /// @brief Gets the cost used for ordering a trait. Nanoseconds if measured, otherwise the cost hint.
+    double cost(const size_t &trait) const { return _cost(traits_.at(trait)); }
+    /// @brief Gets the number of traits.
+    size_t size() const { return traits_.size(); }
+    /// @brief Gets the rule set version. Changes when a trait is added.
+    uint64_t version() const { return version_; }
+
+    private:
+    /// @brief Measured trait statistics. Held by pointer so traits stay copyable.
+    struct Stats_t { std::atomic<uint64_t> calls{0}, fails{0}, timed{0}, timedNs{0}; };
+    struct TraitEntry_t {
+        Trait_t trait;
+        double  costHint;
+        double  failHint;
+        std::shared_ptr<Stats_t> stats = std::make_shared<Stats_t>(); };
+
+    /// @brief Number of measured calls a hint is worth.
+    static constexpr double PRIOR_CALLS = 32.0;
+
+    std::vector<TraitEntry_t> traits_{};
+    VOrder_t mode_      = VOrder_t::DECLARED;
+    uint64_t interval_  = 4096;
+    uint64_t version_   = nextVersion();
+    mutable std::atomic<uint64_t> calls_{0};
+    mutable std::shared_ptr<const std::vector<size_t>> order_{};
+
+    double _failRate(const TraitEntry_t &t) const {
+        if (mode_ != VOrder_t::ADAPTIVE) return t.failHint;
+        double calls = double(t.stats->calls.load(std::memory_order_relaxed));
+        double fails = double(t.stats->fails.load(std::memory_order_relaxed));
+        return (fails + t.failHint * PRIOR_CALLS) / (calls + PRIOR_CALLS); }
+    double _cost(const TraitEntry_t &t) const {
+        uint64_t timed = t.stats->timed.load(std::memory_order_relaxed);
+        if (mode_ != VOrder_t::ADAPTIVE || timed == 0) return t.costHint;
+        return std::max(double(t.stats->timedNs.load(std::memory_order_relaxed)) / timed, 1e-9); }
+
+    /// @brief Sorts traits by fail rate per cost, highest first, and publishes the new order.
+    void _publishOrder() const {
+        auto order = std::make_shared<std::vector<size_t>>(traits_.size());
+        std::iota(order->begin(), order->end(), 0);
+        if (mode_ != VOrder_t::DECLARED) {
+            std::vector<double> priority(traits_.size());
+            for (size_t i = 0; i < traits_.size(); ++i) { priority[i] = _failRate(traits_[i]) / _cost(traits_[i]); }
+            std::stable_sort(order->begin(), order->end(),
+                [&](const size_t &a, const size_t &b) { return priority[a] > priority[b]; }); }
+        std::atomic_store(&order_, std::shared_ptr<const std::vector<size_t>>(order)); }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+} // END: namespace Validspace                                                                                             ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,211 @@
+#pragma once
+/**
+ * @file src/tenant_index_t.hpp
+ * @author Ray Richter
+ * @brief VTenantIndex_t Class declaration.
+ * @note A frozen index over many tenants' keyed lists that share most of their values. One minimal perfect hash covers
+ * the union of every tenant's values. Each distinct value has one row holding the key code most tenants agree on, and a
+ * sparse override table, sorted by tenant, for the tenants that differ. A tenant that does not list a value is an
+ * override to `ABSENT` (or the row default, when most tenants do not list it). Memory grows with distinct values plus
+ * disagreements, not with tenants x values. One probe answers for one tenant or for every tenant at once.
+ */
+#include "Validator_core.hpp"
+#include "keyed_list_t.hpp"
+#include "perfect_hash_t.hpp"
+#include <algorithm>
+#include <map>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// @brief Internal Validator namespace.                                                                                  ////
+namespace Validspace {                                                                                                     ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief A shared keyed index for many tenants.
+/// @tparam Data_t Data type of the keyed data. Must have a `std::hash` specialization and a == operator.
+/// @note Query results for a tenant match `VKeyedList_t::query` on that tenant's list.
+template <class Data_t> class VTenantIndex_t {
+    public:
+    /// @brief Key code of a value a tenant does not list.
+    static constexpr uint16_t ABSENT      = UINT16_MAX;
+    /// @brief Most tenants an index can hold.
+    static constexpr size_t   MAX_TENANTS = size_t(UINT16_MAX) + 1;
+
+    /// @brief Constructor from tenant lists. Tenant ids are list positions. See `build`.
+    VTenantIndex_t(const std::vector<VKeyedList_t<Data_t>> &tenants, const size_t &numThreads = 0) {
+        build(tenants.data(), tenants.size(), numThreads); }
+    /// @brief Default constructor. Every query returns `FAIL` until `build` is called.
+    VTenantIndex_t() {}
+
+    /// @brief Builds the index from tenant lists, replacing any previous index.
+    /// @param tenants Tenant lists as `VKeyedList_t<Data_t>[numTenants]`. Tenant ids are list positions.
+    /// @param numThreads Number of hash build threads as `size_t`. 0 = hardware concurrency.
+    /// @return `false` if there are too many tenants, more than 65535 distinct results, or two different values with the
+    /// same `std::hash`.
+    bool build(const VKeyedList_t<Data_t> *tenants, const size_t &numTenants, const size_t &numThreads = 0) {
+        _clear();
+        if (numTenants > MAX_TENANTS) { V_DEBUG_MSG("VTenantIndex_t ERROR: Too many tenants!"); return false; }
+        VKeyedList_t<Data_t> all;
+        for (size_t t = 0; t < numTenants; ++t) {
+            misses_.push_back(tenants[t].fallback()); curves_.push_back(tenants[t].curve()); versions_.push_back(tenants[t].version());
+            for (const auto &kd : tenants[t].getList()) { if (kd.matchable()) all.add(kd); }}
+        if (!values_.build(all, numThreads)) { _clear(); return false; }
+        const size_t rows = values_.size();
+
+        // Every tenant's first listed key for each row, in tenant order
+        std::vector<Entry_t> entries;
+        std::vector<uint32_t> seen(rows, 0); // Last tenant + 1 that listed the row
+        std::map<uint_t, uint16_t> lookup;
+        for (size_t t = 0; t < numTenants; ++t) {
+            for (const auto &kd : tenants[t].getList()) {
+                if (!kd.matchable()) continue;
+                const size_t row = values_.find(kd.getCData());
+                if (seen[row] == t + 1) continue; // The first key added wins
+                seen[row] = uint32_t(t + 1);
+                const uint_t result = VReturn_t(-kd)();
+                auto it = lookup.find(result);
+                if (it == lookup.end()) {
+                    if (dict_.size() == ABSENT) { V_DEBUG_MSG("VTenantIndex_t ERROR: Too many distinct results!"); _clear(); return false; }
+                    it = lookup.emplace(result, uint16_t(dict_.size())).first;
+                    dict_.push_back(result); }
+                entries.push_back({uint32_t(row), uint16_t(t), it->second}); }}
+
+        // Group entries by row, keeping tenant order
+        std::vector<uint32_t> rowStart(rows + 1, 0);
+        for (const auto &e : entries) { ++rowStart[e.row + 1]; }
+        for (size_t r = 0; r < rows; ++r) { rowStart[r + 1] += rowStart[r]; }
+        std::vector<Override_t> byRow(entries.size());
+        {
+            std::vector<uint32_t> fill(rowStart.begin(), rowStart.end() - 1);
+            for (const auto &e : entries) { byRow[fill[e.row]++] = {e.tenant, e.code}; }
+        }
+
+        // Pick each row's most common code, ABSENT included, and store the rest as overrides
+        defaults_.resize(rows);
+        overrideStart_.assign(1, 0);
+        overrideStart_.reserve(rows + 1);
+        std::vector<uint32_t> counts(dict_.size(), 0);
+        for (size_t r = 0; r < rows; ++r) {
+            const Override_t *first = byRow.data() + rowStart[r], *last = byRow.data() + rowStart[r + 1];
+            uint16_t best = ABSENT; uint32_t bestCount = uint32_t(numTenants - (last - first));
+            for (auto *o = first; o != last; ++o) {
+                if (++counts[o->code] > bestCount) { bestCount = counts[o->code]; best = o->code; }}
+            for (auto *o = first; o != last; ++o) { counts[o->code] = 0; }
+            defaults_[r] = best;
+            uint32_t next = 0; // Next tenant not yet covered
+            for (auto *o = first; o != last; ++o) {
+                if (best != ABSENT) { for (; next < o->tenant; ++next) { overrides_.push_back({uint16_t(next), ABSENT}); }}
+                if (o->code != best) { overrides_.push_back(*o); }
+                next = uint32_t(o->tenant) + 1; }
+            if (best != ABSENT) { for (; next < numTenants; ++next) { overrides_.push_back({uint16_t(next), ABSENT}); }}
+            overrideStart_.push_back(uint32_t(overrides_.size())); }
+        overrides_.shrink_to_fit();
+        return true; }
+
+    /// @brief Queries data for one tenant. Same result as `VKeyedList_t::query` on the tenant's list.
+    VReturn_t query(const size_t &tenant, const Data_t &qData) const {
+        if (tenant >= misses_.size()) return VReturn_t::FAIL;
+        const size_t row = values_.find(qData);
+        if (row == VPerfectHash_t<Data_t>::NPOS) return _miss(tenant, qData);
+        return _result(tenant, _code(tenant, row), qData); }
+
+    /// @brief Queries data for one tenant. See `query`.
+    VReturn_t operator()(const size_t &tenant, const Data_t &qData) const { return query(tenant, qData); }
+
+    /// @brief Queries many values for one tenant.
+    /// @param out Output as `VReturn_t[count]`.
+    void query(const size_t &tenant, const Data_t *qData, const size_t &count, VReturn_t *out) const {
+        for (size_t i = 0; i < count; ++i) { out[i] = query(tenant, qData[i]); }}
+
+    /// @brief Queries data for several tenants with one probe.
+    /// @param tenantIds Tenants as `size_t[count]`.
+    /// @param out Output as `VReturn_t[count]`, in `tenantIds` order.
+    void query(const size_t *tenantIds, const size_t &count, const Data_t &qData, VReturn_t *out) const {
+        const size_t row = values_.find(qData);
+        for (size_t i = 0; i < count; ++i) {
+            const size_t tenant = tenantIds[i];
+            if (tenant >= misses_.size()) { out[i] = VReturn_t::FAIL; continue; }
+            out[i] = (row == VPerfectHash_t<Data_t>::NPOS) ? _miss(tenant, qData) : _result(tenant, _code(tenant, row), qData); }}
+
+    /// @brief Queries data for every tenant with one probe.
+    /// @param out Output as `VReturn_t[numTenants()]`, indexed by tenant.
+    void queryAll(const Data_t &qData, VReturn_t *out) const {
+        const size_t row = values_.find(qData), numTenants = misses_.size();
+        if (row == VPerfectHash_t<Data_t>::NPOS) {
+            for (size_t t = 0; t < numTenants; ++t) { out[t] = _miss(t, qData); }
+            return; }
+        const uint16_t code = defaults_[row];
+        if (code == ABSENT) { for (size_t t = 0; t < numTenants; ++t) { out[t] = _miss(t, qData); }}
+        else { const VReturn_t ret(dict_[code]); for (size_t t = 0; t < numTenants; ++t) { out[t] = ret; }}
+        for (uint32_t i = overrideStart_[row]; i < overrideStart_[row + 1]; ++i) {
+            out[overrides_[i].tenant] = _result(overrides_[i].tenant, overrides_[i].code, qData); }}
+
+    /// @brief Queries data for every tenant with one probe. See `queryAll`.
+    std::vector<VReturn_t> queryAll(const Data_t &qData) const {
+        std::vector<VReturn_t> ret(misses_.size());
+        queryAll(qData, ret.data());
+        return ret; }
+
+    /// @brief Gets the number of tenants.
+    size_t numTenants() const { return misses_.size(); }
+    /// @brief Gets the number of distinct values over every tenant.
+    size_t size() const { return values_.size(); }
+    /// @brief Gets the number of tenant keys that differ from their row default.
+    size_t numOverrides() const { return overrides_.size(); }
+    /// @brief Gets the version of a tenant's list when the index was built.
+    uint64_t version(const size_t &tenant) const { return (tenant < versions_.size()) ? versions_[tenant] : 0; }
+    /// @brief Memory used by the index in bytes, including the keyed data. See `memoryUsage`.
+    size_t memoryBytes() const { return memoryUsage().total(); }
+    /// @brief Gets the bytes used by the index, by component. `keys` holds the row defaults, overrides, and result
+    /// dictionary, and `index` the shared hash, override offsets, and per tenant miss results and versions.
+    VMemoryUsage_t memoryUsage() const {
+        VMemoryUsage_t ret = values_.memoryUsage();
+        ret.storage = VStorage_t::TENANT;
+        ret.keys   += defaults_.size() * sizeof(uint16_t) + overrides_.size() * sizeof(Override_t) + dict_.size() * sizeof(uint_t);
+        ret.index  += overrideStart_.size() * sizeof(uint32_t) + misses_.size() * sizeof(VReturn_t) + versions_.size() * sizeof(uint64_t);
+        ret.curve   = curves_.size() * sizeof(VScoreCurve_t<Data_t>);
+        for (const auto &c : curves_) { ret.curve += c.memoryBytes(); }
+        ret.slack  += VMemoryUsage_t::slackOf(defaults_) + VMemoryUsage_t::slackOf(overrideStart_) + VMemoryUsage_t::slackOf(overrides_) +
+                      VMemoryUsage_t::slackOf(dict_) + VMemoryUsage_t::slackOf(misses_) + VMemoryUsage_t::slackOf(curves_) +
+                      VMemoryUsage_t::slackOf(versions_);
+        ret.object  = sizeof(*this);
+        return ret; }
+    /// @brief Releases unused capacity left by `build`.
+    /// @return Bytes released.
+    size_t shrinkToFit() {
+        const size_t before = memoryUsage().total();
+        defaults_.shrink_to_fit(); overrideStart_.shrink_to_fit(); dict_.shrink_to_fit();
+        misses_.shrink_to_fit(); curves_.shrink_to_fit(); versions_.shrink_to_fit();
+        return before - memoryUsage().total(); }
+
+    private:
+    /// @brief A tenant's key code for a row.
+    struct Override_t { uint16_t tenant; uint16_t code; };
+    /// @brief A build time tenant key.
+    struct Entry_t { uint32_t row; uint16_t tenant; uint16_t code; };
+
+    VPerfectHash_t<Data_t> values_{};        // Slot = row
+    std::vector<uint16_t> defaults_{};       // Key code per row
+    std::vector<uint32_t> overrideStart_{};  // Override range per row
+    std::vector<Override_t> overrides_{};    // Sorted by tenant within a row
+    std::vector<uint_t> dict_{};             // Result per key code
+    std::vector<VReturn_t> misses_{};        // Per tenant
+    std::vector<VScoreCurve_t<Data_t>> curves_{};
+    std::vector<uint64_t> versions_{};
+
+    void _clear() {
+        values_ = VPerfectHash_t<Data_t>(); defaults_.clear(); overrideStart_.clear(); overrides_.clear(); dict_.clear();
+        misses_.clear(); curves_.clear(); versions_.clear(); }
+    /// @brief Gets a tenant's result for data it does not list.
+    VReturn_t _miss(const size_t &tenant, const Data_t &qData) const { return curves_[tenant] ? curves_[tenant](qData) : misses_[tenant]; }
+    /// @brief Gets a tenant's key code for a row.
+    uint16_t _code(const size_t &tenant, const size_t &row) const {
+        const Override_t *first = overrides_.data() + overrideStart_[row], *last = overrides_.data() + overrideStart_[row + 1];
+        const Override_t *o = std::lower_bound(first, last, tenant, [](const Override_t &a, const size_t &t) { return a.tenant < t; });
+        return (o != last && o->tenant == tenant) ? o->code : defaults_[row]; }
+    VReturn_t _result(const size_t &tenant, const uint16_t &code, const Data_t &qData) const {
+        return (code == ABSENT) ? _miss(tenant, qData) : VReturn_t(dict_[code]); }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+} // END: namespace Validspace                                                                                             ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
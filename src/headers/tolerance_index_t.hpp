@@ -0,0 +1,259 @@
+#pragma once
+/**
+ * @file src/tolerance_index_t.hpp
+ * @author Ray Richter
+ * @brief VToleranceIndex_t Class declaration.
+ * @note A frozen, read only copy of a floating point `VKeyedList_t` that matches values within a tolerance instead of
+ * with `==`, so `1.0000001f` can find `1.0f`. Values are sorted once with one entry per distinct value. A query is one
+ * branchless lower bound, then a look at the entries on either side: the nearest one within tolerance wins, so the
+ * cost is O(log n) however wide the tolerance is. Batches run the lower bounds of many queries side by side, with AVX2
+ * gathers when available, so their cache misses overlap.
+ * Tolerances:
+ *  - ABSOLUTE: `|value - query| <= tolerance`, computed in the data type. Equal values always match, so infinities do.
+ *  - ULPS:     At most `tolerance` representable values apart. -0.0 and 0.0 are the same value.
+ * NaN never matches. Ties, between duplicate list values or two values at the same distance, resolve by key precedence.
+ */
+#include "Validator_core.hpp"
+#include "keyed_list_t.hpp"
+#include "range_set_t.hpp"
+#include "result_column_t.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// @brief Internal Validator namespace.                                                                                  ////
+namespace Validspace {                                                                                                     ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Tolerance modes.
+enum class VTolerance_t : uint8_t {
+    ABSOLUTE, // Distance in value units
+    ULPS,     // Distance in units in the last place
+};
+
+/// @brief A nearest match index over a frozen floating point keyed list.
+/// @tparam Data_t `float` or `double`.
+/// @note Default tie precedence = `VPrecedence_t::STRICTEST`. `LEFT` keeps the entry added first and `RIGHT` the one
+/// added last. `STRICTEST` and `LOOSEST` compare results and fall back to the entry added first. A zero tolerance with
+/// `LEFT` gives the same results as `VKeyedList_t::query` on the source list.
+template <class Data_t> class VToleranceIndex_t {
+    static_assert(std::is_same<Data_t, float>::value || std::is_same<Data_t, double>::value,
+                  "VToleranceIndex_t ERROR: Data_t must be float or double.");
+    public:
+    template <class T> using AlignedVector_t = std::vector<T, VAlignedAllocator_t<T>>;
+    /// @brief Returned by `nearest` when nothing is within tolerance.
+    static constexpr size_t NPOS = SIZE_MAX;
+    /// @brief Queries per batch block.
+    static constexpr size_t BLOCK = 64;
+
+    /// @brief Constructor from a keyed list. See `build`.
+    VToleranceIndex_t(const VKeyedList_t<Data_t> &kl, const VTolerance_t &mode, const double &tolerance,
+                      const VPrecedence_t &ties = VPrecedence_t::STRICTEST) { build(kl, mode, tolerance, ties); }
+    /// @brief Default constructor. Every query returns `FAIL` until `build` is called.
+    VToleranceIndex_t() {}
+
+    /// @brief Builds the index from a keyed list, replacing any previous index.
+    /// @param kl Keyed list to freeze as `VKeyedList_t<Data_t>`.
+    /// @param mode Tolerance mode as `VTolerance_t`.
+    /// @param tolerance Largest matching distance. ULPS tolerances are rounded to a whole count. Negative or NaN = 0.
+    /// @param ties Which entry wins a tie as `VPrecedence_t`.
+    void build(const VKeyedList_t<Data_t> &kl, const VTolerance_t &mode, const double &tolerance,
+               const VPrecedence_t &ties = VPrecedence_t::STRICTEST) {
+        const auto &list = kl.getList();
+        _clear(); miss_ = kl.fallback(); curve_ = kl.curve();
+        mode_ = mode; ties_ = ties;
+        const double t = std::max(0.0, tolerance);
+        absolute_ = Data_t(t);
+        ulps_ = (t >= 18446744073709551615.0) ? UINT64_MAX : uint64_t(std::llround(t));
+
+        // Sort matchable entries by value, then list order, and keep the winning entry of each distinct value
+        std::vector<size_t> order;
+        for (size_t i = 0; i < list.size(); ++i) { if (list[i].matchable()) order.push_back(i); }
+        std::stable_sort(order.begin(), order.end(), [&](const size_t &a, const size_t &b) {
+            return *list[a].getPData() < *list[b].getPData(); });
+        for (size_t i = 0; i < order.size();) {
+            const Data_t value = *list[order[i]].getPData();
+            size_t best = order[i];
+            for (++i; i < order.size() && *list[order[i]].getPData() == value; ++i) {
+                if (_precedes(uint_t(VReturn_t(-list[order[i]])()), order[i], uint_t(VReturn_t(-list[best])()), best)) { best = order[i]; }}
+            values_.push_back(value + Data_t(0)); // -0.0 + 0.0 = 0.0
+            results_.push_back(VReturn_t(-list[best])());
+            added_.push_back(best); }
+        version_ = kl.version(); }
+
+    /// @brief Queries data to get the score or key of the nearest entry within tolerance.
+    VReturn_t query(const Data_t &qData) const { return VReturn_t(_result(qData, _lowerBound(qData))); }
+    /// @brief Operator overload to query data.
+    VReturn_t operator()(const Data_t &qData) const { return query(qData); }
+
+    /// @brief Queries many values.
+    /// @param out Results as `VReturn_t[count]`.
+    void query(const Data_t *values, const size_t &count, VReturn_t *out) const {
+        size_t pos[BLOCK];
+        for (size_t first = 0; first < count; first += BLOCK) {
+            const size_t n = std::min(BLOCK, count - first);
+            _lowerBounds(values + first, n, pos);
+            for (size_t i = 0; i < n; ++i) { out[first + i] = _result(values[first + i], pos[i]); }}}
+
+    /// @brief Finds the entry a query matches.
+    /// @return Entry index into `values()`, or `NPOS` if nothing is within tolerance.
+    size_t nearest(const Data_t &qData) const { return _nearest(qData, _lowerBound(qData)); }
+
+    /// @brief Gets the number of distinct values.
+    size_t size() const { return values_.size(); }
+    /// @brief Gets the sorted distinct values.
+    const AlignedVector_t<Data_t>& values() const { return values_; }
+    /// @brief Gets the tolerance mode.
+    VTolerance_t mode() const { return mode_; }
+    /// @brief Gets the tolerance, in value units or ULPs.
+    double tolerance() const { return (mode_ == VTolerance_t::ULPS) ? double(ulps_) : double(absolute_); }
+    /// @brief Gets the version of the list the index was built from.
+    uint64_t version() const { return version_; }
+    /// @brief Memory used by the index in bytes. See `memoryUsage`.
+    size_t memoryBytes() const { return memoryUsage().total(); }
+    /// @brief Gets the bytes used by the index, by component. `keys` holds the result of every value.
+    VMemoryUsage_t memoryUsage() const {
+        VMemoryUsage_t ret;
+        ret.storage = VStorage_t::TOLERANCE;
+        ret.data    = values_.size() * sizeof(Data_t);
+        ret.keys    = results_.size() * sizeof(uint_t);
+        ret.index   = added_.size() * sizeof(size_t);
+        ret.curve   = curve_.memoryBytes();
+        ret.slack   = VMemoryUsage_t::slackOf(values_) + VMemoryUsage_t::slackOf(results_) + VMemoryUsage_t::slackOf(added_);
+        ret.object  = sizeof(*this);
+        return ret; }
+
+    private:
+    AlignedVector_t<Data_t> values_{};  // Sorted distinct values
+    std::vector<uint_t>     results_{}; // Result of each value's winning entry
+    std::vector<size_t>     added_{};   // List index of each value's winning entry, for ties
+    VTolerance_t  mode_ = VTolerance_t::ABSOLUTE;
+    VPrecedence_t ties_ = VPrecedence_t::STRICTEST;
+    Data_t   absolute_ = 0;
+    uint64_t ulps_     = 0;
+    VReturn_t miss_ = VReturn_t::FAIL;
+    VScoreCurve_t<Data_t> curve_{}; // Scores misses if the list has a curve
+    uint64_t version_ = 0;
+
+    void _clear() { values_.clear(); results_.clear(); added_.clear(); miss_ = VReturn_t::FAIL; curve_ = {}; version_ = 0; }
+
+    /// @brief Gets the result for a query whose lower bound is `pos`.
+    uint_t _result(const Data_t &qData, const size_t &pos) const {
+        const size_t i = _nearest(qData, pos);
+        if (i != NPOS) return results_[i];
+        return curve_ ? curve_(qData)() : miss_(); }
+
+    /// @brief Picks between the entries on either side of a query's lower bound.
+    size_t _nearest(const Data_t &qData, const size_t &pos) const {
+        if (qData != qData) return NPOS;
+        const bool below = pos > 0 && _within(values_[pos - 1], qData);
+        const bool above = pos < values_.size() && _within(values_[pos], qData);
+        if (!below) return above ? pos : NPOS;
+        if (!above) return pos - 1;
+        // Both within tolerance: nearer wins, then precedence
+        int closer;
+        if (mode_ == VTolerance_t::ULPS) {
+            const uint64_t b = _ulps(values_[pos - 1], qData), a = _ulps(values_[pos], qData);
+            closer = (a < b) - (b < a); }
+        else {
+            const Data_t b = qData - values_[pos - 1], a = (values_[pos] == qData) ? Data_t(0) : values_[pos] - qData;
+            closer = (a < b) - (b < a); }
+        if (closer != 0) return (closer > 0) ? pos : pos - 1;
+        return _precedes(results_[pos], added_[pos], results_[pos - 1], added_[pos - 1]) ? pos : pos - 1; }
+
+    bool _within(const Data_t &value, const Data_t &qData) const {
+        if (value == qData) return true;
+        if (mode_ == VTolerance_t::ULPS) return _ulps(value, qData) <= ulps_;
+        return std::abs(value - qData) <= absolute_; }
+
+    /// @brief Checks if entry `a` wins a tie against entry `b`.
+    bool _precedes(const uint_t &resultA, const size_t &addedA, const uint_t &resultB, const size_t &addedB) const {
+        // Strictness follows the query result: FAIL, then PASS, then scores, then PERFECT
+        const uint_t rankA = resultRank(resultA), rankB = resultRank(resultB);
+        switch (ties_) {
+        case VPrecedence_t::RIGHT:     return addedA > addedB;
+        case VPrecedence_t::STRICTEST: if (rankA != rankB) return rankA < rankB; break;
+        case VPrecedence_t::LOOSEST:   if (rankA != rankB) return rankA > rankB; break;
+        default: break; }
+        return addedA < addedB; }
+
+    /// @brief Maps a value to a signed integer that counts ULPs. -0.0 and 0.0 both map to 0.
+    static int64_t _ordinal(const Data_t &value) {
+        using Bits_t = typename std::conditional<sizeof(Data_t) == 4, int32_t, int64_t>::type;
+        Bits_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return (bits < 0) ? -int64_t(bits & std::numeric_limits<Bits_t>::max()) : int64_t(bits); }
+    /// @brief Gets the distance between two non NaN values in ULPs.
+    static uint64_t _ulps(const Data_t &a, const Data_t &b) {
+        const int64_t x = _ordinal(a), y = _ordinal(b);
+        return (x > y) ? uint64_t(x) - uint64_t(y) : uint64_t(y) - uint64_t(x); }
+
+    /// @brief Branchless lower bound: the first entry not below `qData`.
+    size_t _lowerBound(const Data_t &qData) const {
+        const Data_t *data = values_.data();
+        size_t n = values_.size();
+        if (n == 0) return 0;
+        const Data_t *base = data;
+        while (n > 1) {
+            const size_t half = n / 2;
+            base = (base[half] < qData) ? base + half : base;
+            n -= half; }
+        return size_t(base - data) + (*base < qData); }
+
+    /// @brief Lower bounds of up to `BLOCK` queries, searched side by side. Every search takes the same steps.
+    void _lowerBounds(const Data_t *q, const size_t &count, size_t *pos) const {
+        const Data_t *data = values_.data();
+        const size_t size = values_.size();
+        if (size == 0) { for (size_t i = 0; i < count; ++i) { pos[i] = 0; } return; }
+        size_t i = 0;
+#if defined(__AVX2__)
+        if constexpr (std::is_same<Data_t, float>::value) {
+            if (size <= size_t(INT32_MAX)) {
+                for (; i + 8 <= count; i += 8) {
+                    const __m256 v = _mm256_loadu_ps(q + i);
+                    __m256i base = _mm256_setzero_si256();
+                    for (size_t n = size; n > 1;) {
+                        const size_t half = n / 2;
+                        const __m256i probe = _mm256_add_epi32(base, _mm256_set1_epi32(int32_t(half)));
+                        const __m256 below = _mm256_cmp_ps(_mm256_i32gather_ps(data, probe, 4), v, _CMP_LT_OQ);
+                        base = _mm256_blendv_epi8(base, probe, _mm256_castps_si256(below));
+                        n -= half; }
+                    // Masks are -1, so subtracting one adds the final step
+                    const __m256 below = _mm256_cmp_ps(_mm256_i32gather_ps(data, base, 4), v, _CMP_LT_OQ);
+                    alignas(32) int32_t out[8];
+                    _mm256_store_si256(reinterpret_cast<__m256i*>(out), _mm256_sub_epi32(base, _mm256_castps_si256(below)));
+                    for (size_t j = 0; j < 8; ++j) { pos[i + j] = size_t(out[j]); }}}}
+        if constexpr (std::is_same<Data_t, double>::value) {
+            for (; i + 4 <= count; i += 4) {
+                const __m256d v = _mm256_loadu_pd(q + i);
+                __m256i base = _mm256_setzero_si256();
+                for (size_t n = size; n > 1;) {
+                    const size_t half = n / 2;
+                    const __m256i probe = _mm256_add_epi64(base, _mm256_set1_epi64x(int64_t(half)));
+                    const __m256d below = _mm256_cmp_pd(_mm256_i64gather_pd(data, probe, 8), v, _CMP_LT_OQ);
+                    base = _mm256_blendv_epi8(base, probe, _mm256_castpd_si256(below));
+                    n -= half; }
+                const __m256d below = _mm256_cmp_pd(_mm256_i64gather_pd(data, base, 8), v, _CMP_LT_OQ);
+                alignas(32) int64_t out[4];
+                _mm256_store_si256(reinterpret_cast<__m256i*>(out), _mm256_sub_epi64(base, _mm256_castpd_si256(below)));
+                for (size_t j = 0; j < 4; ++j) { pos[i + j] = size_t(out[j]); }}}
+#endif
+        // Portable path: the searches are independent, so their loads overlap
+        if (i == count) return;
+        const size_t rest = count - i;
+        for (size_t j = 0; j < rest; ++j) { pos[i + j] = 0; }
+        for (size_t n = size; n > 1;) {
+            const size_t half = n / 2;
+            for (size_t j = 0; j < rest; ++j) { pos[i + j] += (data[pos[i + j] + half] < q[i + j]) ? half : 0; }
+            n -= half; }
+        for (size_t j = 0; j < rest; ++j) { pos[i + j] += (data[pos[i + j]] < q[i + j]); }}
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+} // END: namespace Validspace                                                                                             ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -2,11 +2,14 @@
 /**
  * @file src/validator_t.hpp
  * @author Ray Richter
- * @brief VKeyedList_t Class declaration. 
+ * @brief Validator_t Class declaration. 
  */
 #include <flagfield.hpp>
 #include "Validator_core.hpp"
+#include "async_t.hpp"
 #include "keyed_list_t.hpp"
+#include "query_cache_t.hpp"
+#include "ranking_t.hpp"
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //// @brief Internal Validator namespace.                                                                                  ////
@@ -18,19 +21,48 @@ namespace Validspace {
 template <class T, class = void>
 class Validator_t {
     public:
-    // Validator (const VKey_t &key, const std::vector<T> &list) : list_(key, list) {}
-    // Validator (const std::vector<VKeyedData_t<T>>   &rawList) : list_(rawList  ) {}
-    // Validator (const VKeyedData_t<T>   &kd)                   : list_(kd       ) {}
-    // Validator (const VKeyedList_t<T>   &kl)                   : list_(kl       ) {}
-    // Validator (const std::vector <T> &list)                   : list_(list     ) {}
-    // Validator (const VKey_t &key, const T &data)              : list_(key, data) {}
-    // Validator (const T &data)                                 : list_(data     ) {}
-    Validator_t (...) : list_(...) { V_DEBUG_MSG("Called Validator base type constructor with args."); }
+    Validator_t (const VKey_t &key, const std::vector<T> &list) : list_(key, list) {}
+    Validator_t (const std::vector<VKeyedData_t<T>>   &rawList) : list_(rawList  ) {}
+    Validator_t (const VKeyedData_t<T>   &kd)                   : list_(kd       ) {}
+    Validator_t (const VKeyedList_t<T>   &kl)                   : list_(kl       ) {}
+    Validator_t (const std::vector <T> &list)                   : list_(list     ) {}
+    Validator_t (const VKey_t &key, const T &data)              : list_(key, data) {}
+    Validator_t (const T &data)                                 : list_(data     ) {}
     Validator_t ()    : list_()    { V_DEBUG_MSG("Called Validator base type constructor."); }
     ~Validator_t()                 { V_DEBUG_MSG("Called Validator base type deconstructor."); }
 
-    uint_t add(...) { return list_.add(...); }
+    template <class... Args> uint_t add(const Args&... args) { return list_.add(args...); }
     VReturn_t validate(const T &qData) const { return list_.query(qData); }
+    /// @brief Validates many values at once. See `VKeyedList_t::query`.
+    void validate(const T *qData, const size_t &count, VReturn_t *out) const { list_.query(qData, count, out); }
+    /// @brief Validates through a memoizing cache. Cached results are dropped when the rules change.
+    template <class Hash> VReturn_t validate(const T &qData, VQueryCache_t<T, Hash> &cache) const { 
+        return cache.validate(*this, qData); }
+    VReturn_t operator()(const T &qData) const { return validate(qData); }
+#if defined(V_ASYNC)
+    /// @brief Fetches a value from an async source, then validates it. Run with `VAsyncScheduler_t` or `co_await` it from
+    /// another task. The validator must outlive the task.
+    template <class Key_t> VTask_t<VReturn_t> validateAsync(VAsyncSource_t<Key_t, T> &source, Key_t key) const {
+        const T value = co_await source.fetch(key);
+        co_return validate(value); }
+#endif
+    /// @brief Ranks the best `k` candidates found before a deadline. See `rankWithin`.
+    VRanking_t rank(const T *candidates, const size_t &count, const size_t &k, const VDeadline_t &deadline,
+                    const size_t *order = nullptr) const { return rankWithin(*this, candidates, count, k, deadline, order); }
+    /// @brief Ranks the best `k` candidates found before a deadline, scoring `order` first to last if it is not empty.
+    VRanking_t rank(const std::vector<T> &candidates, const size_t &k, const VDeadline_t &deadline,
+                    const std::vector<size_t> &order = {}) const {
+        if (order.empty()) return rank(candidates.data(), candidates.size(), k, deadline);
+        return rank(candidates.data(), order.size(), k, deadline, order.data()); }
+
+    /// @brief Gets the rule set version. See `VKeyedList_t::version`.
+    uint64_t version() const { return list_.version(); }
+    /// @brief Gets the keyed list.
+    const VKeyedList_t<T>& list() const { return list_; }
+    /// @brief Gets the bytes used by the validator, by component. See `VKeyedList_t::memoryUsage`.
+    VMemoryUsage_t memoryUsage() const { VMemoryUsage_t ret = list_.memoryUsage(); ret.object = sizeof(*this); return ret; }
+    /// @brief Releases unused list capacity. See `VKeyedList_t::shrinkToFit`.
+    size_t shrinkToFit() { return list_.shrinkToFit(); }
 
     private:
     VKeyedList_t<T> list_;
@@ -53,16 +85,16 @@ class Validator_t {
 //     std::vector<VRange_t<T>> ranges_;
 // };
 
-/// @brief Validator class for object types. Contains validators for subtypes.
-template <class T>
-class Validator_t<T, std::enable_if_t<std::is_object_v<T>>> {
-    public:
-
-    VReturn_t validate(const T::U &qData) const {}
-
-    private:
-    std::vector<Validator<T::U>> subValidators_;
-};
+// /// @brief Validator class for object types. Contains validators for subtypes.
+// template <class T>
+// class Validator_t<T, std::enable_if_t<std::is_object_v<T>>> {
+//     public:
+//
+//     VReturn_t validate(const T::U &qData) const {}
+//
+//     private:
+//     std::vector<Validator<T::U>> subValidators_;
+// };
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 } // END: namespace Validspace                                                                                             ////
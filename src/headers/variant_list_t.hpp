@@ -0,0 +1,70 @@
+#pragma once
+/**
+ * @file src/variant_list_t.hpp
+ * @author Ray Richter
+ * @brief VVariantKeyedList_t Class declaration.
+ * @note Holds one packed `VKeyedList_t` per alternative type. Queries dispatch on the variant index with `std::visit`,
+ * so there is no virtual call or allocation per query.
+ */
+#include "Validator_core.hpp"
+#include "keyed_list_t.hpp"
+#include <tuple>
+#include <variant>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// @brief Internal Validator namespace.                                                                                  ////
+namespace Validspace {                                                                                                     ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief A keyed list over several data types, e.g. a field that may be an int, a float, or a string.
+/// @tparam Ts Alternative data types. Each gets its own `VKeyedList_t`.
+/// @note An alternative with no data behaves like an empty `VKeyedList_t`.
+template <class... Ts> class VVariantKeyedList_t {
+    static_assert(sizeof...(Ts) > 0, "VVariantKeyedList_t ERROR: Needs at least one data type.");
+    public:
+    using Variant_t = std::variant<Ts...>;
+
+    /// @brief Default constructor.
+    VVariantKeyedList_t() {}
+
+    /// @brief Adds keyed data to the list of its type.
+    /// @return Number of add fails as `uint_t`
+    template <class Data_t> uint_t add(const VKey_t &key, const Data_t &data) { return list<Data_t>().add(key, data); }
+    /// @brief Adds data to the list of its type with a default key.
+    /// @return Number of add fails as `uint_t`
+    template <class Data_t> uint_t add(const Data_t &data) { return list<Data_t>().add(data); }
+    /// @brief Adds keyed variant data to the list of the held type.
+    /// @return Number of add fails as `uint_t`
+    uint_t add(const VKey_t &key, const Variant_t &data) {
+        return std::visit([&](const auto &d) { return add(key, d); }, data); }
+
+    /// @brief Queries a value of a known type. No dispatch.
+    template <class Data_t> VReturn_t query(const Data_t &qData) const { return list<Data_t>().query(qData); }
+    /// @brief Queries a variant value. Dispatches on the held type.
+    VReturn_t query(const Variant_t &qData) const {
+        return std::visit([this](const auto &d) { return query(d); }, qData); }
+
+    /// @brief Operator overload to query a variant value.
+    VReturn_t operator()(const Variant_t &qData) const { return query(qData); }
+
+    /// @brief Builds Bloom filters over every alternative list. See `VKeyedList_t::compile`.
+    void compile(const double &bitsPerKey = 10.0) { std::apply([&](auto &...l) { (l.compile(bitsPerKey), ...); }, lists_); }
+
+    /// @brief Gets the keyed list of one alternative type.
+    template <class Data_t>       VKeyedList_t<Data_t>& list()       { return std::get<VKeyedList_t<Data_t>>(lists_); }
+    /// @brief Gets the keyed list of one alternative type.
+    template <class Data_t> const VKeyedList_t<Data_t>& list() const { return std::get<VKeyedList_t<Data_t>>(lists_); }
+
+    /// @brief Gets the total size of every alternative list.
+    size_t size() const { return std::apply([](const auto &...l) { return (l.size() + ...); }, lists_); }
+    /// @brief Gets a version that changes when any alternative list changes.
+    uint64_t version() const {
+        return std::apply([](const auto &...l) { uint64_t v = 0; ((v = mixHash(v ^ l.version())), ...); return v; }, lists_); }
+
+    private:
+    std::tuple<VKeyedList_t<Ts>...> lists_{};
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+} // END: namespace Validspace                                                                                             ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -20,6 +20,14 @@
 
 using namespace Validspace;
 
+/// @brief Adds scores, clamping to the highest score below `PERFECT` instead of wrapping into a special value.
+static uint_t _satAdd(const uint_t &a, const uint_t &b) {
+    const uint_t max = VReturn_t::PERFECT - 1;
+    return (a >= max || b >= max - a) ? max : a + b; }
+
+/// @brief Subtracts scores, clamping to `PASS` instead of wrapping into a special value.
+static uint_t _satSub(const uint_t &a, const uint_t &b) { return (b >= a) ? VReturn_t::PASS : a - b; }
+
 /// @section Constructors
 
 VReturn_t::VReturn_t(const uint_t    &val) : score(val)       {}
@@ -44,29 +52,29 @@ VReturn_t& VReturn_t::operator= (const VReturn_t &rhs) {
     score =  rhs.score;  return *this; }
 
 /// @section Arithmatic Operator Overloads
-/// @note FAIL always returns FAIL, PERFECT returns PERFECT if neither is FAIL. 
+/// @note FAIL always returns FAIL, PERFECT returns PERFECT if neither is FAIL. Scores saturate instead of wrapping.
 
 const VReturn_t VReturn_t::operator+(const VReturn_t &rhs) const {
     if (!(*this) || !rhs) { return VReturn_t(   FAIL); }
     if (*(*this) || *rhs) { return VReturn_t(PERFECT); }
-    return               VReturn_t(score + rhs.score); }
+    return       VReturn_t(_satAdd(score, rhs.score)); }
 
 const VReturn_t VReturn_t::operator-(const VReturn_t &rhs) const {
     if (!(*this) || !rhs) { return VReturn_t(   FAIL); }
     if (*(*this) || *rhs) { return VReturn_t(PERFECT); }
-    return               VReturn_t(score - rhs.score); }
+    return       VReturn_t(_satSub(score, rhs.score)); }
 
 VReturn_t& VReturn_t::operator+=(const VReturn_t &rhs) { 
     if (!rhs) { score  =        FAIL; return *this; }
     if (~(*this))                   { return *this; }
     if (*rhs) { score  =     PERFECT; return *this; }
-                score +=   rhs.score; return *this; }
+                score = _satAdd(score, rhs.score); return *this; }
 
 VReturn_t& VReturn_t::operator-=(const VReturn_t &rhs) { 
     if (!rhs) { score  =        FAIL; return *this; }
     if (~(*this))                   { return *this; }
     if (*rhs) { score  =     PERFECT; return *this; }
-                score -=   rhs.score; return *this; }
+                score = _satSub(score, rhs.score); return *this; }
 
 /// @section Boolean Operator Overloads
 
@@ -0,0 +1,743 @@
+/**
+ * @file tests/benchmarks.cpp
+ * @author Ray Richter
+ * @note Main file for benchmarking. Usage: `ValidatorBenchmarks [list size] [query count] [perf]`
+ * `perf` adds hardware counters per query for every storage mode, see `benchCounters`.
+ */
+
+#include "../include/Validator.hpp"
+#include "perf_counters.hpp"
+#include <iomanip>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+#define MSG(msg) std::cout << msg << std::endl
+
+using benchClock = std::chrono::steady_clock;
+
+/// @brief Times `count` calls of `fn(i)` and returns nanoseconds per call.
+template <class Fn> double timePerCall(const size_t &count, Fn &&fn) {
+    auto start = benchClock::now();
+    for (size_t i = 0; i < count; ++i) { fn(i); }
+    std::chrono::duration<double, std::nano> elapsed = benchClock::now() - start;
+    return elapsed.count() / double(count ? count : 1);
+}
+
+/// @brief Makes `count` queries where `missRate` of them are not in a list of `[0, listSize)`.
+std::vector<uint32_t> makeQueries(const size_t &count, const size_t &listSize, const double &missRate, std::mt19937 &rng) {
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    std::uniform_int_distribution<uint32_t> hit(0, uint32_t(listSize - 1)), miss(uint32_t(listSize), UINT32_MAX);
+    std::vector<uint32_t> queries(count);
+    for (auto &q : queries) { q = (coin(rng) < missRate) ? miss(rng) : hit(rng); }
+    return queries;
+}
+
+/// @brief Blacklist with a 99% miss rate, with and without the Bloom pre-filter.
+void benchBlacklistFilter(const size_t &listSize, const size_t &queryCount) {
+    std::mt19937 rng(42);
+    std::vector<uint32_t> values(listSize);
+    for (size_t i = 0; i < listSize; ++i) { values[i] = uint32_t(i); }
+    VKeyedList_t<uint32_t> blacklist(VKey_t::BLACKLIST, values);
+    std::vector<uint32_t> queries = makeQueries(queryCount, listSize, 0.99, rng);
+
+    size_t passed = 0;
+    double scanNs = timePerCall(queries.size(), [&](size_t i) { passed += !!blacklist.query(queries[i]); });
+    blacklist.compile(10.0);
+    double filterNs = timePerCall(queries.size(), [&](size_t i) { passed -= !!blacklist.query(queries[i]); });
+
+    MSG("Blacklist pre-filter (" << listSize << " entries, " << queryCount << " queries, 99% miss):");
+    MSG("\tLinear scan:       " << scanNs   << " ns/query");
+    MSG("\tBloom + scan:      " << filterNs << " ns/query");
+    MSG("\tFilter memory:     " << blacklist.filter().memoryBytes() << " bytes ("
+        << double(blacklist.filter().memoryBytes() * 8) / listSize << " bits/key, k = "
+        << blacklist.filter().numHashes() << ")");
+    MSG("\tExpected FP rate:  " << blacklist.filter().falsePositiveRate());
+    if (passed != 0) { MSG("\tWARNING: Filtered results differ from the linear scan!"); }
+}
+
+/// @brief Perfect hash build time, query time, and memory for a frozen scored list.
+void benchPerfectHash(const size_t &listSize, const size_t &queryCount) {
+    std::mt19937 rng(7);
+    VKeyedList_t<uint32_t> scored;
+    for (size_t i = 0; i < listSize; ++i) { scored.add(VKey_t(1 + i % 100), uint32_t(i * 2654435761u)); }
+    std::vector<uint32_t> queries(queryCount);
+    std::uniform_int_distribution<size_t> pick(0, listSize - 1);
+    for (auto &q : queries) { q = uint32_t(pick(rng) * 2654435761u); }
+
+    auto start = benchClock::now();
+    VPerfectHash_t<uint32_t> index(scored);
+    std::chrono::duration<double, std::milli> buildMs = benchClock::now() - start;
+    std::vector<VReturn_t> out(queries.size());
+    double hashNs = timePerCall(queries.size(), [&](size_t i) { out[i] = index(queries[i]); });
+    size_t mismatches = 0;
+    for (size_t i = 0; i < queries.size(); ++i) { mismatches += out[i]() != scored(queries[i])(); }
+
+    MSG("Perfect hash (" << listSize << " entries, " << queryCount << " queries, all hits):");
+    MSG("\tBuild:             " << buildMs.count() << " ms");
+    MSG("\tQuery:             " << hashNs << " ns/query");
+    MSG("\tData memory:       " << index.dataBytes() << " bytes");
+    MSG("\tIndex memory:      " << index.indexBytes() << " bytes (" << double(index.indexBytes() * 8) / index.size() << " bits/key)");
+    if (mismatches != 0) { MSG("\tWARNING: " << mismatches << " results differ from the linear scan!"); }
+}
+
+/// @brief Compact key column memory and scan time for a mostly WHITELIST list.
+void benchCompactList(const size_t &listSize, const size_t &queryCount) {
+    std::mt19937 rng(11);
+    VKeyedList_t<uint32_t> mixed;
+    for (size_t i = 0; i < listSize; ++i) { mixed.add((rng() % 100 == 0) ? VKey_t::BLACKLIST : VKey_t::WHITELIST, uint32_t(rng())); }
+    VCompactKeyedList_t<uint32_t> compact(mixed);
+    std::vector<uint32_t> queries = makeQueries(queryCount, listSize, 0.5, rng);
+
+    size_t mismatches = 0;
+    double scanNs    = timePerCall(queries.size(), [&](size_t i) { mismatches += mixed.query(queries[i])();   });
+    double compactNs = timePerCall(queries.size(), [&](size_t i) { mismatches -= compact.query(queries[i])(); });
+    size_t rowBytes = mixed.size() * sizeof(VKeyedData_t<uint32_t>);
+
+    MSG("Compact key column (" << listSize << " entries, 99% WHITELIST):");
+    MSG("\tRow storage:       " << rowBytes << " bytes, " << scanNs << " ns/query");
+    MSG("\tColumn storage:    " << compact.dataBytes() + compact.keyBytes() << " bytes (keys: " << compact.keyBytes()
+        << "), " << compactNs << " ns/query");
+    if (mismatches != 0) { MSG("\tWARNING: Compact results differ from the linear scan!"); }
+}
+
+/// @brief Best score over 48 float bands: a `VRange_t` loop against one `VRangeSet_t` pass.
+void benchRangeSet(const size_t &queryCount) {
+    std::mt19937 rng(13);
+    std::uniform_real_distribution<float> value(-100.0f, 100.0f);
+    std::vector<VRange_t<float>> bands;
+    std::vector<VReturn_t> scores;
+    for (size_t i = 0; i < 48; ++i) {
+        float a = value(rng), b = value(rng);
+        bands.emplace_back(a, b); scores.push_back(VReturn_t(1 + i)); }
+    VRangeSet_t<float> set(bands, scores);
+    std::vector<float> queries(queryCount);
+    for (auto &q : queries) { q = value(rng); }
+
+    size_t mismatches = 0;
+    double loopNs = timePerCall(queries.size(), [&](size_t i) {
+        VReturn_t best = VReturn_t::FAIL;
+        for (size_t r = 0; r < bands.size(); ++r) { if (bands[r](queries[i]) && (!best || scores[r] > best)) { best = scores[r]; }}
+        mismatches += best() != set(queries[i])(); });
+    std::vector<VReturn_t> out(queries.size());
+    double setNs = timePerCall(1, [&](size_t) { set.query(queries.data(), queries.size(), out.data()); }) / double(queries.size());
+
+    MSG("Range set (48 float bands, " << queryCount << " values):");
+    MSG("\tVRange_t loop:     " << loopNs << " ns/value (includes a set query for checking)");
+    MSG("\tVRangeSet_t batch: " << setNs  << " ns/value");
+    if (mismatches != 0) { MSG("\tWARNING: " << mismatches << " range set results differ from VRange_t!"); }
+}
+
+/// @brief Scoring a float with a 64 point linear curve, against a plain membership check on the same values.
+void benchScoreCurve(const size_t &queryCount) {
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<float> value(0.0f, 100.0f);
+    std::vector<std::pair<float, VReturn_t>> points;
+    for (size_t i = 0; i < 64; ++i) { points.push_back({value(rng), VReturn_t(1 + rng() % 1000)}); }
+    VScoreCurve_t<float> curve(points, VCurve_t::LINEAR);
+    VKeyedList_t<float> scored;
+    scored.setCurve(curve);
+    VKeyedList_t<float> member(VKey_t::BLACKLIST, value(rng));
+    std::vector<float> queries(queryCount);
+    for (auto &q : queries) { q = value(rng); }
+
+    size_t mismatches = 0, passed = 0;
+    std::vector<VReturn_t> out(queries.size());
+    double memberNs = timePerCall(queries.size(), [&](size_t i) { passed += member(queries[i])() == VReturn_t::PASS; });
+    double listNs   = timePerCall(queries.size(), [&](size_t i) { out[i] = scored(queries[i]); });
+    double curveNs  = timePerCall(queries.size(), [&](size_t i) { mismatches += curve(queries[i])() != out[i](); });
+    std::vector<VReturn_t> batch(queries.size());
+    double batchNs  = timePerCall(1, [&](size_t) { curve.query(queries.data(), queries.size(), batch.data()); }) / double(queries.size());
+    for (size_t i = 0; i < queries.size(); ++i) { mismatches += batch[i]() != out[i](); }
+
+    MSG("Score curve (64 breakpoints, " << queryCount << " float values):");
+    MSG("\tMembership check:  " << memberNs << " ns/value (1 entry blacklist, " << passed << " passed)");
+    MSG("\tKeyed list curve:  " << listNs   << " ns/value");
+    MSG("\tCurve query:       " << curveNs  << " ns/value (includes checking)");
+    MSG("\tCurve batch:       " << batchNs  << " ns/value");
+    if (mismatches != 0) { MSG("\tWARNING: " << mismatches << " curve results differ!"); }
+}
+
+/// @brief Float matching within 0.001: an epsilon scan of the list against the sorted tolerance index.
+void benchTolerance(const size_t &listSize, const size_t &queryCount) {
+    std::mt19937 rng(37);
+    std::uniform_real_distribution<float> value(0.0f, 1000.0f), noise(-0.0015f, 0.0015f);
+    VKeyedList_t<float> readings;
+    for (size_t i = 0; i < listSize; ++i) { readings.add(VKey_t(1 + rng() % 100), value(rng)); }
+    std::vector<float> queries(queryCount);
+    for (auto &q : queries) { q = readings.getList()[rng() % listSize].getCData() + noise(rng); }
+
+    auto start = benchClock::now();
+    VToleranceIndex_t<float> index(readings, VTolerance_t::ABSOLUTE, 0.001, VPrecedence_t::LEFT);
+    std::chrono::duration<double, std::milli> buildMs = benchClock::now() - start;
+    size_t mismatches = 0;
+    // What a tolerant list query costs without an index: every entry, first nearest within 0.001 wins
+    double scanNs = timePerCall(std::min<size_t>(queryCount, 200), [&](size_t i) {
+        float best = INFINITY; VReturn_t result = readings.fallback();
+        for (const auto &kd : readings.getList()) {
+            const float d = std::abs(kd.getCData() - queries[i]);
+            if (d <= 0.001f && d < best) { best = d; result = -kd; }}
+        mismatches += result() != index.query(queries[i])(); });
+    size_t hits = 0;
+    double indexNs = timePerCall(queries.size(), [&](size_t i) { hits += index.nearest(queries[i]) != index.NPOS; });
+    std::vector<VReturn_t> out(queries.size());
+    double batchNs = timePerCall(1, [&](size_t) { index.query(queries.data(), queries.size(), out.data()); }) / double(queries.size());
+
+    MSG("Float tolerance (" << listSize << " entries, +/-0.001, " << queryCount << " queries, " << hits << " within tolerance):");
+    MSG("\tEpsilon scan:      " << scanNs  << " ns/query");
+    MSG("\tBuild:             " << buildMs.count() << " ms, " << index.memoryBytes() << " bytes");
+    MSG("\tIndex:             " << indexNs << " ns/query");
+    MSG("\tIndex batch:       " << batchNs << " ns/query");
+    if (mismatches != 0) { MSG("\tWARNING: " << mismatches << " results differ from the scan!"); }
+}
+
+/// @brief Tenants that share most values: a perfect hash per tenant against one shared tenant index, probing 8 tenants
+/// per query.
+void benchTenants(const size_t &numTenants, const size_t &valueCount, const size_t &queryCount) {
+    std::mt19937 rng(47);
+    std::vector<VKey_t> baseKeys(valueCount);
+    for (auto &k : baseKeys) { k = VKey_t(1 + rng() % 100); }
+    // Each tenant keeps 97% of the shared values as they are, rekeys 2%, drops 1%, and adds 1% of its own
+    std::vector<VKeyedList_t<uint32_t>> lists(numTenants);
+    for (size_t t = 0; t < numTenants; ++t) {
+        for (uint32_t v = 0; v < valueCount; ++v) {
+            const uint32_t r = rng() % 100;
+            if (r < 97) { lists[t].add(baseKeys[v], v); }
+            else if (r < 99) { lists[t].add(VKey_t(101 + rng() % 100), v); }}
+        for (size_t i = 0; i < valueCount / 100; ++i) { lists[t].add(VKey_t(1 + rng() % 100), uint32_t(valueCount + rng() % valueCount)); }}
+    std::vector<uint32_t> queries(queryCount);
+    for (auto &q : queries) { q = rng() % (valueCount * 2); }
+    std::vector<size_t> probed(queryCount * 8);
+    for (auto &t : probed) { t = rng() % numTenants; }
+
+    auto start = benchClock::now();
+    std::vector<VPerfectHash_t<uint32_t>> hashes;
+    size_t hashBytes = 0;
+    for (const auto &l : lists) { hashes.emplace_back(l, 1); hashBytes += hashes.back().indexBytes() + hashes.back().dataBytes(); }
+    std::chrono::duration<double, std::milli> hashMs = benchClock::now() - start;
+    start = benchClock::now();
+    VTenantIndex_t<uint32_t> index(lists, 1);
+    std::chrono::duration<double, std::milli> indexMs = benchClock::now() - start;
+
+    std::vector<VReturn_t> a(8), b(8), all(numTenants);
+    size_t mismatches = 0;
+    double hashNs = timePerCall(queries.size(), [&](size_t i) {
+        for (size_t j = 0; j < 8; ++j) { a[j] = hashes[probed[i * 8 + j]].query(queries[i]); }});
+    double indexNs = timePerCall(queries.size(), [&](size_t i) { index.query(probed.data() + i * 8, 8, queries[i], b.data()); });
+    for (size_t i = 0; i < queries.size(); ++i) {
+        index.query(probed.data() + i * 8, 8, queries[i], b.data());
+        for (size_t j = 0; j < 8; ++j) { mismatches += b[j]() != hashes[probed[i * 8 + j]].query(queries[i])(); }}
+    double allNs = timePerCall(queries.size() / 10, [&](size_t i) { index.queryAll(queries[i], all.data()); });
+
+    MSG("Tenant index (" << numTenants << " tenants x " << valueCount << " values, " << index.size() << " distinct, "
+        << index.numOverrides() << " overrides, 8 tenants per query):");
+    MSG("\tPer tenant hashes: " << hashMs.count()  << " ms, " << hashBytes << " bytes, " << hashNs << " ns/query");
+    MSG("\tTenant index:      " << indexMs.count() << " ms, " << index.memoryBytes() << " bytes, " << indexNs << " ns/query");
+    MSG("\tAll tenants:       " << allNs << " ns/query");
+    if (mismatches != 0) { MSG("\tWARNING: " << mismatches << " tenant results differ from the per tenant hashes!"); }
+}
+
+/// @brief Makes `count` sorted, distinct IDs in dense runs with scattered IDs between them.
+std::vector<uint32_t> makeClusteredIds(const size_t &count, std::mt19937 &rng) {
+    std::vector<uint32_t> ids;
+    ids.reserve(count);
+    for (uint32_t next = rng() % 1000; ids.size() < count;) {
+        if (rng() % 10 == 0) { ids.push_back(next); next += 1 + rng() % 5000; continue; }
+        for (uint32_t i = 0, len = 1 + rng() % 5000; i < len && ids.size() < count; ++i) { ids.push_back(next++); }
+        next += 1 + rng() % 20000; }
+    return ids;
+}
+
+/// @brief Large clustered ID blacklists: the plain list, a perfect hash, and Roaring containers, then composing two lists.
+void benchRoaring(const size_t &idCount, const size_t &queryCount) {
+    std::mt19937 rng(53);
+    const std::vector<uint32_t> ids = makeClusteredIds(idCount, rng), otherIds = makeClusteredIds(idCount, rng);
+    VKeyedList_t<uint32_t> list(VKey_t::BLACKLIST, ids), other(VKey_t::BLACKLIST, otherIds);
+    std::vector<uint32_t> queries(queryCount);
+    for (auto &q : queries) { q = (rng() % 2) ? ids[rng() % ids.size()] : uint32_t(rng() % (ids.back() + 1)); }
+    std::vector<uint32_t> sorted(queries);
+    std::sort(sorted.begin(), sorted.end());
+
+    auto start = benchClock::now();
+    VPerfectHash_t<uint32_t> index(list);
+    std::chrono::duration<double, std::milli> hashMs = benchClock::now() - start;
+    start = benchClock::now();
+    VRoaringKeyedList_t<uint32_t> roaring(list);
+    std::chrono::duration<double, std::milli> roaringMs = benchClock::now() - start;
+    const VRoaringKeyedList_t<uint32_t> roaringOther(other);
+
+    size_t mismatches = 0;
+    std::vector<VReturn_t> out(queries.size());
+    double hashNs    = timePerCall(queries.size(), [&](size_t i) { out[i] = index.query(queries[i]); });
+    double singleNs  = timePerCall(queries.size(), [&](size_t i) { mismatches += roaring.query(queries[i])() != out[i](); });
+    double batchNs   = timePerCall(1, [&](size_t) { roaring.query(queries.data(), queries.size(), out.data()); }) / double(queries.size());
+    double sortedNs  = timePerCall(1, [&](size_t) { roaring.query(sorted.data(), sorted.size(), out.data()); }) / double(sorted.size());
+    VRoaringKeyedList_t<uint32_t> unioned, intersected;
+    double unionMs     = timePerCall(1, [&](size_t) { unioned     = unionOf(roaring, roaringOther); }) / 1e6;
+    double intersectMs = timePerCall(1, [&](size_t) { intersected = intersectionOf(roaring, roaringOther); }) / 1e6;
+    VKeyedList_t<uint32_t> listUnion;
+    double listUnionMs = timePerCall(1, [&](size_t) { listUnion = unionOf(list, other); }) / 1e6;
+    if (listUnion.size() != unioned.size()) { ++mismatches; }
+    const VRoaringSet_t<uint32_t> &set = roaring.blacklist();
+
+    MSG("Clustered ID blacklist (" << ids.size() << " IDs, " << set.numContainers(VContainer_t::ARRAY) << " array / "
+        << set.numContainers(VContainer_t::BITMAP) << " bitmap / " << set.numContainers(VContainer_t::RUNS) << " run containers):");
+    MSG("\tKeyed list:        " << list.size() * sizeof(VKeyedData_t<uint32_t>) << " bytes");
+    MSG("\tPerfect hash:      " << hashMs.count() << " ms, " << index.indexBytes() + index.dataBytes() << " bytes, " << hashNs << " ns/query");
+    MSG("\tRoaring:           " << roaringMs.count() << " ms, " << roaring.memoryBytes() << " bytes, " << singleNs << " ns/query");
+    MSG("\tRoaring batch:     " << batchNs << " ns/query, sorted: " << sortedNs << " ns/query");
+    MSG("\tUnion:             " << unionMs << " ms (keyed list: " << listUnionMs << " ms), " << unioned.size() << " IDs");
+    MSG("\tIntersection:      " << intersectMs << " ms, " << intersected.size() << " IDs");
+    if (mismatches != 0) { MSG("\tWARNING: " << mismatches << " Roaring results differ from the perfect hash!"); }
+}
+
+/// @brief Bytes per component for one BLACKLIST id list in every storage backend, before and after `shrinkToFit`.
+void benchMemory(const size_t &listSize) {
+    VKeyedList_t<uint32_t> list;
+    for (size_t i = 0; i < listSize; ++i) { list -= uint32_t(i * 3); } // Grown one entry at a time
+    auto row = [&](const VMemoryUsage_t &usage) {
+        MSG("\t" << std::left << std::setw(19) << (std::string(storageName(usage.storage)) + ":") << std::right
+            << std::setw(10) << usage.total() << " bytes (" << double(usage.total()) / listSize << " bytes/entry, data: "
+            << usage.data << ", keys: " << usage.keys << ", padding: " << usage.padding << ", index: " << usage.index
+            << ", filter: " << usage.filter << ", slack: " << usage.slack << ")"); };
+
+    MSG("Memory usage (" << listSize << " BLACKLIST entries):");
+    row(list.memoryUsage());
+    const size_t released = list.shrinkToFit();
+    row(list.memoryUsage());
+    MSG("\t" << std::left << std::setw(19) << "shrinkToFit:" << std::right << std::setw(10) << released << " bytes released");
+    list.compile(10.0);
+    row(list.memoryUsage());
+    row(VPerfectHash_t<uint32_t>(list).memoryUsage());
+    row(VCompactKeyedList_t<uint32_t>(list).memoryUsage());
+    row(VRoaringKeyedList_t<uint32_t>(list).memoryUsage());
+}
+
+/// @brief Composing a global blacklist with tenant overrides: `+=` against a deduplicated `overrideOf`.
+void benchMerge(const size_t &listSize, const size_t &queryCount) {
+    std::mt19937 rng(19);
+    VKeyedList_t<uint32_t> global, tenant;
+    for (size_t i = 0; i < listSize; ++i) { global.add(VKey_t::BLACKLIST, uint32_t(rng() % listSize)); }
+    for (size_t i = 0; i < listSize / 10; ++i) { tenant.add(VKey_t(1 + rng() % 100), uint32_t(rng() % listSize)); }
+    std::vector<uint32_t> queries = makeQueries(queryCount, listSize, 0.5, rng);
+
+    // In place, so only the append and the merge are timed. Same as `overrideOf(global, tenant)`
+    VKeyedList_t<uint32_t> appended(tenant), merged(global);
+    double appendMs = timePerCall(1, [&](size_t) { appended += global; }) / 1e6;
+    double mergeMs  = timePerCall(1, [&](size_t) { merged.merge(tenant, VSetOp_t::UNION, VPrecedence_t::RIGHT); }) / 1e6;
+    std::vector<VReturn_t> appendOut(queries.size()), mergeOut(queries.size());
+    double appendNs = timePerCall(queries.size(), [&](size_t i) { appendOut[i] = appended.query(queries[i]); });
+    double mergeNs  = timePerCall(queries.size(), [&](size_t i) { mergeOut[i]  = merged.query(queries[i]);   });
+    size_t mismatches = 0;
+    for (size_t i = 0; i < queries.size(); ++i) { mismatches += appendOut[i]() != mergeOut[i](); }
+
+    MSG("Rule set merge (" << global.size() << " blacklist + " << tenant.size() << " overrides):");
+    MSG("\tAppend (+=):       " << appendMs << " ms, " << appended.size() << " entries, " << appendNs << " ns/query");
+    MSG("\toverrideOf:        " << mergeMs  << " ms, " << merged.size()   << " entries, " << mergeNs  << " ns/query");
+    if (mismatches != 0) { MSG("\tWARNING: " << mismatches << " merged results differ from the appended list!"); }
+}
+
+/// @brief Scoring a large batch into full width results, compact columns, and a fused reduction.
+void benchResultColumns(const size_t &valueCount) {
+    std::mt19937 rng(29);
+    std::uniform_real_distribution<float> value(0.0f, 100.0f);
+    std::vector<std::pair<float, VReturn_t>> points;
+    for (size_t i = 0; i < 16; ++i) { points.push_back({10.0f + 5.0f * float(i), VReturn_t(1 + rng() % 1000)}); }
+    VScoreCurve_t<float> curve(points, VCurve_t::LINEAR);
+    std::vector<float> values(valueCount);
+    for (auto &v : values) { v = value(rng); }
+
+    std::vector<VReturn_t> full(valueCount);
+    VPassMask_t mask; VClassColumn_t classes; VScoreColumn_t scores;
+    size_t fullPassing = 0;
+    double fullNs   = timePerCall(1, [&](size_t) {
+        curve.query(values.data(), valueCount, full.data());
+        for (const auto &r : full) { fullPassing += bool(r); }}) / double(valueCount);
+    double maskNs   = timePerCall(1, [&](size_t) { queryColumn(curve, values.data(), valueCount, mask);    }) / double(valueCount);
+    double classNs  = timePerCall(1, [&](size_t) { queryColumn(curve, values.data(), valueCount, classes); }) / double(valueCount);
+    double scoreNs  = timePerCall(1, [&](size_t) { queryColumn(curve, values.data(), valueCount, scores);  }) / double(valueCount);
+    VResultSummary_t summary;
+    double fusedNs  = timePerCall(1, [&](size_t) { summary = summarize(curve, values.data(), valueCount); }) / double(valueCount);
+
+    MSG("Batch result columns (" << valueCount << " float values, 16 breakpoint curve, " << summary.passing << " passing):");
+    MSG("\tVReturn_t array:   " << fullNs  << " ns/value, " << full.size() * sizeof(VReturn_t) << " bytes");
+    MSG("\tPass mask:         " << maskNs  << " ns/value, " << mask.memoryBytes()    << " bytes");
+    MSG("\tClass column:      " << classNs << " ns/value, " << classes.memoryBytes() << " bytes");
+    MSG("\tScore16 column:    " << scoreNs << " ns/value, " << scores.memoryBytes()  << " bytes");
+    MSG("\tFused summarize:   " << fusedNs << " ns/value, 0 bytes (best " << summary.bestResult << " at " << summary.best << ")");
+    if (mask.countPassing() != fullPassing || classes.countPassing() != fullPassing || scores.countPassing() != fullPassing ||
+        summary.passing != fullPassing) { MSG("\tWARNING: Column pass counts differ from the full results!"); }
+}
+
+/// @brief `a whitelisted AND (b in range OR c not blacklisted)`: a tree of `std::function` nodes against the compiled
+/// expression, one candidate at a time and in batches.
+void benchExpression(const size_t &listSize, const size_t &candidateCount) {
+    struct Candidate_t { uint32_t a, b, c; };
+    std::mt19937 rng(31);
+    VKeyedList_t<uint32_t> whiteEntries, blackEntries;
+    for (size_t i = 0; i < listSize; ++i) { whiteEntries.add(VKey_t::WHITELIST, uint32_t(rng() % (2 * listSize))); }
+    for (size_t i = 0; i < listSize; ++i) { blackEntries.add(VKey_t::BLACKLIST, uint32_t(rng() % (2 * listSize))); }
+    VPerfectHash_t<uint32_t> whitelist(whiteEntries), blacklist(blackEntries);
+    VRangeSet_t<uint32_t> range({VRange_t<uint32_t>(0, uint32_t(listSize / 2)), VRange_t<uint32_t>(uint32_t(listSize), uint32_t(listSize * 3 / 2))});
+    std::vector<Candidate_t> candidates(candidateCount);
+    for (auto &c : candidates) { c = {uint32_t(rng() % (2 * listSize)), uint32_t(rng() % (2 * listSize)), uint32_t(rng() % (2 * listSize))}; }
+
+    using Fn_t = std::function<VReturn_t(const Candidate_t&)>;
+    auto both   = [](Fn_t l, Fn_t r) -> Fn_t { return [l, r](const Candidate_t &c) { VReturn_t x = l(c); return x() == VReturn_t::FAIL ? x : x + r(c); }; };
+    auto either = [](Fn_t l, Fn_t r) -> Fn_t { return [l, r](const Candidate_t &c) { VReturn_t x = l(c); return x() != VReturn_t::FAIL ? x : r(c); }; };
+    Fn_t tree = both([&](const Candidate_t &c) { return whitelist.query(c.a); },
+                     either([&](const Candidate_t &c) { return range.query(c.b); }, [&](const Candidate_t &c) { return blacklist.query(c.c); }));
+
+    VExpression_t<Candidate_t> expr;
+    auto inWhitelist = expr.leaf(whitelist, [](const Candidate_t &c) { return c.a; });
+    auto inRange     = expr.leaf(range,     [](const Candidate_t &c) { return c.b; });
+    auto notBlocked  = expr.leaf(blacklist, [](const Candidate_t &c) { return c.c; });
+    expr.compile(inWhitelist && (inRange || notBlocked));
+
+    std::vector<VReturn_t> out(candidateCount);
+    size_t treePassing = 0, exprPassing = 0, batchPassing = 0;
+    double treeNs  = timePerCall(candidateCount, [&](size_t i) { treePassing += tree(candidates[i])() != VReturn_t::FAIL; });
+    double exprNs  = timePerCall(candidateCount, [&](size_t i) { exprPassing += expr(candidates[i])() != VReturn_t::FAIL; });
+    double batchNs = timePerCall(1, [&](size_t) { expr.validate(candidates.data(), candidateCount, out.data()); }) / double(candidateCount);
+    for (const auto &r : out) { batchPassing += r() != VReturn_t::FAIL; }
+
+    MSG("Rule expression (" << candidateCount << " candidates, 2 perfect hashes of " << listSize << ", " << exprPassing << " passing):");
+    MSG("\tstd::function tree: " << treeNs  << " ns/candidate");
+    MSG("\tCompiled program:  " << exprNs  << " ns/candidate, " << expr.programSize() << " program nodes");
+    MSG("\tBatch:             " << batchNs << " ns/candidate");
+    if (treePassing != exprPassing || batchPassing != exprPassing) { MSG("\tWARNING: Expression results differ from the tree!"); }
+}
+
+/// @brief Top 10 of a large candidate set with a 2 ms budget: a complete pass against deadline ranking in list order and
+/// in priority order.
+void benchDeadline(const size_t &candidateCount) {
+    std::mt19937 rng(43);
+    Validator<uint32_t> validator;
+    for (uint32_t v = 0; v < 64; ++v) { validator.add(VKey_t(1 + rng() % 10000), v); }
+    std::vector<uint32_t> candidates(candidateCount);
+    for (auto &c : candidates) { c = rng() % 6400000; } // About 1 in 100000 is on the list
+    // A cheap model's guess at each score, computed ahead of the request
+    std::vector<double> hints(candidateCount);
+    for (size_t i = 0; i < candidateCount; ++i) {
+        hints[i] = double(resultRank(validator(candidates[i]))) * (0.5 + std::uniform_real_distribution<double>(0.0, 1.0)(rng)); }
+    const std::vector<size_t> order = VRanking_t::priorityOrder(hints.data(), hints.size());
+
+    VRanking_t full, inOrder, byPriority;
+    double fullMs     = timePerCall(1, [&](size_t) { full       = validator.rank(candidates, 10, VDeadline_t::never()); }) / 1e6;
+    double inOrderMs  = timePerCall(1, [&](size_t) { inOrder    = validator.rank(candidates, 10, std::chrono::milliseconds(2)); }) / 1e6;
+    double priorityMs = timePerCall(1, [&](size_t) { byPriority = validator.rank(candidates, 10, std::chrono::milliseconds(2), order); }) / 1e6;
+    auto found = [&](const VRanking_t &r) {
+        size_t n = 0;
+        for (size_t i = 0; i < std::min(r.size(), full.size()); ++i) { n += r.results[i]() == full.results[i](); }
+        return n; };
+    auto row = [&](const char *name, const double &ms, const VRanking_t &r) {
+        MSG("\t" << name << ms << " ms, " << r.evaluated << " scored" << (r.partial ? " (partial)" : "") << ", "
+            << found(r) << "/" << full.size() << " top scores found"); };
+
+    MSG("Deadline ranking (" << candidateCount << " candidates, 64 entry list, top 10, 2 ms budget):");
+    row("Complete pass:     ", fullMs,     full);
+    row("Deadline:          ", inOrderMs,  inOrder);
+    row("Deadline priority: ", priorityMs, byPriority);
+}
+
+/// @brief Re-ranking a scored candidate pool after a few rule edits: a full rescore against an incremental update.
+void benchIncremental(const size_t &candidateCount, const size_t &edits) {
+    std::mt19937 rng(47);
+    const uint32_t domain = 100000;
+    VKeyedList_t<uint32_t> color, size;
+    for (uint32_t v = 0; v < 2000; ++v) { color.add(VKey_t(1 + rng() % 1000), rng() % domain); size.add(VKey_t(1 + rng() % 1000), rng() % domain); }
+    color.add(VKey_t::BLACKLIST, domain / 2);
+    std::vector<std::vector<uint32_t>> candidates(candidateCount);
+    for (auto &c : candidates) { c = {uint32_t(rng() % domain), uint32_t(rng() % domain)}; }
+
+    VIncrementalRanking_t<uint32_t> ranking;
+    double buildMs = timePerCall(1, [&](size_t) { ranking = VIncrementalRanking_t<uint32_t>({&color, &size}, candidates, 10); }) / 1e6;
+    // Edit values held by ranked candidates, so the top 10 changes
+    std::vector<uint32_t> values;
+    const VRanking_t before = ranking.ranking();
+    for (size_t e = 0; e < edits; ++e) {
+        const uint32_t value = candidates[before.indices[e % before.size()]][0] + uint32_t(e / before.size());
+        values.push_back(value);
+        if (e % 2) { color.remove(value); } else { color.rekey(value, VKey_t(1 + rng() % 2000)); }}
+    size_t rescored = 0;
+    double updateMs = timePerCall(1, [&](size_t) { rescored = ranking.update(0, values); }) / 1e6;
+    VIncrementalRanking_t<uint32_t> fresh;
+    double fullMs = timePerCall(1, [&](size_t) { fresh = VIncrementalRanking_t<uint32_t>({&color, &size}, candidates, 10); }) / 1e6;
+
+    const VRanking_t a = ranking.ranking(), b = fresh.ranking();
+    MSG("Incremental ranking (" << candidateCount << " candidates, 2 traits, " << edits << " edited values, top 10):");
+    MSG("\tBuild:             " << buildMs  << " ms");
+    MSG("\tFull rescore:      " << fullMs   << " ms");
+    MSG("\tIncremental:       " << updateMs << " ms, " << rescored << " candidates rescored");
+    if (a.indices != b.indices) { MSG("\tWARNING: Incremental top 10 differs from the full rescore!"); }
+}
+
+#if defined(V_ASYNC)
+/// @brief Stand in for a remote store: every batch completes `latency` after it was sent, on an I/O thread, however many
+/// batches are in flight. Values are a fixed function of the key.
+class SimulatedSource_t : public VAsyncSource_t<uint32_t, uint32_t> {
+    public:
+    SimulatedSource_t(VAsyncScheduler_t &scheduler, const size_t &maxBatch, const std::chrono::microseconds &latency)
+        : VAsyncSource_t(scheduler, maxBatch), latency_(latency), io_([this] { _serve(); }) {}
+    ~SimulatedSource_t() {
+        { std::lock_guard<std::mutex> lock(mutex_); stop_ = true; }
+        wake_.notify_one(); io_.join(); }
+    /// @brief The stored value for a key.
+    static uint32_t lookup(const uint32_t &key) { return (key * 2654435761u) % 1000; }
+
+    protected:
+    void fetchBatch(const uint32_t *keys, const size_t &count, uint32_t *values, std::function<void()> done) override {
+        { std::lock_guard<std::mutex> lock(mutex_); queue_.push_back({benchClock::now() + latency_, keys, count, values, std::move(done)}); }
+        wake_.notify_one(); }
+
+    private:
+    struct Request_t { benchClock::time_point due; const uint32_t *keys; size_t count; uint32_t *values; std::function<void()> done; };
+    std::chrono::microseconds latency_;
+    std::deque<Request_t> queue_{}; // Due in order, since the latency is fixed
+    std::mutex mutex_{};
+    std::condition_variable wake_{};
+    bool stop_ = false;
+    std::thread io_;
+
+    void _serve() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+            if (queue_.empty()) return;
+            Request_t r = std::move(queue_.front());
+            queue_.pop_front();
+            lock.unlock();
+            std::this_thread::sleep_until(r.due);
+            for (size_t i = 0; i < r.count; ++i) { r.values[i] = lookup(r.keys[i]); }
+            r.done();
+            lock.lock(); }}
+};
+
+/// @brief Validating values fetched from a store with a fixed round trip: blocking threads against coroutines on one
+/// thread with batched lookups.
+void benchAsync(const size_t &lookupCount, const std::chrono::microseconds &latency) {
+    std::mt19937 rng(53);
+    Validator<uint32_t> validator;
+    for (uint32_t v = 0; v < 1000; v += 3) { validator.add(VKey_t(1 + rng() % 100), v); }
+    std::vector<uint32_t> keys(lookupCount);
+    for (auto &k : keys) { k = uint32_t(rng()); }
+    const size_t numThreads = 16;
+
+    // Blocking: every thread waits out one round trip per lookup, then validates
+    std::vector<VReturn_t> blocking(lookupCount);
+    auto start = benchClock::now();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (size_t i = t; i < lookupCount; i += numThreads) {
+                std::this_thread::sleep_for(latency);
+                blocking[i] = validator.validate(SimulatedSource_t::lookup(keys[i])); }}); }
+    for (auto &thread : threads) { thread.join(); }
+    std::chrono::duration<double, std::milli> blockingMs = benchClock::now() - start;
+
+    // Async: one thread, lookups batched per source while other tasks are scored
+    VAsyncScheduler_t scheduler;
+    SimulatedSource_t source(scheduler, 256, latency);
+    std::vector<VTask_t<VReturn_t>> tasks;
+    tasks.reserve(lookupCount);
+    for (const auto &k : keys) { tasks.push_back(validator.validateAsync(source, k)); }
+    start = benchClock::now();
+    const std::vector<VReturn_t> async = scheduler.runAll(std::move(tasks), 4096);
+    std::chrono::duration<double, std::milli> asyncMs = benchClock::now() - start;
+    size_t mismatches = 0;
+    for (size_t i = 0; i < lookupCount; ++i) { mismatches += blocking[i]() != async[i](); }
+
+    MSG("Async validation (" << lookupCount << " lookups, " << latency.count() << " us round trip):");
+    MSG("\tBlocking, " << numThreads << " threads: " << blockingMs.count() << " ms, " << lookupCount / blockingMs.count() * 1e3 << " lookups/s");
+    MSG("\tCoroutines, 1 thread: " << asyncMs.count() << " ms, " << lookupCount / asyncMs.count() * 1e3 << " lookups/s, "
+        << source.batches() << " batches");
+    if (mismatches != 0) { MSG("\tWARNING: " << mismatches << " async results differ from the blocking path!"); }
+}
+#endif
+
+/// @brief Single value queries from many threads: direct calls against the coalescing batcher.
+void benchBatcher(const size_t &listSize, const size_t &queryCount) {
+    std::mt19937 rng(19);
+    std::vector<uint32_t> values(listSize);
+    for (size_t i = 0; i < listSize; ++i) { values[i] = uint32_t(i); }
+    Validator<uint32_t> validator(VKey_t::BLACKLIST, values);
+    std::vector<uint32_t> queries = makeQueries(queryCount, listSize, 0.5, rng);
+    const size_t numThreads = 64;
+
+    // Every thread queries its share of the values. Returns ns per query over all threads
+    auto runThreads = [&](auto &&fn) {
+        std::vector<std::thread> threads;
+        auto start = benchClock::now();
+        for (size_t t = 0; t < numThreads; ++t) {
+            threads.emplace_back([&, t] { for (size_t i = t; i < queries.size(); i += numThreads) { fn(i); }}); }
+        for (auto &thread : threads) { thread.join(); }
+        std::chrono::duration<double, std::nano> elapsed = benchClock::now() - start;
+        return elapsed.count() / double(queries.size()); };
+
+    std::vector<VReturn_t> direct(queries.size()), batched(queries.size());
+    double directNs = runThreads([&](size_t i) { direct[i] = validator.validate(queries[i]); });
+    VBatcher_t<uint32_t> batcher(validator, 64, 50);
+    double batchNs = runThreads([&](size_t i) { batched[i] = batcher.validate(queries[i]); });
+    double batchSize = batcher.averageBatchSize(), loadedWaitUs = batcher.averageWaitUs();
+    size_t mismatches = 0;
+    for (size_t i = 0; i < queries.size(); ++i) { mismatches += direct[i]() != batched[i](); }
+
+    // Light load: one caller at a time, so every query waits for the deadline
+    batcher.resetStats();
+    const size_t lightCount = std::min<size_t>(queries.size(), 200);
+    double lightNs = timePerCall(lightCount, [&](size_t i) { mismatches += batcher(queries[i])() != direct[i](); });
+    double lightDirectNs = timePerCall(lightCount, [&](size_t i) { mismatches -= validator(queries[i])() != direct[i](); });
+
+    MSG("Micro-batcher (" << listSize << " entries, " << queryCount << " queries, " << numThreads << " threads, 64 / 50 us):");
+    MSG("\tDirect calls:      " << directNs << " ns/query");
+    MSG("\tBatched:           " << batchNs  << " ns/query (" << batchSize << " queries/batch, " << loadedWaitUs << " us wait)");
+    MSG("\tLight load:        " << lightNs / 1000.0 << " us/query batched, " << lightDirectNs / 1000.0 << " us/query direct ("
+        << batcher.averageWaitUs() << " us wait)");
+    if (mismatches != 0) { MSG("\tWARNING: " << mismatches << " batched results differ from direct calls!"); }
+}
+
+/// @brief Perfect hash queries from a thread on node 0 against the node 0 replica and the last node's replica.
+void benchNumaReplicas(const size_t &listSize, const size_t &queryCount) {
+    std::mt19937 rng(23);
+    VKeyedList_t<uint32_t> scored;
+    for (size_t i = 0; i < listSize; ++i) { scored.add(VKey_t(1 + i % 100), uint32_t(i * 2654435761u)); }
+    std::vector<uint32_t> queries(queryCount);
+    std::uniform_int_distribution<size_t> pick(0, listSize - 1);
+    for (auto &q : queries) { q = uint32_t(pick(rng) * 2654435761u); }
+
+    const VNumaTopology_t &topology = VNumaTopology_t::get();
+    VReplicated_t<VPerfectHash_t<uint32_t>> replicated(scored);
+    size_t mismatches = 0;
+    double localNs = 0.0, remoteNs = 0.0;
+    std::thread([&] {
+        topology.bindThread(0);
+        auto local = replicated.handle(0), remote = replicated.handle(topology.numNodes() - 1);
+        for (size_t i = 0; i < queries.size(); ++i) { mismatches += local(queries[i])() != scored(queries[i])(); }
+        // Best of 3 alternating passes
+        localNs = remoteNs = 1e30;
+        for (size_t pass = 0; pass < 3; ++pass) {
+            localNs  = std::min(localNs,  timePerCall(queries.size(), [&](size_t i) { mismatches += !local(queries[i]); }));
+            remoteNs = std::min(remoteNs, timePerCall(queries.size(), [&](size_t i) { mismatches += !remote(queries[i]); })); }
+        // Republishing moves every handle to the new rule set
+        scored.add(VKey_t(7), 1u);
+        replicated.publish(scored);
+        mismatches += local(1u)() != 7 || remote(1u)() != 7; }).join();
+
+    MSG("NUMA replicas (" << listSize << " entries, " << topology.numNodes() << " node(s), " << replicated.numReplicas() << " replica(s)):");
+    MSG("\tLocal replica:     " << localNs  << " ns/query");
+    MSG("\tRemote replica:    " << remoteNs << " ns/query" << (topology.numNodes() == 1 ? " (single node, same memory)" : ""));
+    if (mismatches != 0) { MSG("\tWARNING: " << mismatches << " replica results differ from the linear scan!"); }
+}
+
+#if defined(V_SHARED_RULES)
+/// @brief Shared memory rule set: publish once, then attach like a new worker process would.
+void benchSharedRules(const size_t &listSize, const size_t &queryCount) {
+    std::mt19937 rng(29);
+    VKeyedList_t<uint32_t> whitelist;
+    std::uniform_int_distribution<uint32_t> any;
+    auto start = benchClock::now();
+    for (size_t i = 0; i < listSize; ++i) { whitelist.add(any(rng)); }
+    std::chrono::duration<double, std::milli> buildMs = benchClock::now() - start;
+    std::vector<uint32_t> queries(queryCount);
+    for (size_t i = 0; i < queryCount; ++i) { queries[i] = (i % 2) ? any(rng) : whitelist.getList()[rng() % listSize].getCData(); }
+
+    VSharedRules_t<uint32_t>::unlink("validator_bench");
+    start = benchClock::now();
+    VSharedRules_t<uint32_t>::publish("validator_bench", whitelist);
+    std::chrono::duration<double, std::milli> publishMs = benchClock::now() - start;
+    start = benchClock::now();
+    VSharedRules_t<uint32_t> shared("validator_bench");
+    std::chrono::duration<double, std::milli> attachMs = benchClock::now() - start;
+
+    size_t mismatches = 0, passed = 0;
+    for (size_t i = 0; i < std::min<size_t>(queryCount, 1000); ++i) { mismatches += shared(queries[i])() != whitelist(queries[i])(); }
+    double queryNs = timePerCall(queries.size(), [&](size_t i) { passed += !!shared(queries[i]); });
+    VSharedRules_t<uint32_t>::unlink("validator_bench");
+
+    MSG("Shared memory rules (" << listSize << " entries):");
+    MSG("\tPrivate list:      " << buildMs.count() << " ms to build, " << whitelist.size() * sizeof(VKeyedData_t<uint32_t>) << " bytes per process");
+    MSG("\tShared segment:    " << publishMs.count() << " ms to publish once, " << shared.mappedBytes() << " bytes per host");
+    MSG("\tNew worker attach: " << attachMs.count() << " ms");
+    MSG("\tQuery:             " << queryNs << " ns/query (" << passed << " passed)");
+    if (mismatches != 0) { MSG("\tWARNING: " << mismatches << " shared results differ from the linear scan!"); }
+}
+#endif
+
+/// @brief Hardware counters per query for every storage mode and several list sizes, to pick layouts from measurements.
+void benchCounters(const size_t &listSize, const size_t &queryCount) {
+    VPerfCounters_t counters;
+    if (!counters) { MSG("Hardware counters: unavailable (perf_event_open failed, see perf_event_paranoid). Wall clock only."); }
+    std::mt19937 rng(23);
+    for (size_t size = 1024; ; size = std::min(size * 64, listSize)) {
+        VKeyedList_t<uint32_t> list;
+        for (size_t i = 0; i < size; ++i) { list.add((rng() % 4 == 0) ? VKey_t::BLACKLIST : VKey_t(1 + rng() % 100), uint32_t(i)); }
+        VKeyedList_t<uint32_t> compiled(list);
+        compiled.compile(10.0);
+        VPerfectHash_t<uint32_t> index(list);
+        VCompactKeyedList_t<uint32_t> compact(list);
+        std::vector<uint32_t> queries = makeQueries(queryCount, size, 0.5, rng);
+        std::vector<VReturn_t> out(queries.size());
+        size_t sink = 0;
+
+        MSG("Hardware counters (" << size << " entries, " << queries.size() << " queries, 50% miss), per query:");
+        std::cout << "\t" << std::left << std::setw(19) << "Mode" << std::right << std::setw(10) << "ns";
+        for (size_t e = 0; e < NUM_PERF_EVENTS; ++e) { std::cout << std::setw(15) << perfEventName(e); }
+        std::cout << std::endl;
+        auto row = [&](const std::string &mode, auto &&fn) {
+            const double ns = timePerCall(queries.size(), fn);
+            const VPerfSample_t sample = counters.perCall(queries.size(), fn);
+            std::cout << "\t" << std::left << std::setw(19) << mode << std::right << std::setw(10) << std::fixed << std::setprecision(1) << ns;
+            for (size_t e = 0; e < NUM_PERF_EVENTS; ++e) {
+                if (sample.available[e]) { std::cout << std::setw(15) << sample.value[e]; }
+                else { std::cout << std::setw(15) << "n/a"; }}
+            std::cout << std::defaultfloat << std::endl; };
+        row("List scan",    [&](size_t i) { sink += list.query(queries[i])(); });
+        row("Bloom + scan", [&](size_t i) { sink += compiled.query(queries[i])(); });
+        row("Batch (64)",   [&](size_t i) { if (i % 64 == 0) { compiled.query(queries.data() + i, std::min<size_t>(64, queries.size() - i), out.data() + i); }});
+        row("Perfect hash", [&](size_t i) { sink += index.query(queries[i])(); });
+        row("Compact list", [&](size_t i) { sink += compact.query(queries[i])(); });
+#if defined(V_SHARED_RULES)
+        const int fd = VSharedRules_t<uint32_t>::publishFd(list);
+        VSharedRules_t<uint32_t> shared;
+        if (fd >= 0 && shared.attachFd(fd)) { row("Shared rules", [&](size_t i) { sink += shared.query(queries[i])(); }); }
+        if (fd >= 0) { close(fd); }
+#endif
+        if (sink == 1) { MSG(""); } // Keeps the queries from being optimized out
+        if (size >= listSize) break; }
+}
+
+int main(int argc, char **argv) {
+    size_t listSize   = (argc > 1) ? std::stoull(argv[1]) : 1000000;
+    size_t queryCount = (argc > 2) ? std::stoull(argv[2]) : 2000;
+
+    std::cout << "Starting Validator Benchmarks..." << std::endl;
+    benchBlacklistFilter(listSize, queryCount);
+    benchPerfectHash(listSize, queryCount);
+    benchCompactList(listSize, queryCount);
+    benchRangeSet(queryCount * 100);
+    benchScoreCurve(queryCount * 100);
+    benchTolerance(listSize, queryCount * 100);
+    benchMerge(listSize, queryCount);
+    benchTenants(100, listSize / 20, queryCount * 100);
+    benchRoaring(listSize * 10, queryCount * 100);
+    benchMemory(listSize);
+    benchResultColumns(queryCount * 5000);
+    benchExpression(listSize, queryCount * 100);
+    benchDeadline(queryCount * 500);
+    benchIncremental(listSize, 8);
+#if defined(V_ASYNC)
+    benchAsync(queryCount * 10, std::chrono::microseconds(200));
+#endif
+    benchBatcher(listSize, queryCount * 10);
+    benchNumaReplicas(listSize, queryCount * 100);
+#if defined(V_SHARED_RULES)
+    benchSharedRules(listSize, queryCount * 100);
+#endif
+    if (argc > 3 && std::string(argv[3]) == "perf") { benchCounters(listSize, queryCount); }
+    return 0;
+}
@@ -0,0 +1,824 @@
+/**
+ * @file tests/differential.cpp
+ * @author Ray Richter
+ * @note Differential test harness. Generates rule sets and queries, runs every query backend on them, and checks each
+ * result against an independent reference scan. Reports mismatches and per backend timings.
+ * Usage: `ValidatorDifferential [rounds] [seed]`. Exits with 1 on any mismatch.
+ * Build with `-DV_FUZZ -fsanitize=fuzzer` for a libFuzzer target instead of `main`.
+ */
+
+#include "../include/Validator.hpp"
+#include "../tools/protocol.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#if defined(V_SHARED_RULES)
+#include <sys/wait.h>
+#endif
+
+using Validspace::uint_t;
+using Validspace::VResponse_t;
+
+#define MSG(msg) std::cout << msg << std::endl
+
+using diffClock = std::chrono::steady_clock;
+
+/// @section Test Data Types
+
+/// @brief Ordered but not hashable. Exercises the scan and sorted merge paths.
+struct Point_t {
+    int32_t x = 0, y = 0;
+    bool operator==(const Point_t &o) const { return x == o.x && y == o.y; }
+    bool operator!=(const Point_t &o) const { return !(*this == o); }
+    bool operator< (const Point_t &o) const { return x < o.x || (x == o.x && y < o.y); }
+    bool operator> (const Point_t &o) const { return o < *this; }
+    bool operator<=(const Point_t &o) const { return !(o < *this); }
+    bool operator>=(const Point_t &o) const { return !(*this < o); }
+};
+
+/// @brief Equality only. Exercises the pairwise paths.
+struct Tag_t {
+    uint16_t id = 0;
+    bool operator==(const Tag_t &o) const { return id == o.id; }
+};
+
+/// @brief A candidate with three traits, for expressions.
+struct Row_t {
+    uint32_t a = 0, b = 0, c = 0;
+    bool operator==(const Row_t &o) const { return a == o.a && b == o.b && c == o.c; }
+};
+
+/// @section Generated Cases
+
+/// @brief Rule set shapes. The list mode flags depend on which keys were added.
+enum Profile_t : uint8_t { BLACKLIST_ONLY, WHITELIST_ONLY, MIXED, SPECIALS, NUM_PROFILES };
+
+/// @brief A generated rule set and its queries.
+template <class T> struct Case_t {
+    std::vector<VKeyedData_t<T>> rules{};  // In add order, range keys and NULL_KEY included
+    std::vector<T> queries{};
+    VScoreCurve_t<T> curve{};              // Set after the rules when not empty
+    std::vector<VKeyedData_t<T>> removed{}; // Rules taken out by `remove` or `rekey`. They still set the list mode
+};
+
+/// @brief Makes a value from `[0, domain)`, with edge values mixed in for floats.
+template <class T> T makeValue(std::mt19937 &rng, const uint32_t &domain) {
+    const uint32_t v = rng() % domain;
+    if constexpr (std::is_floating_point<T>::value) {
+        switch (rng() % 16) {
+        case 0:  return std::numeric_limits<T>::quiet_NaN();
+        case 1:  return T(-0.0);
+        case 2:  return T(0.0);
+        case 3:  return std::numeric_limits<T>::infinity();
+        case 4:  return T(v) + T(0.5);
+        default: return T(v); }}
+    else if constexpr (std::is_same<T, Point_t>::value) { return {int32_t(v % 7), int32_t(v / 7)}; }
+    else if constexpr (std::is_same<T, Tag_t>::value)   { return {uint16_t(v)}; }
+    else { return T(v); }
+}
+
+/// @brief Makes a key for a profile.
+VKey_t makeKey(std::mt19937 &rng, const Profile_t &profile) {
+    switch (profile) {
+    case BLACKLIST_ONLY: return VKey_t::BLACKLIST;
+    case WHITELIST_ONLY: return (rng() % 4) ? VKey_t(VKey_t::WHITELIST) : VKey_t(1 + rng() % 1000);
+    case MIXED: {
+        const uint32_t r = rng() % 8;
+        return (r < 3) ? VKey_t(VKey_t::BLACKLIST) : (r < 5) ? VKey_t(VKey_t::WHITELIST) : (r < 6) ? VKey_t(VKey_t::PERFECT) : VKey_t(1 + rng() % 1000); }
+    default: {
+        const uint_t specials[] = {VKey_t::NULL_KEY, VKey_t::MINIMUM, VKey_t::MAXIMUM, VKey_t::PERFECT, VKey_t::BLACKLIST,
+                                   VKey_t::WHITELIST, 1, VKey_t::MINIMUM - 1};
+        return specials[rng() % 8]; }}
+}
+
+/// @brief Generates a case. Sizes cover the batch block and hash join thresholds, and small domains force repeats.
+template <class T> Case_t<T> makeCase(std::mt19937 &rng) {
+    static const size_t sizes[] = {0, 1, 2, 7, 8, 9, 63, 64, 65, 200, 1500};
+    const size_t   size    = sizes[rng() % (sizeof(sizes) / sizeof(sizes[0]))];
+    const uint32_t domain  = (rng() % 2) ? uint32_t(std::max<size_t>(size / 2, 1)) : uint32_t(size * 4 + 16);
+    const Profile_t profile = Profile_t(rng() % NUM_PROFILES);
+    Case_t<T> c;
+    for (size_t i = 0; i < size; ++i) { c.rules.push_back({makeKey(rng, profile), makeValue<T>(rng, domain)}); }
+    // Queries: listed values, unlisted values, and repeats of both
+    const size_t numQueries = 1 + rng() % 300;
+    for (size_t i = 0; i < numQueries; ++i) {
+        if (!c.rules.empty() && rng() % 2) { c.queries.push_back(*c.rules[rng() % c.rules.size()].getPData()); }
+        else { c.queries.push_back(makeValue<T>(rng, domain * 2)); }}
+    if constexpr (std::is_arithmetic<T>::value) {
+        if (rng() % 4 == 0) {
+            std::vector<std::pair<T, VReturn_t>> points;
+            for (size_t i = 0, n = 1 + rng() % 6; i < n; ++i) { points.push_back({makeValue<T>(rng, domain * 2), VReturn_t(1 + rng() % 100)}); }
+            c.curve.build(points, (rng() % 2) ? VCurve_t::LINEAR : VCurve_t::STEP); }}
+    return c;
+}
+
+/// @brief Builds the keyed list for a case, the way a user would.
+template <class T> VKeyedList_t<T> makeList(const Case_t<T> &c) {
+    VKeyedList_t<T> kl;
+    for (const auto &kd : c.rules) { kl.add(kd); }
+    if (c.curve) { kl.setCurve(c.curve); }
+    return kl;
+}
+
+/// @brief Removes and rekeys a few queried values of a case's list in place, and mirrors the edits in a copy of the case.
+/// Edits only depend on the case, so every call makes the same ones.
+/// @return The edited values.
+template <class T> std::vector<T> editList(const Case_t<T> &c, VKeyedList_t<T> &kl, Case_t<T> &edited) {
+    std::mt19937 rng(uint32_t(c.rules.size() * 31 + c.queries.size()));
+    std::vector<T> values;
+    edited = c;
+    for (size_t e = 0; e < 4; ++e) {
+        const T value = c.queries[rng() % c.queries.size()];
+        const VKey_t key = makeKey(rng, Profile_t(rng() % NUM_PROFILES));
+        values.push_back(value);
+        if (e % 2 == 0) { kl.remove(value); }
+        else if (kl.rekey(value, key)) continue;
+        std::vector<VKeyedData_t<T>> kept;
+        for (const auto &kd : edited.rules) { (*kd.getPData() == value ? edited.removed : kept).push_back(kd); }
+        edited.rules.swap(kept);
+        if (e % 2 == 1) { edited.rules.push_back({key, value}); }}
+    return values;
+}
+
+/// @section Reference
+
+/// @brief Reference result for unlisted data.
+template <class T> VReturn_t referenceMiss(const Case_t<T> &c, const T &q) {
+    bool blacklistOnly = true;
+    for (const auto &kd : c.rules)   { blacklistOnly = blacklistOnly && -kd == VKey_t::BLACKLIST; }
+    for (const auto &kd : c.removed) { blacklistOnly = blacklistOnly && -kd == VKey_t::BLACKLIST; }
+    if (c.curve) return c.curve(q);
+    return blacklistOnly ? VReturn_t(VReturn_t::PASS) : VReturn_t(VReturn_t::FAIL);
+}
+
+/// @brief Reference result, written from the documented semantics and not from any backend: the first listed entry with
+/// equal data and a key other than `NULL_KEY` wins. Range keys are not listed. Unlisted data is scored by the curve if
+/// one is set, passes if every added key was `BLACKLIST`, and fails otherwise.
+template <class T> VReturn_t referenceQuery(const Case_t<T> &c, const T &q) {
+    for (const auto &kd : c.rules) {
+        if (-kd == VKey_t::MINIMUM || -kd == VKey_t::MAXIMUM || -kd == VKey_t::NULL_KEY) continue;
+        if (*kd.getPData() == q) return VReturn_t(-kd); }
+    return referenceMiss(c, q);
+}
+
+/// @brief Tolerance reference: the nearest listed entry within `tolerance`, by a full scan. ULPs are counted with
+/// `std::nextafter`. Ties go to the strictest result, then to the entry added first. NaN never matches.
+template <class T> VReturn_t referenceNear(const Case_t<T> &c, const T &q, const bool &ulps, const double &tolerance) {
+    auto distance = [&](T x) -> double {
+        if (x == q) return 0.0;
+        if (!ulps) return double(std::abs(x - q));
+        const T to = std::max(x, q);
+        double steps = 0.0;
+        for (x = std::min(x, q); x < to && steps <= tolerance; x = std::nextafter(x, to)) { ++steps; }
+        return steps; };
+    auto rank = [](const VKey_t &key) { return uint_t(VReturn_t(key)() + 1); };
+    const VKeyedData_t<T> *best = nullptr;
+    double bestDistance = 0.0;
+    for (const auto &kd : c.rules) {
+        const T x = *kd.getPData();
+        if (-kd == VKey_t::MINIMUM || -kd == VKey_t::MAXIMUM || -kd == VKey_t::NULL_KEY || x != x || q != q) continue;
+        const double d = distance(x);
+        if (!(d <= (ulps ? tolerance : double(T(tolerance))))) continue;
+        if (!best || d < bestDistance || (d == bestDistance && rank(-kd) < rank(-*best))) { best = &kd; bestDistance = d; }}
+    return best ? VReturn_t(-*best) : referenceMiss(c, q);
+}
+
+/// @section Report
+
+/// @brief Per backend results.
+struct BackendStats_t {
+    size_t checks = 0, mismatches = 0;
+    double ns = 0.0;
+};
+
+/// @brief Results of every backend, by type and backend name.
+struct Report_t {
+    std::map<std::string, BackendStats_t> backends{};
+    size_t printed = 0;
+
+    /// @brief Times `fn(queries, out)`, then compares `out` with `expected`. Prints the first few mismatches.
+    template <class T, class Fn> void check(const std::string &name, const Case_t<T> &c,
+                                            const std::vector<VReturn_t> &expected, Fn &&fn) {
+        std::vector<VReturn_t> out(c.queries.size());
+        const auto start = diffClock::now();
+        fn(c.queries, out);
+        std::chrono::duration<double, std::nano> elapsed = diffClock::now() - start;
+        BackendStats_t &stats = backends[name];
+        stats.ns += elapsed.count(); stats.checks += out.size();
+        for (size_t i = 0; i < out.size(); ++i) {
+            if (out[i]() == expected[i]()) continue;
+            ++stats.mismatches;
+            if (printed++ < 10) {
+                MSG("MISMATCH " << name << ": query " << i << " of " << c.queries.size() << ", " << c.rules.size()
+                    << " rules, curve " << bool(c.curve) << ": got " << out[i] << ", expected " << expected[i]); }}}
+
+    /// @brief Compares one value, `what`, with its expected value.
+    template <class V> void checkValue(const std::string &name, const char *what, const V &got, const V &expected) {
+        BackendStats_t &stats = backends[name];
+        ++stats.checks;
+        if (got == expected) return;
+        ++stats.mismatches;
+        if (printed++ < 10) { MSG("MISMATCH " << name << " " << what << ": got " << got << ", expected " << expected); }}
+
+    size_t mismatches() const {
+        size_t total = 0;
+        for (const auto &b : backends) { total += b.second.mismatches; }
+        return total; }
+
+    void print() const {
+        MSG(std::left << std::setw(34) << "Backend" << std::setw(12) << "Checks" << std::setw(12) << "Mismatches" << "ns/query");
+        for (const auto &b : backends) {
+            MSG(std::left << std::setw(34) << b.first << std::setw(12) << b.second.checks << std::setw(12)
+                << b.second.mismatches << b.second.ns / double(std::max<size_t>(b.second.checks, 1))); }}
+};
+
+/// @section Backends
+
+#if defined(V_ASYNC)
+/// @brief An async source that returns every key as its value, completing each batch on the calling thread.
+template <class T> class EchoSource_t : public VAsyncSource_t<T, T> {
+    public:
+    using VAsyncSource_t<T, T>::VAsyncSource_t;
+    protected:
+    void fetchBatch(const T *keys, const size_t &count, T *values, std::function<void()> done) override {
+        std::copy(keys, keys + count, values); done(); }
+};
+#endif
+
+/// @brief Decodes a reference result the way a result column stores it.
+template <VResultEncoding_t Encoding> VReturn_t columnReference(const VReturn_t &ret) {
+    const uint_t score = ret();
+    if (score == VReturn_t::FAIL) return VReturn_t::FAIL;
+    if (Encoding == VResultEncoding_t::PASS_MASK) return VReturn_t::PASS;
+    if (score == VReturn_t::PERFECT || score == VReturn_t::PASS) return ret;
+    return (Encoding == VResultEncoding_t::CLASS) ? uint_t(1) : std::min<uint_t>(score, VScoreColumn_t::SCORE16_MAX);
+}
+
+/// @brief Checks a result column filled by `queryColumn`, and one stored at an offset that is not word aligned, so the
+/// first and last words are partial. Items are decoded with `operator[]` and `resultClass`, and counted with
+/// `countPassing`. Items before the offset must stay `FAIL`.
+template <VResultEncoding_t Encoding, class T> void checkColumn(const std::string &name, const Case_t<T> &c,
+                                                                 const std::vector<VReturn_t> &expected,
+                                                                 const VKeyedList_t<T> &kl, Report_t &report) {
+    const size_t n = c.queries.size();
+    std::vector<VReturn_t> decoded(n), classes(n);
+    size_t passing = 0;
+    for (size_t i = 0; i < n; ++i) {
+        decoded[i] = columnReference<Encoding>(expected[i]);
+        classes[i] = uint_t(Validspace::resultClass(decoded[i]));
+        passing   += expected[i]() != VReturn_t::FAIL; }
+    for (const size_t offset : {size_t(0), size_t(37)}) {
+        const std::string at = name + (offset ? " offset" : "");
+        VResultColumn_t<Encoding> column;
+        if (offset == 0) { queryColumn(kl, c.queries.data(), n, column); }
+        else {
+            std::vector<VReturn_t> results(n);
+            kl.query(c.queries.data(), n, results.data());
+            column.resize(offset + n);
+            column.store(results.data(), n, offset); }
+        report.check(at, c, decoded, [&](const std::vector<T> &, std::vector<VReturn_t> &out) {
+            for (size_t i = 0; i < n; ++i) { out[i] = column[offset + i]; }});
+        report.check(at, c, classes, [&](const std::vector<T> &, std::vector<VReturn_t> &out) {
+            for (size_t i = 0; i < n; ++i) { out[i] = uint_t(column.resultClass(offset + i)); }});
+        report.checkValue(at, "countPassing", column.countPassing(), passing); }
+}
+
+/// @brief Runs every backend that supports `T` on one case.
+template <class T> void runCase(const Case_t<T> &c, const std::string &type, Report_t &report) {
+    using Queries_t = std::vector<T>;
+    using Out_t     = std::vector<VReturn_t>;
+    constexpr bool hashable = (type_flags<T> & HASHABLE_OP) != 0;
+
+    std::vector<VReturn_t> expected(c.queries.size());
+    for (size_t i = 0; i < c.queries.size(); ++i) { expected[i] = referenceQuery(c, c.queries[i]); }
+    const VKeyedList_t<T> kl = makeList(c);
+
+    report.check(type + " list scan", c, expected, [&](const Queries_t &q, Out_t &out) {
+        for (size_t i = 0; i < q.size(); ++i) { out[i] = kl.query(q[i]); }});
+    report.check(type + " list batch", c, expected, [&](const Queries_t &q, Out_t &out) {
+        kl.query(q.data(), q.size(), out.data()); });
+    const VKeyedList_t<T> copy(kl);
+    report.check(type + " list copy", c, expected, [&](const Queries_t &q, Out_t &out) {
+        for (size_t i = 0; i < q.size(); ++i) { out[i] = copy.query(q[i]); }});
+    VKeyedList_t<T> deduped(kl);
+    deduped.dedupe();
+    report.check(type + " list dedupe", c, expected, [&](const Queries_t &q, Out_t &out) {
+        for (size_t i = 0; i < q.size(); ++i) { out[i] = deduped.query(q[i]); }});
+    const Validator<T> validator(kl);
+    report.check(type + " validator", c, expected, [&](const Queries_t &q, Out_t &out) {
+        for (size_t i = 0; i < q.size(); ++i) { out[i] = validator(q[i]); }});
+#if defined(V_ASYNC)
+    report.check(type + " validator async", c, expected, [&](const Queries_t &q, Out_t &out) {
+        VAsyncScheduler_t scheduler;
+        EchoSource_t<T> source(scheduler, 16);
+        std::vector<VTask_t<VReturn_t>> tasks;
+        for (const auto &value : q) { tasks.push_back(validator.validateAsync(source, value)); }
+        out = scheduler.runAll(std::move(tasks), 64); });
+#endif
+    const VCompactKeyedList_t<T> compact(kl);
+    report.check(type + " compact list", c, expected, [&](const Queries_t &q, Out_t &out) {
+        for (size_t i = 0; i < q.size(); ++i) { out[i] = compact.query(q[i]); }});
+    checkColumn<VResultEncoding_t::PASS_MASK>(type + " pass mask", c, expected, kl, report);
+    checkColumn<VResultEncoding_t::CLASS    >(type + " class column", c, expected, kl, report);
+    checkColumn<VResultEncoding_t::SCORE16  >(type + " score column", c, expected, kl, report);
+    {
+        // Fused reductions, through the list's batch query and the validator's one value query
+        size_t passing = 0, perfect = 0, scored = 0, best = SIZE_MAX;
+        uint64_t scoreSum = 0;
+        auto better = [](const VReturn_t &a, const VReturn_t &b) {
+            auto rank = [](const uint_t &s) { return (s == VReturn_t::FAIL) ? 0 : (s == VReturn_t::PERFECT) ? 3 : (s == VReturn_t::PASS) ? 1 : 2; };
+            return rank(a()) != rank(b()) ? rank(a()) > rank(b()) : (rank(a()) == 2 && a() > b()); };
+        for (size_t i = 0; i < expected.size(); ++i) {
+            const uint_t score = expected[i]();
+            const bool isScore = score != VReturn_t::FAIL && score != VReturn_t::PERFECT && score != VReturn_t::PASS;
+            passing  += score != VReturn_t::FAIL;
+            perfect  += score == VReturn_t::PERFECT;
+            scored   += isScore;
+            scoreSum += isScore ? uint64_t(score) : 0;
+            if (score != VReturn_t::FAIL && (best == SIZE_MAX || better(expected[i], expected[best]))) { best = i; }}
+        const T *values = c.queries.data();
+        const size_t n = c.queries.size();
+        const VResultSummary_t sum = summarize(kl, values, n);
+        const std::string name = type + " fused reductions";
+        report.checkValue(name, "count",        sum.count,   n);
+        report.checkValue(name, "passing",      sum.passing, passing);
+        report.checkValue(name, "perfect",      sum.perfect, perfect);
+        report.checkValue(name, "scored",       sum.scored,  scored);
+        report.checkValue(name, "best",         sum.best,    best);
+        report.checkValue(name, "bestResult",   sum.bestResult(), (best == SIZE_MAX) ? uint_t(VReturn_t::FAIL) : expected[best]());
+        report.checkValue(name, "sumScores",    Validspace::sumScores(validator, values, n),    scoreSum);
+        report.checkValue(name, "countPassing", Validspace::countPassing(validator, values, n), passing);
+        report.checkValue(name, "argmax",       Validspace::argmax(validator, values, n),       best);
+    }
+    Case_t<T> edited;
+    VKeyedList_t<T> editedList(kl);
+    editList(c, editedList, edited);
+    std::vector<VReturn_t> editedExpected(c.queries.size());
+    for (size_t i = 0; i < c.queries.size(); ++i) { editedExpected[i] = referenceQuery(edited, c.queries[i]); }
+    report.check(type + " list edit", c, editedExpected, [&](const Queries_t &q, Out_t &out) {
+        for (size_t i = 0; i < q.size(); ++i) { out[i] = editedList.query(q[i]); }});
+    if (c.curve) {
+        // Removing the curve brings back the list mode
+        Case_t<T> plain = c;
+        plain.curve = VScoreCurve_t<T>();
+        VKeyedList_t<T> uncurved(kl);
+        uncurved.setCurve(plain.curve);
+        std::vector<VReturn_t> plainExpected(c.queries.size()), curveExpected(c.queries.size());
+        for (size_t i = 0; i < c.queries.size(); ++i) {
+            plainExpected[i] = referenceQuery(plain, c.queries[i]); curveExpected[i] = c.curve(c.queries[i]); }
+        report.check(type + " list curve removed", c, plainExpected, [&](const Queries_t &q, Out_t &out) {
+            for (size_t i = 0; i < q.size(); ++i) { out[i] = uncurved.query(q[i]); }});
+        report.check(type + " curve batch", c, curveExpected, [&](const Queries_t &q, Out_t &out) {
+            c.curve.query(q.data(), q.size(), out.data()); }); }
+
+    if constexpr (hashable) {
+        VKeyedList_t<T> compiled(kl);
+        compiled.compile(4.0);
+        report.check(type + " list compiled", c, expected, [&](const Queries_t &q, Out_t &out) {
+            for (size_t i = 0; i < q.size(); ++i) { out[i] = compiled.query(q[i]); }});
+        report.check(type + " list compiled batch", c, expected, [&](const Queries_t &q, Out_t &out) {
+            compiled.query(q.data(), q.size(), out.data()); });
+        const VPerfectHash_t<T> index(kl, 1);
+        report.check(type + " perfect hash", c, expected, [&](const Queries_t &q, Out_t &out) {
+            for (size_t i = 0; i < q.size(); ++i) { out[i] = index.query(q[i]); }});
+        // Tenant 0 lists the rules in reverse, so duplicate values disagree on keys
+        Case_t<T> reversed = c;
+        std::reverse(reversed.rules.begin(), reversed.rules.end());
+        std::vector<VReturn_t> reversedExpected(c.queries.size());
+        for (size_t i = 0; i < c.queries.size(); ++i) { reversedExpected[i] = referenceQuery(reversed, c.queries[i]); }
+        const VTenantIndex_t<T> tenants({makeList(reversed), kl}, 1);
+        for (const size_t tenant : {0, 1}) {
+            const std::string name = type + " tenant index " + std::to_string(tenant);
+            const std::vector<VReturn_t> &tenantExpected = tenant ? expected : reversedExpected;
+            report.check(name, c, tenantExpected, [&](const Queries_t &q, Out_t &out) {
+                for (size_t i = 0; i < q.size(); ++i) { out[i] = tenants.query(tenant, q[i]); }});
+            report.check(name + " all", c, tenantExpected, [&](const Queries_t &q, Out_t &out) {
+                for (size_t i = 0; i < q.size(); ++i) { out[i] = tenants.queryAll(q[i])[tenant]; }}); }
+        // Candidates pair two queries, scored by the list and the reversed list. The list is edited after the ranking is
+        // built, then the ranking follows by updating the edited values or by a full refresh
+        const size_t n = c.queries.size(), k = 1 + n / 8;
+        const VKeyedList_t<T> reversedList = makeList(reversed);
+        std::vector<std::vector<T>> candidates(n);
+        for (size_t i = 0; i < n; ++i) { candidates[i] = {c.queries[i], c.queries[(i * 7 + 3) % n]}; }
+        std::vector<VReturn_t> totals(n), positions(n, VReturn_t::FAIL);
+        std::vector<size_t> order;
+        for (size_t i = 0; i < n; ++i) {
+            totals[i] = VReturn_t::PASS;
+            totals[i] += referenceQuery(edited, candidates[i][0]);
+            totals[i] += referenceQuery(reversed, candidates[i][1]);
+            if (resultRank(totals[i]) != 0) { order.push_back(i); }}
+        std::stable_sort(order.begin(), order.end(), [&](const size_t &a, const size_t &b) { return resultRank(totals[a]) > resultRank(totals[b]); });
+        for (size_t p = 0; p < std::min(k, order.size()); ++p) { positions[order[p]] = VReturn_t(uint_t(p)); }
+        for (const bool refresh : {false, true}) {
+            const std::string name = type + (refresh ? " incremental refresh" : " incremental update");
+            VKeyedList_t<T> live(kl);
+            VIncrementalRanking_t<T> ranking({&live, &reversedList}, candidates, k);
+            Case_t<T> liveCase;
+            const std::vector<T> values = editList(c, live, liveCase);
+            if (refresh) { ranking.refresh(); } else { ranking.update(0, values); }
+            report.check(name, c, totals, [&](const Queries_t &q, Out_t &out) {
+                for (size_t i = 0; i < q.size(); ++i) { out[i] = ranking.result(i); }});
+            report.check(name + " top k", c, positions, [&](const Queries_t &, Out_t &out) {
+                const VRanking_t top = ranking.ranking();
+                std::fill(out.begin(), out.end(), VReturn_t(VReturn_t::FAIL));
+                for (size_t p = 0; p < top.size(); ++p) { out[top.indices[p]] = VReturn_t(uint_t(p)); }}); }
+        VQueryCache_t<T> cache(64, 1);
+        report.check(type + " query cache", c, expected, [&](const Queries_t &q, Out_t &out) {
+            for (size_t i = 0; i < q.size(); ++i) { out[i] = validator.validate(q[i], cache); }});
+#if defined(V_SHARED_RULES)
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            const int fd = c.curve ? -1 : VSharedRules_t<T>::publishFd(kl);
+            VSharedRules_t<T> shared;
+            if (fd >= 0 && shared.attachFd(fd)) {
+                report.check(type + " shared rules", c, expected, [&](const Queries_t &q, Out_t &out) {
+                    for (size_t i = 0; i < q.size(); ++i) { out[i] = shared.query(q[i]); }}); }
+            if (fd >= 0) { close(fd); }}
+#endif
+    }
+    if constexpr (std::is_integral<T>::value) {
+        // Every listed key mapped to WHITELIST or BLACKLIST, the only keys Roaring lists hold
+        Case_t<T> bw = c;
+        bw.rules.clear();
+        for (const auto &kd : c.rules) {
+            const bool keep = -kd == VKey_t::NULL_KEY || -kd == VKey_t::MINIMUM || -kd == VKey_t::MAXIMUM || -kd == VKey_t::BLACKLIST;
+            bw.rules.push_back({keep ? VKey_t(-kd) : VKey_t(VKey_t::WHITELIST), *kd.getPData()}); }
+        std::vector<VReturn_t> bwExpected(c.queries.size());
+        for (size_t i = 0; i < c.queries.size(); ++i) { bwExpected[i] = referenceQuery(bw, c.queries[i]); }
+        const VRoaringKeyedList_t<T> roaring(makeList(bw));
+        report.check(type + " roaring list", c, bwExpected, [&](const Queries_t &q, Out_t &out) {
+            for (size_t i = 0; i < q.size(); ++i) { out[i] = roaring.query(q[i]); }});
+        report.check(type + " roaring list batch", c, bwExpected, [&](const Queries_t &q, Out_t &out) {
+            roaring.query(q.data(), q.size(), out.data()); });
+        // Set algebra on the two halves of the rules, against `VKeyedList_t::merge`
+        Case_t<T> left = bw, right = bw;
+        left.rules.resize(bw.rules.size() / 2);
+        right.rules.erase(right.rules.begin(), right.rules.begin() + bw.rules.size() / 2);
+        const VKeyedList_t<T> leftList = makeList(left), rightList = makeList(right);
+        const VRoaringKeyedList_t<T> leftRoaring(leftList), rightRoaring(rightList);
+        const std::pair<VSetOp_t, const char*> ops[] = {
+            {VSetOp_t::UNION, "union"}, {VSetOp_t::INTERSECTION, "intersect"}, {VSetOp_t::DIFFERENCE, "difference"}};
+        const std::pair<VPrecedence_t, const char*> precedences[] = {
+            {VPrecedence_t::LEFT, "left"}, {VPrecedence_t::RIGHT, "right"}, {VPrecedence_t::STRICTEST, "strict"}, {VPrecedence_t::LOOSEST, "loose"}};
+        for (const auto &op : ops) {
+            for (const auto &p : precedences) {
+                if (op.first == VSetOp_t::DIFFERENCE && p.first != VPrecedence_t::LEFT) continue;
+                VKeyedList_t<T> merged(leftList);
+                merged.merge(rightList, op.first, p.first);
+                std::vector<VReturn_t> mergedExpected(c.queries.size());
+                for (size_t i = 0; i < c.queries.size(); ++i) { mergedExpected[i] = merged.query(c.queries[i]); }
+                const VRoaringKeyedList_t<T> combined = VRoaringKeyedList_t<T>::combine(leftRoaring, rightRoaring, op.first, p.first);
+                report.check(type + " roaring " + op.second + " " + p.second, c, mergedExpected, [&](const Queries_t &q, Out_t &out) {
+                    for (size_t i = 0; i < q.size(); ++i) { out[i] = combined.query(q[i]); }}); }}}
+    if constexpr (std::is_floating_point<T>::value) {
+        const VToleranceIndex_t<T> exact(kl, VTolerance_t::ABSOLUTE, 0.0, VPrecedence_t::LEFT);
+        report.check(type + " tolerance exact", c, expected, [&](const Queries_t &q, Out_t &out) {
+            for (size_t i = 0; i < q.size(); ++i) { out[i] = exact.query(q[i]); }});
+        report.check(type + " tolerance exact batch", c, expected, [&](const Queries_t &q, Out_t &out) {
+            exact.query(q.data(), q.size(), out.data()); });
+        // Nudge queries by a few ULPs so some land inside the ULP tolerance and some just outside
+        Case_t<T> near = c;
+        for (size_t i = 0; i < near.queries.size(); ++i) {
+            for (size_t step = 0; step < i % 7; ++step) { near.queries[i] = std::nextafter(near.queries[i], (i % 2) ? T(-INFINITY) : T(INFINITY)); }}
+        for (const bool ulps : {false, true}) {
+            const double tolerance = ulps ? 4.0 : 0.5;
+            const std::string name = type + (ulps ? " tolerance ulps" : " tolerance absolute");
+            std::vector<VReturn_t> nearExpected(near.queries.size());
+            for (size_t i = 0; i < near.queries.size(); ++i) { nearExpected[i] = referenceNear(near, near.queries[i], ulps, tolerance); }
+            const VToleranceIndex_t<T> index(kl, ulps ? VTolerance_t::ULPS : VTolerance_t::ABSOLUTE, tolerance);
+            report.check(name, near, nearExpected, [&](const Queries_t &q, Out_t &out) {
+                for (size_t i = 0; i < q.size(); ++i) { out[i] = index.query(q[i]); }});
+            report.check(name + " batch", near, nearExpected, [&](const Queries_t &q, Out_t &out) {
+                index.query(q.data(), q.size(), out.data()); }); }}
+    if constexpr (std::is_same<T, int64_t>::value || std::is_same<T, double>::value) {
+        // Daemon framing: a request is encoded, checked and decoded, scored like validatord does, and the response is
+        // encoded and decoded again. RANK results are put back in request order
+        namespace VProtocol = Validspace::VProtocol;
+        for (const VProtocol::Op_t op : {VProtocol::VALIDATE, VProtocol::RANK}) {
+            const std::string name = type + (op == VProtocol::RANK ? " protocol rank" : " protocol validate");
+            report.check(name, c, expected, [&](const Queries_t &q, Out_t &out) {
+                std::vector<uint8_t> request, response;
+                VProtocol::appendRequest(request, 7, op, "rules", q.data(), q.size());
+                const VProtocol::Header_t h = VProtocol::getHeader(request.data());
+                if (VProtocol::checkRequest(request.data(), request.size()) != VProtocol::OK) { report.backends[name].mismatches++; return; }
+                std::vector<VReturn_t> results(h.count);
+                std::vector<uint32_t> order(h.count);
+                const uint8_t *values = request.data() + VProtocol::HEADER_SIZE + h.nameLength;
+                for (uint32_t i = 0; i < h.count; ++i) { results[i] = kl.query(VProtocol::fromBits<T>(VProtocol::getU64(values + i * 8))); order[i] = i; }
+                std::stable_sort(order.begin(), order.end(), [&](const uint32_t &a, const uint32_t &b) { return resultRank(results[a]) > resultRank(results[b]); });
+                VProtocol::appendResponse(response, h.id, h.op, results.data(), order.data(), h.count);
+                const VProtocol::Header_t r = VProtocol::getHeader(response.data());
+                VResponse_t decoded;
+                VProtocol::readResponse(r, response.data() + VProtocol::HEADER_SIZE, response.size() - VProtocol::HEADER_SIZE, decoded);
+                if (size_t(r.length) + 4 != response.size() || decoded.id != 7 || decoded.status != VProtocol::OK || decoded.scores.size() != q.size()) {
+                    report.backends[name].mismatches++; return; }
+                for (size_t i = 0; i < q.size(); ++i) {
+                    if (op == VProtocol::VALIDATE) { out[i] = decoded.scores[i]; }
+                    else if (decoded.order[i] < q.size()) { out[decoded.order[i]] = decoded.scores[i]; }}}); }}
+}
+
+/// @section Expressions
+
+/// @brief Reference expression tree. Leaves 0 to 2 are trait lists on `Row_t::a`, `b`, and `c`, leaf 3 is `rowScore`.
+struct RefExpr_t {
+    VExprOp_t op   = VExprOp_t::LEAF;
+    size_t    leaf = 0;
+    std::vector<RefExpr_t> children{};
+    std::vector<uint32_t>  quarters{}; // SUM weights, in quarters so they are exact in 8.8 fixed point
+};
+
+/// @brief Whole candidate leaf.
+VReturn_t rowScore(const Row_t &r) { return ((r.a + r.b) % 5 == 0) ? VReturn_t(VReturn_t::FAIL) : VReturn_t(uint_t(r.c % 50)); }
+
+/// @brief Generates an expression up to `depth` nodes deep.
+RefExpr_t makeExpr(std::mt19937 &rng, const size_t &depth) {
+    static const VExprOp_t ops[] = {VExprOp_t::NOT, VExprOp_t::AND, VExprOp_t::OR, VExprOp_t::SUM, VExprOp_t::MIN, VExprOp_t::MAX};
+    RefExpr_t e;
+    if (depth == 0 || rng() % 3 == 0) { e.leaf = rng() % 4; return e; }
+    e.op = ops[rng() % 6];
+    for (size_t i = 0, n = (e.op == VExprOp_t::NOT) ? 1 : 1 + rng() % 4; i < n; ++i) {
+        e.children.push_back(makeExpr(rng, depth - 1));
+        if (e.op == VExprOp_t::SUM) { e.quarters.push_back(rng() % 13); }}
+    return e;
+}
+
+/// @brief Reference result, by walking the tree with the documented node semantics and no early exits.
+VReturn_t referenceExpr(const RefExpr_t &e, const std::vector<Case_t<uint32_t>> &traits, const Row_t &r) {
+    if (e.op == VExprOp_t::LEAF) {
+        const uint32_t fields[] = {r.a, r.b, r.c};
+        return (e.leaf < 3) ? referenceQuery(traits[e.leaf], fields[e.leaf]) : rowScore(r); }
+    std::vector<VReturn_t> v;
+    for (const auto &child : e.children) { v.push_back(referenceExpr(child, traits, r)); }
+    const auto isFail = [](const VReturn_t &x) { return x() == VReturn_t::FAIL; };
+    switch (e.op) {
+    case VExprOp_t::NOT: return isFail(v[0]) ? VReturn_t(VReturn_t::PASS) : VReturn_t(VReturn_t::FAIL);
+    case VExprOp_t::OR:
+        for (const auto &x : v) { if (!isFail(x)) return x; }
+        return VReturn_t::FAIL;
+    case VExprOp_t::MIN: case VExprOp_t::MAX: {
+        VReturn_t best = v[0];
+        for (const auto &x : v) {
+            if (e.op == VExprOp_t::MIN ? resultRank(x) < resultRank(best) : resultRank(x) > resultRank(best)) { best = x; }}
+        return best; }
+    default: {
+        // AND and SUM: FAIL wins, then PERFECT, else the weighted sum of the scores, each capped like `VScorer_t`
+        if (std::any_of(v.begin(), v.end(), isFail)) return VReturn_t::FAIL;
+        if (std::any_of(v.begin(), v.end(), [](const VReturn_t &x) { return x() == VReturn_t::PERFECT; })) return VReturn_t::PERFECT;
+        uint64_t quarters = 0;
+        for (size_t i = 0; i < v.size(); ++i) {
+            quarters += std::min<uint64_t>(v[i](), VScorer_t::SCORE_CAP) * (e.op == VExprOp_t::SUM ? e.quarters[i] : 4); }
+        return VReturn_t(uint_t(std::min<uint64_t>(quarters / 4, uint64_t(VReturn_t::PERFECT) - 1))); }}
+}
+
+/// @brief Builds a reference tree into an expression.
+VExpression_t<Row_t>::Node_t buildExpr(VExpression_t<Row_t> &expr, const RefExpr_t &e, const std::vector<VKeyedList_t<uint32_t>> &lists) {
+    using Node_t = VExpression_t<Row_t>::Node_t;
+    switch (e.op) {
+    case VExprOp_t::LEAF:
+        switch (e.leaf) {
+        case 0:  return expr.leaf(lists[0], [](const Row_t &r) { return r.a; });
+        case 1:  return expr.leaf(lists[1], [](const Row_t &r) { return r.b; });
+        case 2:  return expr.leaf(lists[2], [](const Row_t &r) { return r.c; });
+        default: return expr.leaf(rowScore); }
+    case VExprOp_t::NOT: return expr.negate(buildExpr(expr, e.children[0], lists));
+    case VExprOp_t::SUM: {
+        std::vector<std::pair<Node_t, double>> terms;
+        for (size_t i = 0; i < e.children.size(); ++i) { terms.push_back({buildExpr(expr, e.children[i], lists), e.quarters[i] / 4.0}); }
+        return expr.weightedSum(terms); }
+    default: {
+        std::vector<Node_t> children;
+        for (const auto &child : e.children) { children.push_back(buildExpr(expr, child, lists)); }
+        if (e.op == VExprOp_t::AND) return expr.all(children);
+        if (e.op == VExprOp_t::OR)  return expr.any(children);
+        return (e.op == VExprOp_t::MIN) ? expr.min(children) : expr.max(children); }}
+}
+
+/// @brief Checks a random expression over three generated trait lists, one candidate at a time and in blocks.
+void runExpression(std::mt19937 &rng, Report_t &report) {
+    std::vector<Case_t<uint32_t>> traits;
+    std::vector<VKeyedList_t<uint32_t>> lists;
+    for (size_t t = 0; t < 3; ++t) { traits.push_back(makeCase<uint32_t>(rng)); lists.push_back(makeList(traits.back())); }
+    const RefExpr_t tree = makeExpr(rng, 1 + rng() % 5);
+    VExpression_t<Row_t> expr;
+    if (!expr.compile(buildExpr(expr, tree, lists))) { report.backends["row    expression"].mismatches++; return; }
+    // Rows span several blocks, with listed trait values mixed in
+    Case_t<Row_t> rows;
+    for (size_t i = 0, n = 1 + rng() % 700; i < n; ++i) {
+        uint32_t fields[3];
+        for (size_t t = 0; t < 3; ++t) { const auto &q = traits[t].queries; fields[t] = q[rng() % q.size()]; }
+        rows.queries.push_back({fields[0], fields[1], fields[2]}); }
+    std::vector<VReturn_t> expected(rows.queries.size());
+    for (size_t i = 0; i < rows.queries.size(); ++i) { expected[i] = referenceExpr(tree, traits, rows.queries[i]); }
+    report.check("row    expression", rows, expected, [&](const std::vector<Row_t> &q, std::vector<VReturn_t> &out) {
+        for (size_t i = 0; i < q.size(); ++i) { out[i] = expr.validate(q[i]); }});
+    report.check("row    expression batch", rows, expected, [&](const std::vector<Row_t> &q, std::vector<VReturn_t> &out) {
+        expr.validate(q.data(), q.size(), out.data()); });
+}
+
+#if defined(V_SHARED_RULES)
+/// @section Shared Rules Across Processes
+
+/// @brief Runs `fn(out)` in a forked child and reads `out` back through a pipe.
+template <class Fn> void inChild(const size_t &count, std::vector<VReturn_t> &out, Fn &&fn) {
+    int fds[2];
+    if (pipe(fds) != 0) return;
+    const pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        std::vector<VReturn_t> results(count, VReturn_t::FAIL);
+        fn(results);
+        for (const auto &r : results) { const uint_t v = r(); if (write(fds[1], &v, sizeof(v)) != ssize_t(sizeof(v))) break; }
+        _exit(0); }
+    close(fds[1]);
+    for (size_t i = 0; i < count; ++i) { uint_t v; out[i] = (read(fds[0], &v, sizeof(v)) == ssize_t(sizeof(v))) ? VReturn_t(v) : VReturn_t(VReturn_t::FAIL); }
+    close(fds[0]);
+    if (pid > 0) { waitpid(pid, nullptr, 0); }
+}
+
+/// @brief Checks a named rule set from other processes: a child that attaches, readers that attach while one or two
+/// children keep publishing, and a reader whose next generation is corrupt.
+void runSharedRules(std::mt19937 &rng, Report_t &report) {
+    Case_t<uint32_t> c = makeCase<uint32_t>(rng);
+    c.curve = VScoreCurve_t<uint32_t>();
+    const VKeyedList_t<uint32_t> kl = makeList(c);
+    std::vector<VReturn_t> expected(c.queries.size());
+    for (size_t i = 0; i < c.queries.size(); ++i) { expected[i] = referenceQuery(c, c.queries[i]); }
+    const std::string name = "validator_differential_" + std::to_string(getpid());
+    if (VSharedRules_t<uint32_t>::publish(name, kl) == 0) { report.backends["uint32 shared rules child"].mismatches++; return; }
+
+    report.check("uint32 shared rules child", c, expected, [&](const std::vector<uint32_t> &q, std::vector<VReturn_t> &out) {
+        inChild(q.size(), out, [&](std::vector<VReturn_t> &results) {
+            VSharedRules_t<uint32_t> shared;
+            if (!shared.attach(name)) return;
+            for (size_t i = 0; i < q.size(); ++i) { results[i] = shared.query(q[i]); }}); });
+    // Every attach must succeed while the child unlinks old generations
+    report.check("uint32 shared rules attach", c, expected, [&](const std::vector<uint32_t> &q, std::vector<VReturn_t> &out) {
+        const pid_t pid = fork();
+        if (pid == 0) { for (size_t i = 0; i < 4 * q.size(); ++i) { VSharedRules_t<uint32_t>::publish(name, kl); } _exit(0); }
+        for (size_t i = 0; i < q.size(); ++i) {
+            VSharedRules_t<uint32_t> shared;
+            out[i] = shared.attach(name) ? shared.query(q[i]) : VReturn_t(VReturn_t::FAIL); }
+        if (pid > 0) { waitpid(pid, nullptr, 0); }});
+    // Two publishers racing for the same generation must never leave the control segment naming a removed segment
+    report.check("uint32 shared rules publishers", c, expected, [&](const std::vector<uint32_t> &q, std::vector<VReturn_t> &out) {
+        pid_t pids[2];
+        for (auto &pid : pids) {
+            pid = fork();
+            if (pid == 0) { for (size_t i = 0; i < 4 * q.size(); ++i) { VSharedRules_t<uint32_t>::publish(name, kl); } _exit(0); }}
+        for (size_t i = 0; i < q.size(); ++i) {
+            VSharedRules_t<uint32_t> shared;
+            out[i] = shared.attach(name) ? shared.query(q[i]) : VReturn_t(VReturn_t::FAIL); }
+        for (const auto &pid : pids) { if (pid > 0) { waitpid(pid, nullptr, 0); }}
+        // A publish that finds the next generation still being written by another process fails and leaves it alone
+        VSharedRules_t<uint32_t> shared;
+        bool ok = shared.attach(name);
+        const std::string inFlight = "/" + name + "." + std::to_string(shared.generation() + 1);
+        const int fd = shm_open(inFlight.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        ok = ok && fd >= 0 && VSharedRules_t<uint32_t>::publish(name, kl) == 0;
+        if (fd >= 0) { close(fd); }
+        const int left = shm_open(inFlight.c_str(), O_RDONLY, 0);
+        if (left >= 0) { close(left); }
+        shm_unlink(inFlight.c_str());
+        if (!ok || left < 0 || !shared.refresh()) { std::fill(out.begin(), out.end(), VReturn_t(VReturn_t::FAIL)); }});
+    // A corrupt next generation leaves the reader on its current mapping. Each pair is a header byte offset and the
+    // value written there: the magic, then a table size of 0, not a power of two, and past the segment end, then a
+    // table offset past the segment end
+    VSharedRules_t<uint32_t> reader(name);
+    const uint64_t current = reader.generation();
+    const std::pair<off_t, uint64_t> corruptions[] = {{0, 0}, {48, 0}, {48, 3}, {48, uint64_t(1) << 40}, {40, uint64_t(1) << 40}};
+    bool kept = current != 0;
+    for (const auto &corruption : corruptions) {
+        const uint64_t next = VSharedRules_t<uint32_t>::publish(name, kl);
+        const int fd = shm_open(("/" + name + "." + std::to_string(next)).c_str(), O_RDWR, 0);
+        bool corrupted = false;
+        if (fd >= 0) { corrupted = pwrite(fd, &corruption.second, sizeof(uint64_t), corruption.first) == ssize_t(sizeof(uint64_t)); close(fd); }
+        kept = kept && corrupted && reader.refresh() && reader.generation() == current; }
+    report.check("uint32 shared rules bad refresh", c, expected, [&](const std::vector<uint32_t> &q, std::vector<VReturn_t> &out) {
+        for (size_t i = 0; i < q.size(); ++i) { out[i] = kept ? reader.query(q[i]) : VReturn_t(VReturn_t::FAIL); }});
+    VSharedRules_t<uint32_t>::unlink(name);
+}
+#endif
+
+/// @brief Rebuilds a compact list from a list with more than 65536 distinct keys. The failed build must leave no
+/// entries behind, so every query fails.
+void runCompactOverflow(std::mt19937 &rng, Report_t &report) {
+    Case_t<uint32_t> c = makeCase<uint32_t>(rng);
+    c.curve = VScoreCurve_t<uint32_t>();
+    VCompactKeyedList_t<uint32_t> compact(makeList(c));
+    VKeyedList_t<uint32_t> wide;
+    for (uint32_t v = 0; v <= 65536; ++v) { wide.add(VKeyedData_t<uint32_t>(VKey_t(uint_t(v) + 1), v)); }
+    const bool failed = !compact.build(wide) && compact.size() == 0;
+    const std::vector<VReturn_t> expected(c.queries.size(), VReturn_t::FAIL);
+    report.check("uint32 compact list overflow", c, expected, [&](const std::vector<uint32_t> &q, std::vector<VReturn_t> &out) {
+        for (size_t i = 0; i < q.size(); ++i) { out[i] = failed ? compact.query(q[i]) : VReturn_t(VReturn_t::PASS); }});
+}
+
+/// @brief Scores a linear curve between breakpoints just below `PERFECT`. The interpolated values do not fit a double
+/// exactly, and must clamp to `PERFECT - 1` instead of wrapping.
+void runCurveTop(Report_t &report) {
+    const uint_t floor = VReturn_t::PERFECT - (uint_t(1) << 21);
+    const VReturn_t top(uint_t(VReturn_t::PERFECT - 1)), belowTop(uint_t(VReturn_t::PERFECT - (uint_t(1) << 20)));
+    const VScoreCurve_t<double> curve({{0.0, belowTop}, {10.0, top}, {20.0, belowTop}}, VCurve_t::LINEAR);
+    for (const double value : {0.0, 2.5, 5.0, 9.9, 10.0, 15.0, 20.0}) {
+        const uint_t score = curve.query(value)();
+        report.checkValue("double curve top", "in range", score >= floor && score < VReturn_t::PERFECT, true); }
+}
+
+/// @brief Checks the request limits of the daemon protocol on headers alone. A RANK response takes 12 bytes per value,
+/// so the largest RANK request is far smaller than the largest VALIDATE request.
+void runProtocolLimits(Report_t &report) {
+    namespace VProtocol = Validspace::VProtocol;
+    struct Limit_t { uint8_t op, type; size_t count, sizeSlack; VProtocol::Status_t status; };
+    const Limit_t limits[] = {
+        {VProtocol::RANK,     VProtocol::INT64,  VProtocol::MAX_RANK_COUNT,     0, VProtocol::OK},
+        {VProtocol::RANK,     VProtocol::DOUBLE, VProtocol::MAX_RANK_COUNT + 1, 0, VProtocol::BAD_REQUEST},
+        {VProtocol::VALIDATE, VProtocol::INT64,  VProtocol::MAX_RANK_COUNT + 1, 0, VProtocol::OK},
+        {VProtocol::VALIDATE, VProtocol::INT64,  16,                            8, VProtocol::BAD_REQUEST},
+        {3,                   VProtocol::INT64,  16,                            0, VProtocol::BAD_REQUEST},
+        {VProtocol::VALIDATE, 2,                 16,                            0, VProtocol::BAD_REQUEST}};
+    BackendStats_t &stats = report.backends["protocol limits"];
+    for (const auto &limit : limits) {
+        // Only the header is read, so the claimed frame size need not be allocated
+        const size_t size = VProtocol::HEADER_SIZE + limit.count * 8;
+        uint8_t header[VProtocol::HEADER_SIZE];
+        VProtocol::putHeader(header, {uint32_t(size - 4), 1, limit.op, limit.type, 0, uint32_t(limit.count)});
+        const VProtocol::Status_t status = VProtocol::checkRequest(header, size + limit.sizeSlack);
+        ++stats.checks;
+        if (status != limit.status) {
+            ++stats.mismatches;
+            MSG("MISMATCH protocol limits: op " << int(limit.op) << ", type " << int(limit.type) << ", count " << limit.count
+                << ": got status " << int(status) << ", expected " << int(limit.status)); }}
+    // A status response decodes with no scores
+    std::vector<uint8_t> response;
+    VProtocol::appendStatus(response, 9, VProtocol::RANK, VProtocol::UNKNOWN_RULES);
+    VResponse_t decoded;
+    VProtocol::readResponse(VProtocol::getHeader(response.data()), response.data() + VProtocol::HEADER_SIZE, response.size() - VProtocol::HEADER_SIZE, decoded);
+    ++stats.checks;
+    if (response.size() != VProtocol::HEADER_SIZE || decoded.id != 9 || decoded.status != VProtocol::UNKNOWN_RULES || !decoded.scores.empty()) {
+        ++stats.mismatches; MSG("MISMATCH protocol limits: status response"); }
+}
+
+/// @brief Runs `rounds` generated cases of every test type.
+void runRounds(const size_t &rounds, const uint32_t &seed, Report_t &report) {
+    std::mt19937 rng(seed);
+    for (size_t r = 0; r < rounds; ++r) {
+        runCase(makeCase<uint32_t>(rng), "uint32", report);
+        runCase(makeCase<int64_t >(rng), "int64 ", report);
+        runCase(makeCase<float   >(rng), "float ", report);
+        runCase(makeCase<double  >(rng), "double", report);
+        runCase(makeCase<Point_t >(rng), "point ", report);
+        runCase(makeCase<Tag_t   >(rng), "tag   ", report);
+        runExpression(rng, report); }
+}
+
+#if defined(V_FUZZ)
+/// @brief libFuzzer entry. Byte 0 picks the profile, then (key, value) byte pairs up to a 0xff separator, then query
+/// bytes. Checks `uint32_t` and `double` backends and aborts on any mismatch.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size < 2) return 0;
+    std::mt19937 rng(data[0]);
+    const Profile_t profile = Profile_t(data[0] % NUM_PROFILES);
+    Case_t<uint32_t> ints; Case_t<double> doubles;
+    size_t i = 1;
+    for (; i + 1 < size && data[i] != 0xff; i += 2) {
+        const VKey_t key = (data[i] & 1) ? makeKey(rng, profile) : VKey_t(data[i] >> 1);
+        ints.rules.push_back({key, uint32_t(data[i + 1] & 0x3f)});
+        doubles.rules.push_back({key, (data[i + 1] & 0x40) ? ((data[i + 1] & 1) ? -0.0 : 0.0) : double(data[i + 1] & 0x3f)}); }
+    for (++i; i < size; ++i) {
+        ints.queries.push_back(uint32_t(data[i] & 0x3f));
+        doubles.queries.push_back((data[i] & 0x40) ? std::nan("") : double(data[i] & 0x3f)); }
+    if (ints.queries.empty()) return 0;
+    Report_t report;
+    runCase(ints, "uint32", report);
+    runCase(doubles, "double", report);
+    if (report.mismatches() != 0) { std::abort(); }
+    return 0;
+}
+#else
+int main(int argc, char **argv) {
+    const size_t   rounds = (argc > 1) ? std::stoull(argv[1]) : 500;
+    const uint32_t seed   = (argc > 2) ? uint32_t(std::stoul(argv[2])) : 1;
+
+    MSG("Differential test: " << rounds << " rounds, seed " << seed);
+    Report_t report;
+    runRounds(rounds, seed, report);
+    std::mt19937 overflowRng(seed);
+    runCompactOverflow(overflowRng, report);
+    runCurveTop(report);
+    runProtocolLimits(report);
+#if defined(V_SHARED_RULES)
+    std::mt19937 rng(seed);
+    for (size_t r = 0; r < 8; ++r) { runSharedRules(rng, report); }
+#endif
+    report.print();
+    if (report.mismatches() != 0) { MSG("FAILED: " << report.mismatches() << " mismatches"); return 1; }
+    MSG("PASSED");
+    return 0;
+}
+#endif
@@ -0,0 +1,110 @@
+#pragma once
+/**
+ * @file tests/perf_counters.hpp
+ * @author Ray Richter
+ * @brief VPerfCounters_t Class declaration. Hardware counters for the benchmarks, read with `perf_event_open`.
+ * @note Every event is opened on its own, so events the CPU, kernel, or container do not allow are skipped and the rest
+ * still count. Counts are user space only, which works with `perf_event_paranoid` <= 2. When the kernel multiplexes
+ * counters, counts are scaled by enabled / running time. Without Linux every event is unavailable.
+ */
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/// @brief Counted events, in report order.
+enum VPerfEvent_t : uint8_t { CYCLES, INSTRUCTIONS, BRANCH_MISSES, L1D_MISSES, LLC_MISSES, DTLB_MISSES, NUM_PERF_EVENTS };
+
+/// @brief Event names, in `VPerfEvent_t` order.
+inline const char* perfEventName(const size_t &event) {
+    static const char *names[NUM_PERF_EVENTS] = {"cycles", "instructions", "branch-misses", "L1d-misses", "LLC-misses", "dTLB-misses"};
+    return names[event]; }
+
+/// @brief Counts for one measured region. Events that could not be read have `available[e] == false`.
+struct VPerfSample_t {
+    double value[NUM_PERF_EVENTS] = {};
+    bool   available[NUM_PERF_EVENTS] = {};
+};
+
+/// @brief A set of hardware counters for the calling thread.
+class VPerfCounters_t {
+    public:
+    /// @brief Opens every event the system allows.
+    VPerfCounters_t() {
+        for (size_t e = 0; e < NUM_PERF_EVENTS; ++e) { fds_[e] = _open(VPerfEvent_t(e)); }}
+    ~VPerfCounters_t() {
+#if defined(__linux__)
+        for (const auto &fd : fds_) { if (fd >= 0) close(fd); }
+#endif
+    }
+    VPerfCounters_t(const VPerfCounters_t&) = delete;
+    VPerfCounters_t& operator=(const VPerfCounters_t&) = delete;
+
+    /// @brief Checks if any event is available.
+    explicit operator bool() const {
+        for (const auto &fd : fds_) { if (fd >= 0) return true; }
+        return false; }
+    /// @brief Checks if an event is available.
+    bool available(const VPerfEvent_t &event) const { return fds_[event] >= 0; }
+
+    /// @brief Resets and starts every counter.
+    void start() {
+#if defined(__linux__)
+        for (const auto &fd : fds_) { if (fd >= 0) { ioctl(fd, PERF_EVENT_IOC_RESET, 0); ioctl(fd, PERF_EVENT_IOC_ENABLE, 0); }}
+#endif
+    }
+
+    /// @brief Stops every counter and reads it, scaled for multiplexing.
+    VPerfSample_t stop() {
+        VPerfSample_t sample;
+#if defined(__linux__)
+        for (const auto &fd : fds_) { if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0); }
+        for (size_t e = 0; e < NUM_PERF_EVENTS; ++e) {
+            uint64_t data[3] = {}; // value, time enabled, time running
+            if (fds_[e] < 0 || read(fds_[e], data, sizeof(data)) != ssize_t(sizeof(data)) || data[2] == 0) continue;
+            sample.value[e] = double(data[0]) * double(data[1]) / double(data[2]);
+            sample.available[e] = true; }
+#endif
+        return sample; }
+
+    /// @brief Measures `count` calls of `fn(i)`.
+    /// @return Counts per call.
+    template <class Fn> VPerfSample_t perCall(const size_t &count, Fn &&fn) {
+        start();
+        for (size_t i = 0; i < count; ++i) { fn(i); }
+        VPerfSample_t sample = stop();
+        for (auto &v : sample.value) { v /= double(count ? count : 1); }
+        return sample; }
+
+    private:
+    int fds_[NUM_PERF_EVENTS];
+
+    static int _open(const VPerfEvent_t &event) {
+#if defined(__linux__)
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.disabled = 1; attr.exclude_kernel = 1; attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        auto cache = [](const uint64_t &id) {
+            return id | (uint64_t(PERF_COUNT_HW_CACHE_OP_READ) << 8) | (uint64_t(PERF_COUNT_HW_CACHE_RESULT_MISS) << 16); };
+        switch (event) {
+        case CYCLES:        attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CPU_CYCLES;       break;
+        case INSTRUCTIONS:  attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_INSTRUCTIONS;     break;
+        case BRANCH_MISSES: attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_BRANCH_MISSES;    break;
+        case L1D_MISSES:    attr.type = PERF_TYPE_HW_CACHE; attr.config = cache(PERF_COUNT_HW_CACHE_L1D);  break;
+        case LLC_MISSES:    attr.type = PERF_TYPE_HW_CACHE; attr.config = cache(PERF_COUNT_HW_CACHE_LL);   break;
+        case DTLB_MISSES:   attr.type = PERF_TYPE_HW_CACHE; attr.config = cache(PERF_COUNT_HW_CACHE_DTLB); break;
+        default: return -1; }
+        return int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+#else
+        (void)event; return -1;
+#endif
+    }
+};
@@ -7,6 +7,7 @@
 #define VALIDATOR_DEBUG
 #include "../include/Validator.hpp"
 #include <iostream>
+#include <string>
 
 #define MSG(msg) std::cout << msg << std::endl
 
@@ -110,6 +111,16 @@ template <class Data_t> void keyedDataMath(const VKeyedData_t<Data_t> &a, const
     std::cout << std::endl;
 }
 
+#if defined(V_ASYNC)
+/// @brief Async source that looks up a trait 3 value by id, completing on the calling thread.
+struct testLimitSource : VAsyncSource_t<uint32_t, uint32_t> {
+    using VAsyncSource_t::VAsyncSource_t;
+    void fetchBatch(const uint32_t *keys, const size_t &count, uint32_t *values, std::function<void()> done) override {
+        for (size_t i = 0; i < count; ++i) { values[i] = keys[i] % 12; }
+        done(); }
+};
+#endif
+
 template <class Data_t> void keyedListTest(const VKeyedList_t<Data_t> &list) {
     // std::cout << "Keyed list info: " <<= list;
     // std::cout << std::endl;
@@ -138,6 +149,15 @@ void main() {
     returnMath(ret1, ret2, blackKey);
     returnMath(perfRet, failRet, bigKey);
     returnMath(failRet, ret3, perfectKey);
+    returnMath(VReturn_t::PERFECT - 2, ret1, testKey); // Saturates below PERFECT
+
+    // VScorer_t testing...
+
+    VScorer_t scorer(std::vector<double>{1.0, 2.0, 0.5});
+    std::vector<VReturn_t> traitScores = {ret1, ret2, ret3};
+    VScore_t total = scorer.score(traitScores);
+    std::cout << "\nWeighted score: " << total.points() << ", as VReturn_t: " << total.toReturn()
+              << ", normalized: " << scorer.normalize(total, 10000) << std::endl;
 
     // Type flags testing...
 
@@ -184,6 +204,12 @@ void main() {
     std::cout << "\tintList(9):  " << intList(9)  << std::endl;
     std::cout << "\tintList(15): " << intList(15) << std::endl;
     std::cout << "\n";
+    std::cout << "\tintList.compile(): " << (intList.compile() ? "TRUE" : "FALSE") << std::endl;
+    std::cout << "\tintList(5):  " << intList(5)  << std::endl;
+    std::cout << "\tintList(15): " << intList(15) << std::endl;
+    std::cout << "\tintList(99): " << intList(99) << std::endl;
+    std::cout << "\tFilter bytes: " << intList.filter().memoryBytes() << ", FP rate: " << intList.filter().falsePositiveRate() << std::endl;
+    std::cout << "\n";
     std::cout << "\tfloatList.query(0.0f): " << floatList.query(0.0f) << std::endl;
     std::cout << "\tfloatList.query(1.0f): " << floatList.query(1.0f) << std::endl;
     std::cout << "\tfloatList.query(1.5f): " << floatList.query(1.5f) << std::endl;
@@ -192,6 +218,56 @@ void main() {
     std::cout << "\tfloatList.query(4.0f): " << floatList.query(4.0f) << std::endl;
     std::cout << "\tfloatList.query(5.0f): " << floatList.query(5.0f) << std::endl;
     std::cout << "\n";
+    VPerfectHash_t<float> floatIndex(floatList);
+    std::cout << "\tfloatIndex.query(1.0f): " << floatIndex.query(1.0f) << std::endl;
+    std::cout << "\tfloatIndex.query(1.5f): " << floatIndex.query(1.5f) << std::endl;
+    std::cout << "\tfloatIndex.query(5.0f): " << floatIndex.query(5.0f) << std::endl;
+    VToleranceIndex_t<float> floatNear(floatList, VTolerance_t::ULPS, 4), floatWide(floatList, VTolerance_t::ABSOLUTE, 0.5);
+    std::cout << "\tfloatList.query(1.0000001f): " << floatList.query(1.0000001f) << std::endl;
+    std::cout << "\tfloatNear.query(1.0000001f): " << floatNear.query(1.0000001f) << std::endl;
+    std::cout << "\tfloatNear.query(1.001f):     " << floatNear.query(1.001f) << std::endl;
+    std::cout << "\tfloatWide.query(1.5f):       " << floatWide.query(1.5f) << std::endl;
+    std::cout << "\tfloatWide.query(4.6f):       " << floatWide.query(4.6f) << std::endl;
+    std::cout << "\n";
+    VKeyedList_t<float> tempList(VKey_t::BLACKLIST, 37.5f);
+    tempList.setCurve({{{35.0f, 1}, {37.0f, 100}, {38.0f, 100}, {41.0f, 1}}, VCurve_t::LINEAR});
+    std::cout << "\ttempList(34.0f): " << tempList(34.0f) << std::endl;
+    std::cout << "\ttempList(36.0f): " << tempList(36.0f) << std::endl;
+    std::cout << "\ttempList(37.5f): " << tempList(37.5f) << std::endl;
+    std::cout << "\ttempList(39.5f): " << tempList(39.5f) << std::endl;
+    std::cout << "\n";
+    VKeyedList_t<int> globalList(VKey_t::BLACKLIST, {1, 2, 3});
+    VKeyedList_t<int> tenantList({{VKey_t::WHITELIST, 2}, {VKey_t(50), 4}, {VKey_t::BLACKLIST, 2}});
+    VKeyedList_t<int> merged = overrideOf(globalList, tenantList);
+    std::cout << "\toverrideOf(global, tenant).size(): " << merged.size() << std::endl;
+    std::cout << "\toverrideOf(global, tenant)(2): " << merged(2) << std::endl;
+    std::cout << "\toverrideOf(global, tenant)(4): " << merged(4) << std::endl;
+    std::cout << "\tunionOf(global, tenant, STRICTEST)(2): " << unionOf(globalList, tenantList, VPrecedence_t::STRICTEST)(2) << std::endl;
+    std::cout << "\tintersectionOf(global, tenant).size(): " << intersectionOf(globalList, tenantList).size() << std::endl;
+    std::cout << "\tdifferenceOf(global, tenant).size(): " << differenceOf(globalList, tenantList).size() << std::endl;
+    VTenantIndex_t<int> tenants({globalList, tenantList, merged});
+    std::vector<VReturn_t> allTenants = tenants.queryAll(2);
+    std::cout << "\ttenants(1, 2): " << tenants(1, 2) << ", tenants(2, 4): " << tenants(2, 4) << ", tenants(0, 4): " << tenants(0, 4) << std::endl;
+    std::cout << "\ttenants.queryAll(2): " << allTenants[0] << ", " << allTenants[1] << ", " << allTenants[2]
+              << " (" << tenants.size() << " values, " << tenants.numOverrides() << " overrides)" << std::endl;
+    VRoaringKeyedList_t<int> roaringGlobal(globalList), roaringTenant(VKey_t::WHITELIST, std::vector<int>{2, 3, 4, 5, 6});
+    std::cout << "\troaringGlobal(2): " << roaringGlobal(2) << ", roaringGlobal(9): " << roaringGlobal(9) << std::endl;
+    std::cout << "\tunionOf(roaringGlobal, roaringTenant, LOOSEST)(2): " << unionOf(roaringGlobal, roaringTenant, VPrecedence_t::LOOSEST)(2)
+              << ", (9): " << unionOf(roaringGlobal, roaringTenant, VPrecedence_t::LOOSEST)(9) << std::endl;
+    std::cout << "\tintersectionOf(roaringGlobal, roaringTenant).size(): " << intersectionOf(roaringGlobal, roaringTenant).size() << std::endl;
+    std::vector<uint32_t> idRun(100000);
+    for (size_t i = 0; i < idRun.size(); ++i) { idRun[i] = uint32_t(1000000 + i); }
+    VRoaringSet_t<uint32_t> ids(idRun);
+    std::cout << "\tids: " << ids.size() << " values, " << ids.numContainers(VContainer_t::RUNS) << " run containers, "
+              << ids.memoryBytes() << " bytes, contains(1050000): " << (ids.contains(1050000) ? "TRUE" : "FALSE") << std::endl;
+    std::cout << "\n";
+    std::vector<int> batch = {1, 2, 3, 4, 5};
+    VClassColumn_t classes;
+    queryColumn(merged, batch.data(), batch.size(), classes);
+    std::cout << "\tclasses.countPassing(): " << classes.countPassing() << " of " << classes.size() << std::endl;
+    std::cout << "\tclasses[3]: " << classes[3] << std::endl;
+    std::cout << "\targmax(merged, batch): " << argmax(merged, batch.data(), batch.size()) << std::endl;
+    std::cout << "\n";
     std::cout << "\tenumList -= testEnum::TIER1\n"; enumList -= testEnum::TIER1;
     std::cout << "\tenumList -= testEnum::TIER2\n"; enumList -= testEnum::TIER2;
     std::cout << "\tenumList -= testEnum::TIER3\n"; enumList -= testEnum::TIER3;
@@ -200,6 +276,16 @@ void main() {
     std::cout << "\tenumList.query(TIER4): " << enumList.query(testEnum::TIER4) << std::endl;
     std::cout << "\tenumList.query(TIER5): " << enumList.query(testEnum::TIER5) << std::endl;
 
+    VVariantKeyedList_t<int, float, std::string> variantList;
+    variantList.add(VKey_t::BLACKLIST, 5);
+    variantList.add(VKey_t(7), 2.5f);
+    variantList.add(std::string("name"));
+    std::cout << "\nVVariantKeyedList_t tests: " << std::endl;
+    std::cout << "\tvariantList(5):      " << variantList(5)    << std::endl;
+    std::cout << "\tvariantList(2.5f):   " << variantList(2.5f) << std::endl;
+    std::cout << "\tvariantList(\"name\"): " << variantList(std::string("name")) << std::endl;
+    std::cout << "\tvariantList(\"none\"): " << variantList(std::string("none")) << std::endl;
+
     // Validator tests:
 
     testLimits item1 = {10, 10, 10, {"Item1", 1}};
@@ -234,6 +320,95 @@ void main() {
 
     // auto bestItem = limitValidator.findBest({item1, item2, item3, item4});
 
+    VQueryCache_t<uint32_t> t3Cache(256);
+    std::cout << "\nValidator cache tests: " << std::endl;
+    std::cout << "\tt3Validator.validate(5, t3Cache):  " << t3Validator.validate( 5, t3Cache) << std::endl;
+    std::cout << "\tt3Validator.validate(5, t3Cache):  " << t3Validator.validate( 5, t3Cache) << std::endl;
+    std::cout << "\tt3Validator.validate(10, t3Cache): " << t3Validator.validate(10, t3Cache) << std::endl;
+    std::cout << "\tt3Validator.add(BLACKLIST, 10)\n"; t3Validator.add(VKey_t::BLACKLIST, uint32_t(10));
+    std::cout << "\tt3Validator.validate(10, t3Cache): " << t3Validator.validate(10, t3Cache) << std::endl;
+    std::cout << "\tt3Cache hit rate: " << t3Cache.hitRate() << std::endl;
+    VKeyedList_t<uint32_t> t3List(VKey_t::BLACKLIST, uint32_t(5)), t3Assigned;
+    t3Assigned = t3List;
+    std::cout << "\tt3Assigned = t3List, new version: " << (t3Assigned.version() != t3List.version() ? "true" : "false") << std::endl;
+
+    VBatcher_t<uint32_t> t3Batcher(t3Validator, 8, 100);
+    std::future<VReturn_t> t3Future5 = t3Batcher.submit(5), t3Future10 = t3Batcher.submit(10);
+    std::cout << "\nValidator batcher tests: " << std::endl;
+    std::cout << "\tt3Batcher.submit(5):  " << t3Future5.get()  << std::endl;
+    std::cout << "\tt3Batcher.submit(10): " << t3Future10.get() << std::endl;
+    std::cout << "\tt3Batcher(10):        " << t3Batcher(10)    << std::endl;
+    std::cout << "\tt3Batcher batches: " << t3Batcher.batches() << ", average wait: " << t3Batcher.averageWaitUs() << " us" << std::endl;
+
+    std::vector<uint32_t> candidates = {3, 4, 1, 5, 2, 9};
+    std::vector<double> hints = {0.3, 0.4, 0.1, 0.9, 0.2, 0.5};
+    VRanking_t top = t4_2Validator.rank(candidates, 2, VDeadline_t::never());
+    VRanking_t rushed = rankWithin(t4_2Validator, candidates.data(), candidates.size(), 2, VDeadline_t(std::chrono::microseconds(0)),
+                                   VRanking_t::priorityOrder(hints.data(), hints.size()).data(), 2);
+    std::cout << "\nValidator deadline ranking tests: " << std::endl;
+    std::cout << "\ttop: " << candidates[top.best()] << " (" << top.results[0] << "), " << candidates[top.indices[1]]
+              << " (" << top.results[1] << "), evaluated: " << top.evaluated << ", partial: " << (top.partial ? "TRUE" : "FALSE") << std::endl;
+    std::cout << "\trushed: " << candidates[rushed.best()] << ", ranked: " << rushed.size() << ", evaluated: " << rushed.evaluated
+              << ", partial: " << (rushed.partial ? "TRUE" : "FALSE") << std::endl;
+
+    std::cout << "\nValidator memory usage tests: " << std::endl;
+    std::cout << "\tt3Validator.memoryUsage(): " << t3Validator.memoryUsage() << std::endl;
+    std::cout << "\tt3Validator.shrinkToFit(): " << t3Validator.shrinkToFit() << " bytes released" << std::endl;
+    std::cout << "\tt3Validator.memoryUsage(): " << t3Validator.memoryUsage() << std::endl;
+    std::cout << "\tVPerfectHash_t(t3Validator.list()).memoryUsage(): " << VPerfectHash_t<uint32_t>(t3Validator.list()).memoryUsage() << std::endl;
+
+    VKeyedList_t<int> sizes({{VKey_t(10), 1}, {VKey_t(20), 2}, {VKey_t(30), 3}}), colors({{VKey_t(5), 1}, {VKey_t(15), 2}});
+    VIncrementalRanking_t<int> pool({&sizes, &colors}, {{1, 1}, {2, 2}, {3, 1}, {3, 2}}, 2);
+    std::cout << "\nValidator incremental ranking tests: " << std::endl;
+    std::cout << "\tpool.best(): " << pool.best() << " (" << pool.result(pool.best()) << ")" << std::endl;
+    sizes.rekey(3, VKey_t::BLACKLIST);
+    std::cout << "\tsizes.rekey(3, BLACKLIST), pool.update(0, 3): " << pool.update(0, 3) << " rescored, best: " << pool.best()
+              << " (" << pool.result(pool.best()) << "), result(3): " << pool.result(3) << std::endl;
+    sizes.remove(2);
+    std::cout << "\tsizes.remove(2), pool.update(0, 2): " << pool.update(0, 2) << " rescored, best: " << pool.best()
+              << ", current: " << (pool.current() ? "TRUE" : "FALSE") << std::endl;
+
+#if defined(V_ASYNC)
+    VAsyncScheduler_t scheduler;
+    testLimitSource limitSource(scheduler, 4);
+    std::vector<VTask_t<VReturn_t>> asyncTasks;
+    for (uint32_t id : {5, 15, 17, 22, 29}) { asyncTasks.push_back(t3Validator.validateAsync(limitSource, id)); }
+    std::vector<VReturn_t> asyncResults = scheduler.runAll(std::move(asyncTasks));
+    std::cout << "\nValidator async tests: " << std::endl;
+    std::cout << "\tt3Validator.validateAsync(limitSource, 5):  " << scheduler.run(t3Validator.validateAsync(limitSource, 5u)) << std::endl;
+    std::cout << "\tt3Validator.validateAsync(limitSource, {5, 15, 17, 22, 29}): " << asyncResults[0] << ", " << asyncResults[1] << ", "
+              << asyncResults[2] << ", " << asyncResults[3] << ", " << asyncResults[4] << " (" << limitSource.batches() << " batches)" << std::endl;
+#endif
+
+    VStructValidator_t<testLimits> structValidator(VOrder_t::ADAPTIVE, 2);
+    structValidator.addTrait(t1Validator, [](const testLimits &l) { return l.trait1; });
+    structValidator.addTrait(t2Validator, [](const testLimits &l) { return l.trait2; });
+    structValidator.addTrait(t3Validator, [](const testLimits &l) { return l.trait3; }, 1.0, 0.5);
+    structValidator.addTrait(t4_2Validator, [](const testLimits &l) { return l.trait4.id; });
+    std::cout << "\nVStructValidator_t tests: " << std::endl;
+    for (const auto &item : {item1, item2, item3, item4}) {
+        std::cout << "\tstructValidator(" << item.trait4.name << "): " << structValidator(item) << std::endl; }
+    std::cout << "\tEvaluation order:";
+    for (const auto &i : structValidator.order()) { std::cout << " " << i; }
+    std::cout << std::endl;
+
+    // trait1 whitelisted AND (trait2 in [18, 30] OR trait3 not blacklisted)
+    VExpression_t<testLimits> expr;
+    VRangeSet_t<uint32_t> t2Range({VRange_t<uint32_t>(18, 30)});
+    auto inWhitelist = expr.leaf(t1Validator, [](const testLimits &l) { return l.trait1; });
+    auto inRange     = expr.leaf(t2Range,     [](const testLimits &l) { return l.trait2; });
+    auto blacklisted = !expr.leaf(t3Validator, [](const testLimits &l) { return l.trait3; });
+    expr.compile(inWhitelist && (inRange || !blacklisted));
+    std::vector<testLimits> items = {item1, item2, item3, item4};
+    std::vector<VReturn_t> exprBatch = expr.validate(items);
+    std::cout << "\nVExpression_t tests (" << expr.programSize() << " program nodes): " << std::endl;
+    for (size_t i = 0; i < items.size(); ++i) {
+        std::cout << "\texpr(" << items[i].trait4.name << "): " << expr(items[i]) << ", batch: " << exprBatch[i] << std::endl; }
+    VExpression_t<testLimits> ranked;
+    ranked.compile(ranked.weightedSum({{ranked.leaf(t4_2Validator, [](const testLimits &l) { return l.trait4.id; }), 2.0},
+                                       {ranked.leaf(structValidator), 0.5}}));
+    std::cout << "\tranked(Item4): " << ranked(item4) << std::endl;
+
 // // Lets assume something has 4 int traits and we want to find the best candidate out of a list of candidates
 //     // 1. Create a validator for each trait
 //     Validator<int> V1, V2, V3, V4;
@@ -0,0 +1,108 @@
+#pragma once
+/**
+ * @file tools/client.hpp
+ * @author Ray Richter
+ * @brief VClient_t Class declaration. A blocking client for the validation daemon.
+ * @note `submit` queues requests and `receive` reads responses in order, so many requests can be in flight on one
+ * connection. `validate` and `rank` are one request round trips.
+ */
+#include "protocol.hpp"
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// @brief Internal Validator namespace.                                                                                  ////
+namespace Validspace {                                                                                                     ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief A connection to the validation daemon.
+class VClient_t {
+    public:
+    /// @brief Constructor. Connects to `socketPath`, see `connected`.
+    VClient_t(const std::string &socketPath = VProtocol::DEFAULT_SOCKET) { connect(socketPath); }
+    ~VClient_t() { if (fd_ >= 0) close(fd_); }
+    VClient_t(const VClient_t&) = delete;
+    VClient_t& operator=(const VClient_t&) = delete;
+
+    /// @brief Connects, closing any previous connection.
+    bool connect(const std::string &socketPath) {
+        if (fd_ >= 0) { close(fd_); fd_ = -1; }
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (socketPath.size() >= sizeof(addr.sun_path)) return false;
+        std::strcpy(addr.sun_path, socketPath.c_str());
+        fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd_ >= 0 && ::connect(fd_, (sockaddr*)&addr, sizeof(addr)) == 0) return true;
+        if (fd_ >= 0) { close(fd_); fd_ = -1; }
+        return false; }
+    /// @brief Checks if the client is connected.
+    bool connected() const { return fd_ >= 0; }
+
+    /// @brief Queues a request. Sent by `flush` or `receive`.
+    /// @tparam T `int64_t` or `double`, matching the rule set type.
+    /// @return Request id.
+    template <class T> uint32_t submit(const VProtocol::Op_t &op, const std::string &rules, const T *values, const size_t &count) {
+        VProtocol::appendRequest(out_, ++lastId_, op, rules, values, count);
+        return lastId_; }
+    template <class T> uint32_t submit(const VProtocol::Op_t &op, const std::string &rules, const std::vector<T> &values) {
+        return submit(op, rules, values.data(), values.size()); }
+
+    /// @brief Sends every queued request.
+    bool flush() {
+        size_t sent = 0;
+        while (sent < out_.size() && fd_ >= 0) {
+            ssize_t n = send(fd_, out_.data() + sent, out_.size() - sent, MSG_NOSIGNAL);
+            if (n > 0) { sent += size_t(n); continue; }
+            if (n < 0 && errno == EINTR) continue;
+            close(fd_); fd_ = -1; }
+        out_.clear();
+        return fd_ >= 0; }
+
+    /// @brief Sends queued requests, then waits for the next response.
+    /// @return `false` if the connection failed.
+    bool receive(VResponse_t &response) {
+        if (!flush()) return false;
+        uint8_t header[VProtocol::HEADER_SIZE];
+        if (!_read(header, sizeof(header))) return false;
+        const VProtocol::Header_t h = VProtocol::getHeader(header);
+        if (size_t(h.length) + 4 > VProtocol::MAX_FRAME_SIZE || h.length + 4 < VProtocol::HEADER_SIZE) { close(fd_); fd_ = -1; return false; }
+        in_.resize(h.length + 4 - VProtocol::HEADER_SIZE);
+        if (!_read(in_.data(), in_.size())) return false;
+        VProtocol::readResponse(h, in_.data(), in_.size(), response);
+        return true; }
+
+    /// @brief Validates a batch of values with one round trip.
+    /// @return Scores in request order, or empty on error.
+    template <class T> std::vector<VReturn_t> validate(const std::string &rules, const std::vector<T> &values) {
+        VResponse_t response;
+        submit(VProtocol::VALIDATE, rules, values);
+        if (!receive(response) || response.status != VProtocol::OK) return {};
+        return response.scores; }
+
+    /// @brief Ranks a batch of candidates with one round trip.
+    /// @return Response with candidate indices and scores, best first.
+    template <class T> VResponse_t rank(const std::string &rules, const std::vector<T> &values) {
+        VResponse_t response;
+        submit(VProtocol::RANK, rules, values);
+        receive(response);
+        return response; }
+
+    private:
+    int fd_ = -1;
+    uint32_t lastId_ = 0;
+    std::vector<uint8_t> out_{}, in_{};
+
+    bool _read(uint8_t *p, size_t size) {
+        while (size && fd_ >= 0) {
+            ssize_t n = recv(fd_, p, size, 0);
+            if (n > 0) { p += n; size -= size_t(n); continue; }
+            if (n < 0 && errno == EINTR) continue;
+            close(fd_); fd_ = -1; }
+        return fd_ >= 0; }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+} // END: namespace Validspace                                                                                             ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,91 @@
+/**
+ * @file tools/loadgen.cpp
+ * @author Ray Richter
+ * @brief Load generator for the validation daemon.
+ * Usage: `validator_loadgen <rule set> [int|float] [connections] [pipeline depth] [batch size] [seconds] [socket path]`
+ * @note Every connection runs on its own thread and keeps `pipeline depth` requests in flight. Values are drawn from
+ * `[0, 2^20)`. Reports requests and values per second, and request latency percentiles.
+ */
+
+#include "client.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+
+using Validspace::VClient_t;
+using Validspace::VResponse_t;
+namespace VProtocol = Validspace::VProtocol;
+
+#define MSG(msg) std::cout << msg << std::endl
+
+using loadClock = std::chrono::steady_clock;
+
+/// @brief Per connection results.
+struct LoadResult_t {
+    size_t requests = 0, errors = 0;
+    std::vector<double> latencyUs{};
+};
+
+template <class T> void runConnection(const std::string &socketPath, const std::string &rules, const size_t &depth,
+                                      const size_t &batch, const loadClock::time_point &end, const uint32_t &seed,
+                                      LoadResult_t &result) {
+    VClient_t client(socketPath);
+    if (!client.connected()) { result.errors = 1; return; }
+    std::mt19937 rng(seed);
+    std::vector<T> values(batch);
+    std::vector<loadClock::time_point> sent;
+    auto submitOne = [&] {
+        for (auto &v : values) { v = T(rng() & 0xfffff); }
+        client.submit(VProtocol::VALIDATE, rules, values);
+        sent.push_back(loadClock::now()); };
+    for (size_t i = 0; i < depth; ++i) { submitOne(); }
+    VResponse_t response;
+    size_t next = 0;
+    while (client.receive(response)) {
+        std::chrono::duration<double, std::micro> latency = loadClock::now() - sent[next++];
+        result.latencyUs.push_back(latency.count());
+        ++result.requests;
+        result.errors += response.status != VProtocol::OK || response.scores.size() != batch;
+        if (next == sent.size() && loadClock::now() >= end) break;
+        if (loadClock::now() < end) { submitOne(); }}}
+
+int main(int argc, char **argv) {
+    if (argc < 2) { MSG("Usage: validator_loadgen <rule set> [int|float] [connections] [pipeline depth] [batch size] [seconds] [socket path]"); return 1; }
+    const std::string rules      = argv[1];
+    const bool        floats     = (argc > 2) && std::string(argv[2]) == "float";
+    const size_t      numConns   = (argc > 3) ? std::stoull(argv[3]) : 4;
+    const size_t      depth      = (argc > 4) ? std::max<size_t>(std::stoull(argv[4]), 1) : 8;
+    const size_t      batch      = (argc > 5) ? std::max<size_t>(std::stoull(argv[5]), 1) : 64;
+    const double      seconds    = (argc > 6) ? std::stod(argv[6]) : 5.0;
+    const std::string socketPath = (argc > 7) ? argv[7] : VProtocol::DEFAULT_SOCKET;
+
+    std::vector<LoadResult_t> results(numConns);
+    std::vector<std::thread> threads;
+    const auto start = loadClock::now();
+    const auto end = start + std::chrono::microseconds(int64_t(seconds * 1e6));
+    for (size_t c = 0; c < numConns; ++c) {
+        threads.emplace_back([&, c] {
+            if (floats) { runConnection<double >(socketPath, rules, depth, batch, end, uint32_t(c + 1), results[c]); }
+            else        { runConnection<int64_t>(socketPath, rules, depth, batch, end, uint32_t(c + 1), results[c]); }}); }
+    for (auto &thread : threads) { thread.join(); }
+    std::chrono::duration<double> elapsed = loadClock::now() - start;
+
+    size_t requests = 0, errors = 0;
+    std::vector<double> latency;
+    for (const auto &r : results) {
+        requests += r.requests; errors += r.errors;
+        latency.insert(latency.end(), r.latencyUs.begin(), r.latencyUs.end()); }
+    std::sort(latency.begin(), latency.end());
+    auto percentile = [&](const double &p) { return latency.empty() ? 0.0 : latency[size_t(p * double(latency.size() - 1))]; };
+
+    MSG("Load (" << numConns << " connections, depth " << depth << ", batch " << batch << ", " << elapsed.count() << " s):");
+    MSG("\tRequests:          " << double(requests) / elapsed.count() << " /s");
+    MSG("\tValues:            " << double(requests * batch) / elapsed.count() << " /s");
+    MSG("\tLatency p50:       " << percentile(0.50) << " us");
+    MSG("\tLatency p99:       " << percentile(0.99) << " us");
+    MSG("\tLatency max:       " << percentile(1.00) << " us");
+    if (errors != 0) { MSG("\tWARNING: " << errors << " failed requests or connections!"); }
+    return errors != 0;
+}
@@ -0,0 +1,164 @@
+#pragma once
+/**
+ * @file tools/protocol.hpp
+ * @author Ray Richter
+ * @brief Binary framing shared by the validation daemon and its clients.
+ * @note Every frame is a fixed 16 byte little endian header followed by a payload. Clients may pipeline any number of
+ * requests on one connection, and the daemon answers each request with one response in the order it was received.
+ *
+ * Request:  | u32 length | u32 id | u8 op | u8 type | u16 nameLength | u32 count | name | count x 8 byte values |
+ * Response: | u32 length | u32 id | u8 op | u8 status | u16 reserved  | u32 count | payload                      |
+ *
+ * `length` counts the bytes after the length field. Values are `int64_t` or `double` (`type`). Scores are `uint64_t`
+ * with `FAIL` = 2^64 - 1 and `PERFECT` = 2^64 - 2, whatever `uint_t` width the library was built with.
+ * - VALIDATE payload: count x u64 score, in request order.
+ * - RANK payload:     count x (u32 index, u64 score), best first. `FAIL` candidates are last, ties keep request order.
+ * A RANK response takes 12 bytes per value, so RANK requests are limited to `MAX_RANK_COUNT` values. Larger ones, and
+ * any request whose response would not fit in `MAX_FRAME_SIZE`, are answered with `BAD_REQUEST`.
+ */
+#include "../include/Validator.hpp"
+#include <cstring>
+#include <string>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// @brief Internal Validator namespace.                                                                                  ////
+namespace Validspace {                                                                                                     ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace VProtocol {
+
+/// @brief Header size of every frame in bytes.
+constexpr size_t   HEADER_SIZE    = 16;
+/// @brief Largest accepted frame, length field included.
+constexpr size_t   MAX_FRAME_SIZE = size_t(64) << 20;
+/// @brief Largest RANK count whose response fits in `MAX_FRAME_SIZE`.
+constexpr size_t   MAX_RANK_COUNT = (MAX_FRAME_SIZE - HEADER_SIZE) / 12;
+/// @brief Default socket path.
+constexpr const char *DEFAULT_SOCKET = "/tmp/validatord.sock";
+
+/// @brief Wire scores for the special values.
+constexpr uint64_t WIRE_FAIL    = UINT64_MAX;
+constexpr uint64_t WIRE_PERFECT = UINT64_MAX - 1;
+
+/// @brief Request operations.
+enum Op_t : uint8_t { VALIDATE = 1, RANK = 2 };
+/// @brief Value types.
+enum Type_t : uint8_t { INT64 = 0, DOUBLE = 1 };
+/// @brief Response status codes.
+enum Status_t : uint8_t { OK = 0, UNKNOWN_RULES = 1, BAD_REQUEST = 2, WRONG_TYPE = 3 };
+
+} // END: namespace VProtocol
+
+/// @brief A decoded daemon response.
+struct VResponse_t {
+    uint32_t id     = 0;
+    uint8_t  op     = 0;
+    uint8_t  status = VProtocol::BAD_REQUEST;
+    std::vector<VReturn_t> scores{}; // VALIDATE: in request order. RANK: best first
+    std::vector<uint32_t>  order{};  // RANK: candidate indices, best first
+};
+
+namespace VProtocol {
+
+/// @brief A decoded frame header. `aux` = value type in requests, status in responses.
+struct Header_t {
+    uint32_t length     = 0;
+    uint32_t id         = 0;
+    uint8_t  op         = 0;
+    uint8_t  aux        = 0;
+    uint16_t nameLength = 0;
+    uint32_t count      = 0; };
+
+inline void putU16(uint8_t *p, const uint16_t &v) { p[0] = uint8_t(v); p[1] = uint8_t(v >> 8); }
+inline void putU32(uint8_t *p, const uint32_t &v) { for (size_t i = 0; i < 4; ++i) { p[i] = uint8_t(v >> (8 * i)); }}
+inline void putU64(uint8_t *p, const uint64_t &v) { for (size_t i = 0; i < 8; ++i) { p[i] = uint8_t(v >> (8 * i)); }}
+inline uint16_t getU16(const uint8_t *p) { return uint16_t(p[0] | (p[1] << 8)); }
+inline uint32_t getU32(const uint8_t *p) { uint32_t v = 0; for (size_t i = 0; i < 4; ++i) { v |= uint32_t(p[i]) << (8 * i); } return v; }
+inline uint64_t getU64(const uint8_t *p) { uint64_t v = 0; for (size_t i = 0; i < 8; ++i) { v |= uint64_t(p[i]) << (8 * i); } return v; }
+
+/// @brief Writes a header to `HEADER_SIZE` bytes.
+inline void putHeader(uint8_t *p, const Header_t &h) {
+    putU32(p, h.length); putU32(p + 4, h.id); p[8] = h.op; p[9] = h.aux; putU16(p + 10, h.nameLength); putU32(p + 12, h.count); }
+/// @brief Reads a header from `HEADER_SIZE` bytes.
+inline Header_t getHeader(const uint8_t *p) {
+    return {getU32(p), getU32(p + 4), p[8], p[9], getU16(p + 10), getU32(p + 12)}; }
+
+/// @brief Converts a score to its wire value.
+inline uint64_t toWire(const VReturn_t &ret) {
+    if (!ret) return WIRE_FAIL;
+    if (*ret) return WIRE_PERFECT;
+    return uint64_t(ret()); }
+/// @brief Converts a wire value to a score.
+inline VReturn_t fromWire(const uint64_t &score) {
+    if (score == WIRE_FAIL)    return VReturn_t::FAIL;
+    if (score == WIRE_PERFECT) return VReturn_t::PERFECT;
+    return VReturn_t(uint_t(std::min<uint64_t>(score, VReturn_t::PERFECT - 1))); }
+
+/// @brief Value bits of an `int64_t` or `double`.
+inline uint64_t valueBits(const int64_t &v) { return uint64_t(v); }
+inline uint64_t valueBits(const double &v)  { uint64_t b; std::memcpy(&b, &v, sizeof(b)); return b; }
+/// @brief Value from its bits.
+template <class T> T fromBits(const uint64_t &b) { T v; std::memcpy(&v, &b, sizeof(v)); return v; }
+
+/// @brief Appends a request frame to a buffer.
+template <class T> void appendRequest(std::vector<uint8_t> &out, const uint32_t &id, const Op_t &op,
+                                      const std::string &name, const T *values, const size_t &count) {
+    static_assert(std::is_same<T, int64_t>::value || std::is_same<T, double>::value, "Values must be int64_t or double.");
+    const size_t start = out.size(), size = HEADER_SIZE + name.size() + count * 8;
+    out.resize(start + size);
+    uint8_t *p = out.data() + start;
+    putHeader(p, {uint32_t(size - 4), id, op, std::is_same<T, double>::value ? DOUBLE : INT64, uint16_t(name.size()), uint32_t(count)});
+    std::memcpy(p + HEADER_SIZE, name.data(), name.size());
+    p += HEADER_SIZE + name.size();
+    for (size_t i = 0; i < count; ++i) { putU64(p + i * 8, valueBits(values[i])); }}
+
+/// @brief Gets the size of the response to a request, length field included.
+inline size_t responseSize(const uint8_t &op, const size_t &count) { return HEADER_SIZE + count * ((op == RANK) ? 12 : 8); }
+
+/// @brief Checks a request frame of `size` bytes, length field included.
+/// @return `BAD_REQUEST` if the sizes do not match the header, the op or type is unknown, or the response would be
+/// larger than `MAX_FRAME_SIZE`. `OK` otherwise.
+inline Status_t checkRequest(const uint8_t *frame, const size_t &size) {
+    if (size < HEADER_SIZE) return BAD_REQUEST;
+    const Header_t h = getHeader(frame);
+    if (size_t(h.length) + 4 != size || HEADER_SIZE + size_t(h.nameLength) + size_t(h.count) * 8 != size) return BAD_REQUEST;
+    if ((h.op != VALIDATE && h.op != RANK) || (h.aux != INT64 && h.aux != DOUBLE)) return BAD_REQUEST;
+    if (responseSize(h.op, h.count) > MAX_FRAME_SIZE) return BAD_REQUEST;
+    return OK; }
+
+/// @brief Appends a response frame with a status and no payload.
+inline void appendStatus(std::vector<uint8_t> &out, const uint32_t &id, const uint8_t &op, const Status_t &status) {
+    out.resize(out.size() + HEADER_SIZE);
+    putHeader(out.data() + out.size() - HEADER_SIZE, {uint32_t(HEADER_SIZE - 4), id, op, status, 0, 0}); }
+
+/// @brief Appends an `OK` response frame. VALIDATE writes `scores` in request order. RANK writes `order[i]` and its
+/// score, so `order` must hold `count` indices into `scores`, best first.
+inline void appendResponse(std::vector<uint8_t> &out, const uint32_t &id, const uint8_t &op, const VReturn_t *scores,
+                           const uint32_t *order, const size_t &count) {
+    const size_t size = responseSize(op, count), start = out.size();
+    out.resize(start + size);
+    uint8_t *p = out.data() + start;
+    putHeader(p, {uint32_t(size - 4), id, op, OK, 0, uint32_t(count)});
+    p += HEADER_SIZE;
+    if (op == RANK) { for (size_t i = 0; i < count; ++i) { putU32(p + i * 12, order[i]); putU64(p + i * 12 + 4, toWire(scores[order[i]])); }}
+    else            { for (size_t i = 0; i < count; ++i) { putU64(p + i * 8, toWire(scores[i])); }}}
+
+/// @brief Decodes a response from its header and the `size` payload bytes after it. A payload that does not match the
+/// op and count leaves `scores` and `order` empty.
+inline void readResponse(const Header_t &h, const uint8_t *payload, const size_t &size, VResponse_t &response) {
+    response.id = h.id; response.op = h.op; response.status = h.aux;
+    response.scores.resize(h.count); response.order.clear();
+    if (h.op == RANK && size == size_t(h.count) * 12) {
+        response.order.resize(h.count);
+        for (size_t i = 0; i < h.count; ++i) {
+            response.order[i]  = getU32(payload + i * 12);
+            response.scores[i] = fromWire(getU64(payload + i * 12 + 4)); }}
+    else if (size == size_t(h.count) * 8) {
+        for (size_t i = 0; i < h.count; ++i) { response.scores[i] = fromWire(getU64(payload + i * 8)); }}
+    else { response.scores.clear(); }}
+
+} // END: namespace VProtocol
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+} // END: namespace Validspace                                                                                             ////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
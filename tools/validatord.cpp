@@ -0,0 +1,385 @@
+/**
+ * @file tools/validatord.cpp
+ * @author Ray Richter
+ * @brief Local validation daemon. Serves batched validate and rank requests for a directory of rule files over a Unix
+ * domain socket. See `protocol.hpp` for the framing. Usage: `validatord [rules directory] [socket path]`
+ * @note Rule files are named `<rule set name>.rules`, one keyed value per line:
+ *     # Comment
+ *     type float         <- `int` (default) or `float`
+ *     BLACKLIST 3.5      <- WHITELIST, BLACKLIST, PERFECT, or a score, then the value
+ *     7 2.0
+ * Files are loaded into a `VKeyedList_t` and frozen into a `VPerfectHash_t`. Changed, new, and deleted files are
+ * picked up with inotify while the daemon runs and loaded on a loader thread, so a large file does not stall clients.
+ * One epoll thread serves every connection and swaps finished rule sets in between requests, so requests never see a
+ * rule set change halfway through a batch. A connection is not read while it has `MAX_BUFFERED` bytes of replies the
+ * client has not taken, so a client that never reads cannot grow the daemon without bound.
+ */
+
+#include "protocol.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <csignal>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace Validspace::VProtocol;
+using Validspace::uint_t;
+
+#define LOG(msg) std::cerr << "validatord: " << msg << std::endl
+
+/// @brief Unsent reply bytes at which a connection stops being read, and buffered request bytes at which reading pauses.
+constexpr size_t MAX_BUFFERED = size_t(4) << 20;
+
+/// @brief A frozen rule set of one value type.
+template <class T> struct RuleIndex_t {
+    VKeyedList_t<T>   list;
+    VPerfectHash_t<T> index;
+    bool indexed = false;
+
+    explicit RuleIndex_t(const VKeyedList_t<T> &kl) : list(kl) {
+        indexed = index.build(list);
+        if (!indexed) { list.compile(); }}
+
+    void validate(const T *values, const size_t &count, VReturn_t *out) const {
+        if (!indexed) { list.query(values, count, out); return; }
+        for (size_t i = 0; i < count; ++i) { out[i] = index.query(values[i]); }}
+};
+
+/// @brief A loaded rule file.
+struct RuleSet_t {
+    Type_t type = INT64;
+    std::unique_ptr<RuleIndex_t<int64_t>> ints;
+    std::unique_ptr<RuleIndex_t<double>>  floats;
+    size_t size() const { return ints ? ints->list.size() : floats ? floats->list.size() : 0; }
+};
+
+/// @brief Parses a key. WHITELIST, BLACKLIST, PERFECT, or a score.
+static bool parseKey(const std::string &word, VKey_t &key) {
+    if (word == "WHITELIST") { key = VKey_t::WHITELIST; return true; }
+    if (word == "BLACKLIST") { key = VKey_t::BLACKLIST; return true; }
+    if (word == "PERFECT")   { key = VKey_t::PERFECT;   return true; }
+    try { size_t used = 0; unsigned long long v = std::stoull(word, &used);
+          if (used != word.size() || v >= VKey_t::MINIMUM) return false;
+          key = VKey_t(uint_t(v)); return true; }
+    catch (...) { return false; }}
+
+/// @brief Loads a rule file.
+/// @return `nullptr` if the file could not be read or has a bad line.
+static std::unique_ptr<RuleSet_t> loadRules(const std::string &path) {
+    std::ifstream file(path);
+    if (!file) return nullptr;
+    auto rules = std::make_unique<RuleSet_t>();
+    VKeyedList_t<int64_t> ints;
+    VKeyedList_t<double>  floats;
+    std::string line;
+    for (size_t lineNum = 1; std::getline(file, line); ++lineNum) {
+        std::istringstream words(line.substr(0, line.find('#')));
+        std::string first, second;
+        if (!(words >> first)) continue;
+        if (first == "type") {
+            words >> second;
+            if (second != "int" && second != "float") { LOG(path << ":" << lineNum << ": unknown type " << second); return nullptr; }
+            rules->type = (second == "float") ? DOUBLE : INT64; continue; }
+        VKey_t key;
+        if (!parseKey(first, key) || !(words >> second)) { LOG(path << ":" << lineNum << ": bad rule"); return nullptr; }
+        try {
+            if (rules->type == DOUBLE) { floats.add(key, std::stod(second)); }
+            else                       { ints.add(key, int64_t(std::stoll(second))); }}
+        catch (...) { LOG(path << ":" << lineNum << ": bad value " << second); return nullptr; }}
+    if (rules->type == DOUBLE) { rules->floats = std::make_unique<RuleIndex_t<double>>(floats); }
+    else                       { rules->ints   = std::make_unique<RuleIndex_t<int64_t>>(ints); }
+    return rules; }
+
+/// @brief Gets the rule set name of a rule file, or "" if it is not a rule file.
+static std::string ruleName(const std::string &fileName) {
+    const std::string ext = ".rules";
+    if (fileName.size() <= ext.size() || fileName.compare(fileName.size() - ext.size(), ext.size(), ext) != 0) return "";
+    return fileName.substr(0, fileName.size() - ext.size()); }
+
+/// @brief A rule file loaded off the event loop.
+struct Loaded_t {
+    std::string name;                 // Rule set name, "" if the file is not a rule file
+    std::unique_ptr<RuleSet_t> rules; // `nullptr` if the file was removed or is bad
+    bool removed = false;
+};
+
+/// @brief Loads one rule file, or notes that it was removed.
+static Loaded_t loadFile(const std::string &rulesDir, const std::string &fileName) {
+    Loaded_t ret;
+    ret.name = ruleName(fileName);
+    if (ret.name.empty()) return ret;
+    const std::string path = rulesDir + "/" + fileName;
+    if (access(path.c_str(), F_OK) != 0) { ret.removed = true; return ret; }
+    ret.rules = loadRules(path);
+    return ret; }
+
+/// @brief A client connection.
+struct Connection_t {
+    int fd = -1;
+    std::vector<uint8_t> in, out;
+    size_t outSent = 0;
+    uint32_t events = EPOLLIN | EPOLLRDHUP; // Watched epoll events
+    bool hungUp = false;                    // The client sends no more requests
+};
+
+class Daemon_t {
+    public:
+    Daemon_t(const std::string &rulesDir, const std::string &socketPath) : rulesDir_(rulesDir), socketPath_(socketPath) {}
+
+    /// @brief Runs the event loop until `stop` is set.
+    /// @return Process exit code.
+    int run(volatile std::sig_atomic_t &stop) {
+        epoll_ = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_ < 0 || !_listen() || !_watch()) return 1;
+        _loadAll();
+        loader_ = std::thread([this]() { _loadLoop(); });
+        LOG("serving " << rules_.size() << " rule set(s) from " << rulesDir_ << " on " << socketPath_);
+        std::vector<epoll_event> events(256);
+        while (!stop) {
+            int n = epoll_wait(epoll_, events.data(), int(events.size()), 500);
+            if (n < 0 && errno != EINTR) { LOG("epoll_wait failed: " << errno); break; }
+            for (int i = 0; i < n; ++i) {
+                const int fd = events[i].data.fd;
+                if      (fd == listen_) { _accept(); }
+                else if (fd == notify_) { _reload(); }
+                else if (fd == loaded_) { _swapLoaded(); }
+                else                    { _serve(fd, events[i].events); }}}
+        { std::lock_guard<std::mutex> lock(loadMutex_); stopLoader_ = true; }
+        loadWake_.notify_one(); loader_.join();
+        for (auto &c : connections_) { close(c.first); }
+        close(listen_); close(notify_); close(loaded_); close(epoll_);
+        unlink(socketPath_.c_str());
+        return 0; }
+
+    private:
+    std::string rulesDir_, socketPath_;
+    int epoll_ = -1, listen_ = -1, notify_ = -1;
+    int loaded_ = -1; // eventfd, signaled when the loader finishes files
+    std::map<std::string, std::unique_ptr<RuleSet_t>> rules_;
+    std::map<int, Connection_t> connections_;
+    std::thread loader_;
+    std::mutex loadMutex_;
+    std::condition_variable loadWake_;
+    std::deque<std::string> toLoad_;     // Guarded by loadMutex_
+    std::vector<Loaded_t>   finished_;   // Guarded by loadMutex_
+    bool stopLoader_ = false;            // Guarded by loadMutex_
+    std::vector<int64_t> ints_;
+    std::vector<double> floats_;
+    std::vector<VReturn_t> results_;
+    std::vector<uint32_t> order_;
+
+    bool _listen() {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (socketPath_.size() >= sizeof(addr.sun_path)) { LOG("socket path too long"); return false; }
+        std::strcpy(addr.sun_path, socketPath_.c_str());
+        listen_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        unlink(socketPath_.c_str());
+        if (listen_ < 0 || bind(listen_, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listen_, 128) != 0) {
+            LOG("cannot listen on " << socketPath_ << ": " << std::strerror(errno)); return false; }
+        epoll_event ev{EPOLLIN, {}}; ev.data.fd = listen_;
+        return epoll_ctl(epoll_, EPOLL_CTL_ADD, listen_, &ev) == 0; }
+
+    bool _watch() {
+        notify_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (notify_ < 0 || inotify_add_watch(notify_, rulesDir_.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE) < 0) {
+            LOG("cannot watch " << rulesDir_ << ": " << std::strerror(errno)); return false; }
+        loaded_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        epoll_event ev{EPOLLIN, {}}; ev.data.fd = notify_;
+        epoll_event done{EPOLLIN, {}}; done.data.fd = loaded_;
+        return loaded_ >= 0 && epoll_ctl(epoll_, EPOLL_CTL_ADD, notify_, &ev) == 0 && epoll_ctl(epoll_, EPOLL_CTL_ADD, loaded_, &done) == 0; }
+
+    /// @brief Loads every rule file before serving starts.
+    void _loadAll() {
+        DIR *dir = opendir(rulesDir_.c_str());
+        if (!dir) return;
+        while (const dirent *entry = readdir(dir)) { _apply(loadFile(rulesDir_, entry->d_name)); }
+        closedir(dir); }
+
+    /// @brief Replaces or removes the rule set of one loaded file. A bad file keeps the previous rule set.
+    void _apply(Loaded_t &&loaded) {
+        if (loaded.name.empty()) return;
+        if (loaded.removed) {
+            if (rules_.erase(loaded.name)) { LOG("removed " << loaded.name); }
+            return; }
+        if (!loaded.rules) { LOG("kept the previous version of " << loaded.name); return; }
+        LOG((rules_.count(loaded.name) ? "reloaded " : "loaded ") << loaded.name << " (" << loaded.rules->size() << " entries)");
+        rules_[loaded.name] = std::move(loaded.rules); }
+
+    /// @brief Queues changed files for the loader thread. A file already waiting is not queued twice.
+    void _reload() {
+        alignas(inotify_event) char buffer[16384];
+        std::lock_guard<std::mutex> lock(loadMutex_);
+        for (;;) {
+            ssize_t n = read(notify_, buffer, sizeof(buffer));
+            if (n <= 0) break;
+            for (char *p = buffer; p < buffer + n;) {
+                const inotify_event *event = reinterpret_cast<const inotify_event*>(p);
+                if (event->len && std::find(toLoad_.begin(), toLoad_.end(), event->name) == toLoad_.end()) { toLoad_.push_back(event->name); }
+                p += sizeof(inotify_event) + event->len; }}
+        loadWake_.notify_one(); }
+
+    /// @brief Loader thread. Parses and indexes queued files, then hands them to the event loop.
+    void _loadLoop() {
+        std::unique_lock<std::mutex> lock(loadMutex_);
+        for (;;) {
+            loadWake_.wait(lock, [&]() { return stopLoader_ || !toLoad_.empty(); });
+            if (stopLoader_) return;
+            const std::string fileName = toLoad_.front();
+            toLoad_.pop_front();
+            lock.unlock();
+            Loaded_t loaded = loadFile(rulesDir_, fileName);
+            lock.lock();
+            if (loaded.name.empty()) continue;
+            finished_.push_back(std::move(loaded));
+            const uint64_t one = 1;
+            if (write(loaded_, &one, sizeof(one)) < 0) { LOG("cannot signal a finished load: " << std::strerror(errno)); }}}
+
+    /// @brief Swaps in the rule sets the loader finished, in the order their files changed.
+    void _swapLoaded() {
+        uint64_t count;
+        while (read(loaded_, &count, sizeof(count)) > 0) {}
+        std::vector<Loaded_t> finished;
+        { std::lock_guard<std::mutex> lock(loadMutex_); finished.swap(finished_); }
+        for (auto &loaded : finished) { _apply(std::move(loaded)); }}
+
+    void _accept() {
+        for (;;) {
+            int fd = accept4(listen_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) break;
+            epoll_event ev{EPOLLIN | EPOLLRDHUP, {}}; ev.data.fd = fd;
+            if (epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &ev) != 0) { close(fd); continue; }
+            connections_[fd].fd = fd; }}
+
+    void _close(const int &fd) {
+        epoll_ctl(epoll_, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd); connections_.erase(fd); }
+
+    void _serve(const int &fd, const uint32_t &events) {
+        auto it = connections_.find(fd);
+        if (it == connections_.end()) return;
+        Connection_t &c = it->second;
+        if (events & EPOLLERR) { _close(fd); return; }
+        if ((events & EPOLLIN) && !_read(c)) return;
+        if (events & (EPOLLHUP | EPOLLRDHUP)) { c.hungUp = true; }
+        // Answer and write until the replies back up or no complete request is left
+        for (;;) {
+            if (!_answer(c) || !_flush(c)) return;
+            if (c.out.size() != c.outSent || !_framed(c)) break; }
+        if (c.hungUp && c.out.empty()) { _close(fd); return; }
+        _rewatch(c); }
+
+    /// @brief Checks if the input holds the whole first request, or enough of it to reject it.
+    static bool _framed(const Connection_t &c) {
+        if (c.in.size() < 4) return false;
+        const size_t frame = size_t(getU32(c.in.data())) + 4;
+        return frame > MAX_FRAME_SIZE || c.in.size() >= frame; }
+
+    /// @brief Reads what the socket holds, pausing once `MAX_BUFFERED` bytes and a whole request are buffered.
+    /// @return `false` if the connection was closed.
+    bool _read(Connection_t &c) {
+        uint8_t buffer[65536];
+        while (c.in.size() < MAX_BUFFERED || !_framed(c)) {
+            ssize_t n = read(c.fd, buffer, sizeof(buffer));
+            if (n > 0) { c.in.insert(c.in.end(), buffer, buffer + n); continue; }
+            if (n == 0) { c.hungUp = true; break; }
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            _close(c.fd); return false; }
+        return true; }
+
+    /// @brief Answers complete requests in order until `MAX_BUFFERED` reply bytes are unsent.
+    /// @return `false` if the connection was closed for a bad frame.
+    bool _answer(Connection_t &c) {
+        size_t used = 0;
+        while (c.out.size() - c.outSent < MAX_BUFFERED && c.in.size() - used >= 4) {
+            const size_t frame = size_t(getU32(c.in.data() + used)) + 4;
+            if (frame < HEADER_SIZE || frame > MAX_FRAME_SIZE) { LOG("bad frame, closing connection"); _close(c.fd); return false; }
+            if (c.in.size() - used < frame) break;
+            _handle(c.in.data() + used, frame, c.out);
+            used += frame; }
+        c.in.erase(c.in.begin(), c.in.begin() + used);
+        return true; }
+
+    /// @brief Writes as much output as the socket takes.
+    /// @return `false` if the connection was closed.
+    bool _flush(Connection_t &c) {
+        while (c.outSent < c.out.size()) {
+            ssize_t n = write(c.fd, c.out.data() + c.outSent, c.out.size() - c.outSent);
+            if (n > 0) { c.outSent += size_t(n); continue; }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            _close(c.fd); return false; }
+        if (c.outSent == c.out.size()) { c.out.clear(); c.outSent = 0; }
+        // A client that reads slowly but steadily never empties the buffer, so drop the sent front once it is large
+        else if (c.outSent >= MAX_BUFFERED) { c.out.erase(c.out.begin(), c.out.begin() + c.outSent); c.outSent = 0; }
+        return true; }
+
+    /// @brief Watches for requests while under `MAX_BUFFERED` unsent reply bytes, and for socket space while any are left.
+    void _rewatch(Connection_t &c) {
+        const size_t unsent = c.out.size() - c.outSent;
+        const uint32_t events = ((!c.hungUp && unsent < MAX_BUFFERED) ? uint32_t(EPOLLIN | EPOLLRDHUP) : 0u) |
+                                (unsent != 0 ? uint32_t(EPOLLOUT) : 0u);
+        if (events == c.events) return;
+        c.events = events;
+        epoll_event ev{events, {}}; ev.data.fd = c.fd;
+        epoll_ctl(epoll_, EPOLL_CTL_MOD, c.fd, &ev); }
+
+    /// @brief Answers one request frame.
+    void _handle(const uint8_t *frame, const size_t &size, std::vector<uint8_t> &out) {
+        const Header_t h = getHeader(frame);
+        const Status_t status = checkRequest(frame, size);
+        if (status != OK) { appendStatus(out, h.id, h.op, status); return; }
+        auto it = rules_.find(std::string(reinterpret_cast<const char*>(frame + HEADER_SIZE), h.nameLength));
+        if (it == rules_.end()) { appendStatus(out, h.id, h.op, UNKNOWN_RULES); return; }
+        const RuleSet_t &rules = *it->second;
+        if (h.aux != rules.type) { appendStatus(out, h.id, h.op, WRONG_TYPE); return; }
+
+        // Run the whole batch through the rule set
+        const uint8_t *values = frame + HEADER_SIZE + h.nameLength;
+        results_.resize(h.count);
+        if (rules.type == DOUBLE) {
+            floats_.resize(h.count);
+            for (size_t i = 0; i < h.count; ++i) { floats_[i] = fromBits<double>(getU64(values + i * 8)); }
+            rules.floats->validate(floats_.data(), h.count, results_.data()); }
+        else {
+            ints_.resize(h.count);
+            for (size_t i = 0; i < h.count; ++i) { ints_[i] = int64_t(getU64(values + i * 8)); }
+            rules.ints->validate(ints_.data(), h.count, results_.data()); }
+
+        // One response for the batch
+        if (h.op == VALIDATE) { appendResponse(out, h.id, h.op, results_.data(), nullptr, h.count); return; }
+        // Rank: best first, FAIL last, stable
+        order_.resize(h.count);
+        for (uint32_t i = 0; i < h.count; ++i) { order_[i] = i; }
+        auto rank = [&](const uint32_t &i) { const uint64_t w = toWire(results_[i]); return (w == WIRE_FAIL) ? 0 : w + 1; };
+        std::stable_sort(order_.begin(), order_.end(), [&](const uint32_t &a, const uint32_t &b) { return rank(a) > rank(b); });
+        appendResponse(out, h.id, h.op, results_.data(), order_.data(), h.count); }
+};
+
+static volatile std::sig_atomic_t stopFlag = 0;
+
+int main(int argc, char **argv) {
+    const std::string rulesDir   = (argc > 1) ? argv[1] : ".";
+    const std::string socketPath = (argc > 2) ? argv[2] : DEFAULT_SOCKET;
+    std::signal(SIGINT,  [](int) { stopFlag = 1; });
+    std::signal(SIGTERM, [](int) { stopFlag = 1; });
+    std::signal(SIGPIPE, SIG_IGN);
+    Daemon_t daemon(rulesDir, socketPath);
+    return daemon.run(stopFlag);
+}